@@ -0,0 +1,70 @@
+// Loopback TCP throughput, reading with read(buf) and with the readable stream.
+//
+// tjs run benchmark/tcp-throughput.js [MiB]
+
+const TOTAL = (Number(tjs.args.at(-1)) || 1024) * 1024 * 1024;
+const CHUNK = new Uint8Array(64 * 1024);
+
+async function pump(conn) {
+    let sent = 0;
+
+    while (sent < TOTAL) {
+        await conn.write(CHUNK);
+        sent += CHUNK.byteLength;
+    }
+
+    conn.close();
+}
+
+async function readWithBuffer(conn) {
+    const buf = new Uint8Array(64 * 1024);
+    let total = 0;
+
+    while (true) {
+        const nread = await conn.read(buf);
+
+        if (nread === null) {
+            return total;
+        }
+
+        total += nread;
+    }
+}
+
+async function readWithStream(conn) {
+    const reader = conn.readable.getReader();
+    let total = 0;
+
+    while (true) {
+        const { value, done } = await reader.read();
+
+        if (done) {
+            return total;
+        }
+
+        total += value.byteLength;
+    }
+}
+
+async function run(name, read) {
+    const server = await tjs.listen('tcp', '127.0.0.1');
+    const { ip, port } = server.localAddress;
+    const client = await tjs.connect('tcp', ip, port);
+    const conn = await server.accept();
+
+    performance.mark(`${name}-start`);
+
+    const [ total ] = await Promise.all([ read(client), pump(conn) ]);
+
+    performance.mark(`${name}-end`);
+
+    const { duration } = performance.measure(name, `${name}-start`, `${name}-end`);
+    const mibs = total / 1024 / 1024 / (duration / 1000);
+
+    console.log(`${name}: ${total} bytes in ${duration.toFixed(1)} ms (${mibs.toFixed(1)} MiB/s)`);
+
+    server.close();
+}
+
+await run('read(buf)', readWithBuffer);
+await run('readable', readWithStream);
@@ -136,6 +136,7 @@ fn build2(
             "src/mod_streams.c",
             "src/mod_sys.c",
             "src/mod_udp.c",
+            "src/mod_walk.c",
             "src/bundles/c/core/core.c",
             "src/bundles/c/core/polyfills.c",
             "src/bundles/c/core/run-main.c",
@@ -5,10 +5,14 @@ import { readableStreamForHandle, writableStreamForHandle } from './stream-utils
 
 const kReadable = Symbol('kReadable');
 const kWritable = Symbol('kWritable');
+const kFileHandle = Symbol('kFileHandle');
 
 const fhProxyHandler = {
     get (target, prop) {
         switch (prop) {
+            case kFileHandle:
+                return target;
+
             case 'readable': {
                 if (!target[kReadable]) {
                     target[kReadable] = readableStreamForHandle(target);
@@ -36,6 +40,10 @@ const fhProxyHandler = {
     }
 };
 
+export function fileHandle(file) {
+    return file?.[kFileHandle];
+}
+
 export async function open(path, flags, mode) {
     const handle = await core.open(path, flags, mode);
 
@@ -53,25 +61,8 @@ export async function makeDir(path, options = { mode: 0o777, recursive: false })
         return core.mkdir(path, options.mode);
     }
 
-    const parent = pathModule.dirname(path);
-
-    if (parent === path) {
-        return;
-    }
-
-    await makeDir(parent, options);
-
-    try {
-        return await core.mkdir(path, options.mode);
-    } catch (e) {
-        // Cannot rely on checking for EEXIST since the OS could throw other errors like EROFS.
-
-        const st = await core.stat(path);
-
-        if (!st.isDirectory) {
-            throw e;
-        }
-    }
+    // The whole chain of parents is created with a single threadpool job.
+    return core.mkdirp(path, options.mode);
 }
 
 export async function symlink(path, newPath, options) {
@@ -87,6 +78,55 @@ export async function symlink(path, newPath, options) {
     return core.symlink(path, newPath, flags);
 }
 
+export async function* walk(path, options = {}) {
+    const { filter, ...walkOptions } = options;
+    const walker = core.walk(path, walkOptions);
+
+    try {
+        for (;;) {
+            const entries = await walker.read();
+
+            if (entries.length === 0) {
+                return;
+            }
+
+            for (const entry of entries) {
+                if (filter && !filter(entry)) {
+                    continue;
+                }
+
+                yield entry;
+            }
+        }
+    } finally {
+        walker.close();
+    }
+}
+
+export async function* glob(patterns, options = {}) {
+    const { cwd, ignore, dot, followSymlinks } = options;
+    const walker = core.glob(Array.isArray(patterns) ? patterns : [ patterns ], {
+        cwd,
+        ignore: typeof ignore === 'string' ? [ ignore ] : ignore,
+        dot,
+        followSymlinks
+    });
+
+    try {
+        for (;;) {
+            const paths = await walker.read();
+
+            if (paths.length === 0) {
+                return;
+            }
+
+            yield* paths;
+        }
+    } finally {
+        walker.close();
+    }
+}
+
 // This is an adaptation of the 'rimraf' version bundled in Node.
 //
 
@@ -106,6 +146,10 @@ const isWindows = core.platform === 'windows';
 const _epermHandler = isWindows ? _fixWinEPERM : _rmdir;
 
 export async function remove(path, options = { maxRetries: 0, retryDelay: 100 }) {
+    if (core.removeTree) {
+        return _removeTree(path, options);
+    }
+
     let stats;
 
     try {
@@ -145,6 +189,26 @@ export async function remove(path, options = { maxRetries: 0, retryDelay: 100 })
 }
 
 
+// The native version walks the tree in parallel on the threadpool, deleting entries relative
+// to the directory fds. It's not available on Windows, which needs the EPERM dance above.
+async function _removeTree(path, options) {
+    const tries = (options.maxRetries ?? 0) + 1;
+    const retryDelay = options.retryDelay ?? 100;
+
+    for (let i = 1; i <= tries; i++) {
+        try {
+            return await core.removeTree(path);
+        } catch (err) {
+            if (retryErrors.has(err.code) && i < tries && retryDelay > 0) {
+                await sleep(i * retryDelay);
+            } else if (i === tries || !retryErrors.has(err.code)) {
+                throw err;
+            }
+        }
+    }
+}
+
+
 async function _unlink(path, options) {
     const tries = options.maxRetries + 1;
 
@@ -185,10 +249,10 @@ async function _rmdir(path, options, originalErr) {
             // when files are deleted, resulting in spurious ENOTEMPTY failures. Work
             // around that issue by retrying on Windows.
 
-            const dirIter = await core.readDir(path);
+            const names = await core.readDir(path, { all: true });
 
-            for await (const item of dirIter) {
-                const childPath = pathModule.join(path, item.name);
+            for (const name of names) {
+                const childPath = pathModule.join(path, name);
 
                 await remove(childPath, options);
             }
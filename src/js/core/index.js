@@ -3,13 +3,14 @@ const core = globalThis[Symbol.for('tjs.internal.core')];
 import { alert, confirm, prompt } from './alert-confirm-prompt.js';
 import engine from './engine.js';
 import env from './env.js';
-import { open, makeDir, makeTempFile, remove, symlink } from './fs.js';
+import { glob, open, makeDir, makeTempFile, remove, symlink, walk } from './fs.js';
 import { lookup } from './lookup.js';
 import pathModule from './path.js';
 import { addSignalListener, removeSignalListener } from './signal.js';
-import { connect, listen } from './sockets.js';
+import { connect, listen, pipe, sendFile } from './sockets.js';
 import { createStdin, createStdout, createStderr } from './stdio.js';
 import system from './system.js';
+import { receiveMessageOnPort } from './worker.js';
 
 
 // The "tjs" global.
@@ -20,6 +21,7 @@ const tjs = Object.create(null);
 // Export these properties directly from the core.
 const exports = [
     'Error',
+    'appendFile',
     'chdir',
     'chmod',
     'chown',
@@ -30,6 +32,7 @@ const exports = [
     'exec',
     'exit',
     'format',
+    'fsBatch',
     'homeDir',
     'hostName',
     'inspect',
@@ -39,20 +42,25 @@ const exports = [
     'lstat',
     'lutime',
     'makeTempDir',
+    'mapFile',
     'pid',
     'ppid',
     'readDir',
     'readFile',
     'readLink',
+    'readTextFile',
     'realPath',
     'rename',
     'spawn',
     'stat',
     'statFs',
+    'statMany',
     'tmpDir',
+    'unmapFile',
     'utime',
     'version',
-    'watch'
+    'watch',
+    'writeFile'
 ];
 
 for (const key of exports) {
@@ -130,6 +138,18 @@ Object.defineProperty(tjs, 'symlink', {
     writable: false,
     value: symlink
 });
+Object.defineProperty(tjs, 'glob', {
+    enumerable: true,
+    configurable: false,
+    writable: false,
+    value: glob
+});
+Object.defineProperty(tjs, 'walk', {
+    enumerable: true,
+    configurable: false,
+    writable: false,
+    value: walk
+});
 
 // Signals.
 if (!core.isWorker) {
@@ -160,6 +180,18 @@ Object.defineProperty(tjs, 'listen', {
     writable: false,
     value: listen
 });
+Object.defineProperty(tjs, 'sendFile', {
+    enumerable: true,
+    configurable: false,
+    writable: false,
+    value: sendFile
+});
+Object.defineProperty(tjs, 'pipe', {
+    enumerable: true,
+    configurable: false,
+    writable: false,
+    value: pipe
+});
 Object.defineProperty(tjs, 'lookup', {
     enumerable: true,
     configurable: false,
@@ -195,6 +227,14 @@ Object.defineProperty(tjs, 'system', {
     value: system
 });
 
+// Workers.
+Object.defineProperty(tjs, 'receiveMessageOnPort', {
+    enumerable: true,
+    configurable: false,
+    writable: false,
+    value: receiveMessageOnPort
+});
+
 // Internal stuff needed by the runtime.
 globalThis[Symbol.for('tjs.internal.modules.path')] = pathModule;
 
@@ -1,4 +1,6 @@
+import { fileHandle } from './fs.js';
 import { isIP, lookup } from './lookup.js';
+import { stdioHandle } from './stdio.js';
 import { readableStreamForHandle, writableStreamForHandle } from './stream-utils.js';
 
 const core = globalThis[Symbol.for('tjs.internal.core')];
@@ -21,7 +23,7 @@ export async function connect(transport, host, port, options = {}) {
                 handle.bind(options.bindAddr, flags);
             }
 
-            await handle.connect(addr);
+            await handle.connect(addr, Boolean(options.fastOpen));
 
             return new Connection(handle);
         }
@@ -48,26 +50,48 @@ export async function connect(transport, host, port, options = {}) {
             }
 
             await handle.connect(addr);
+            setupDatagramOffload(handle, options);
 
             return new DatagramEndpoint(handle);
         }
     }
 }
 
+const FASTOPEN_DEFAULT_QUEUE_SIZE = 256;
+
 export async function listen(transport, host, port, options = {}) {
     const addr = await resolveAddress(transport, host, port);
 
     switch (transport) {
         case 'tcp': {
             const handle = new core.TCP();
-            let flags = 0;
 
-            if (options.ipv6Only) {
-                flags |= core.TCP_IPV6ONLY;
+            if (options.fd !== undefined) {
+                // Share a listening socket from another thread.
+                handle.open(options.fd);
+            } else {
+                let flags = 0;
+
+                if (options.ipv6Only) {
+                    flags |= core.TCP_IPV6ONLY;
+                }
+
+                if (options.reusePort) {
+                    flags |= core.TCP_REUSEPORT;
+                }
+
+                handle.bind(addr, flags);
             }
 
-            handle.bind(addr, flags);
-            handle.listen(options.backlog);
+            if (options.fastOpen) {
+                handle.setFastOpen(options.fastOpen === true ? FASTOPEN_DEFAULT_QUEUE_SIZE : options.fastOpen);
+            }
+
+            if (options.deferAccept) {
+                handle.setDeferAccept(options.deferAccept);
+            }
+
+            handle.listen(options.backlog, options.acceptQueueSize);
 
             return new Listener(handle);
         }
@@ -76,7 +100,7 @@ export async function listen(transport, host, port, options = {}) {
             const handle = new core.Pipe();
 
             handle.bind(addr);
-            handle.listen(options.backlog);
+            handle.listen(options.backlog, options.acceptQueueSize);
 
             return new Listener(handle);
         }
@@ -89,17 +113,32 @@ export async function listen(transport, host, port, options = {}) {
                 flags |= core.UDP_REUSEADDR;
             }
 
+            if (options.reusePort) {
+                flags |= core.UDP_REUSEPORT;
+            }
+
             if (options.ipv6Only) {
                 flags |= core.UDP_IPV6ONLY;
             }
 
             handle.bind(addr, flags);
+            setupDatagramOffload(handle, options);
 
             return new DatagramEndpoint(handle);
         }
     }
 }
 
+function setupDatagramOffload(handle, options) {
+    if (options.segmentSize) {
+        handle.setSegmentSize(options.segmentSize);
+    }
+
+    if (options.gro) {
+        handle.setGro(true);
+    }
+}
+
 async function resolveAddress(transport, host, port) {
     switch (transport) {
         case 'tcp':
@@ -131,15 +170,112 @@ async function resolveAddress(transport, host, port) {
     }
 }
 
+const SENDFILE_FALLBACK_CHUNK_SIZE = 64 * 1024;
+
+export async function sendFile(connection, file, options = {}) {
+    if (!(connection instanceof Connection)) {
+        throw new TypeError('expected a Connection');
+    }
+
+    const { offset = 0, length } = options;
+    const handle = connection[kHandle];
+
+    try {
+        return await handle.sendFile(file.fileno(), offset, length);
+    } catch (e) {
+        if (e.code !== 'ENOTSUP') {
+            throw e;
+        }
+    }
+
+    // Copy through JS memory where the platform can't send files directly.
+    const buf = new Uint8Array(SENDFILE_FALLBACK_CHUNK_SIZE);
+    let sent = 0;
+
+    while (length === undefined || sent < length) {
+        const size = length === undefined ? buf.length : Math.min(buf.length, length - sent);
+        const nread = await file.read(buf.subarray(0, size), offset + sent);
+
+        if (nread === null) {
+            break;
+        }
+
+        await handle.write(buf.subarray(0, nread));
+        sent += nread;
+    }
+
+    return sent;
+}
+
+const PIPE_FALLBACK_CHUNK_SIZE = 64 * 1024;
+
+function pipeEndpoint(obj) {
+    if (obj instanceof Connection) {
+        return obj[kHandle];
+    }
+
+    const handle = stdioHandle(obj) ?? obj;
+
+    if (typeof handle?.readStart === 'function') {
+        return handle;
+    }
+
+    // Files are passed as handles, so the pipe can tell when they get closed.
+    if (typeof handle?.fileno === 'function') {
+        return fileHandle(handle) ?? handle;
+    }
+
+    throw new TypeError('expected a Connection, a file or a stdio stream');
+}
+
+export async function pipe(src, dst, options = {}) {
+    const { highWaterMark } = options;
+
+    try {
+        return await core.pipe(pipeEndpoint(src), pipeEndpoint(dst), highWaterMark);
+    } catch (e) {
+        if (e.code !== 'ENOTSUP') {
+            throw e;
+        }
+    }
+
+    // File sources aren't supported natively everywhere, read them through JS instead.
+    const buf = new Uint8Array(PIPE_FALLBACK_CHUNK_SIZE);
+    let total = 0;
+
+    for (;;) {
+        const nread = await src.read(buf);
+
+        if (nread === null) {
+            break;
+        }
+
+        let written = 0;
+
+        while (written < nread) {
+            written += await dst.write(buf.subarray(written, nread));
+        }
+
+        total += nread;
+    }
+
+    return total;
+}
+
 const kHandle = Symbol('kHandle');
 const kLocalAddress = Symbol('kLocalAddress');
 const kRemoteAddress = Symbol('kRemoteAddress');
 const kReadable = Symbol('kReadable');
+const kAccepted = Symbol('kAccepted');
 const kWritable = Symbol('kWritable');
+const kCorkDepth = Symbol('kCorkDepth');
+const kCorkToken = Symbol('kCorkToken');
 
 class Connection {
     constructor(handle) {
         this[kHandle] = handle;
+        this[kCorkDepth] = 0;
+        this[kCorkToken] = null;
     }
 
     get localAddress() {
@@ -182,6 +318,57 @@ class Connection {
         return this[kHandle].write(buf);
     }
 
+    writev(bufs) {
+        return this[kHandle].writev(bufs);
+    }
+
+    cork(options = {}) {
+        const handle = this[kHandle];
+
+        handle.cork(Boolean(options.tcpCork));
+
+        if (this[kCorkDepth]++ > 0) {
+            return;
+        }
+
+        // Writes made in the same tick are sent together. Only the outermost cork schedules
+        // this, and uncorking it by hand cancels it.
+        const token = {};
+
+        this[kCorkToken] = token;
+        queueMicrotask(() => {
+            if (this[kCorkToken] !== token) {
+                return;
+            }
+
+            this[kCorkToken] = null;
+
+            while (this[kCorkDepth] > 0) {
+                this.uncork();
+            }
+        });
+    }
+
+    uncork() {
+        if (this[kCorkDepth] === 0) {
+            return;
+        }
+
+        if (--this[kCorkDepth] === 0) {
+            this[kCorkToken] = null;
+        }
+
+        this[kHandle].uncork();
+    }
+
+    get bufferedAmount() {
+        return this[kHandle].writeQueueSize();
+    }
+
+    drain(threshold = 0) {
+        return this[kHandle].drain(threshold);
+    }
+
     setKeepAlive(enable, delay) {
         this[kHandle].setKeepAlive(enable, delay);
     }
@@ -190,6 +377,30 @@ class Connection {
         this[kHandle].setNoDelay(enable);
     }
 
+    setSendBufferSize(size) {
+        return this[kHandle].sendBufferSize(size);
+    }
+
+    setRecvBufferSize(size) {
+        return this[kHandle].recvBufferSize(size);
+    }
+
+    setNotSentLowat(bytes) {
+        this[kHandle].setNotSentLowat(bytes);
+    }
+
+    setQuickAck(enable = true) {
+        this[kHandle].setQuickAck(enable);
+    }
+
+    setBusyPoll(usecs) {
+        this[kHandle].setBusyPoll(usecs);
+    }
+
+    getInfo() {
+        return this[kHandle].getInfo();
+    }
+
     shutdown() {
         this[kHandle].shutdown();
     }
@@ -202,6 +413,7 @@ class Connection {
 class Listener {
     constructor(handle) {
         this[kHandle] = handle;
+        this[kAccepted] = [];
     }
 
     get localAddress() {
@@ -213,6 +425,10 @@ class Listener {
     }
 
     async accept() {
+        if (this[kAccepted].length) {
+            return new Connection(this[kAccepted].shift());
+        }
+
         const handle = await this[kHandle].accept();
 
         if (typeof handle === 'undefined') {
@@ -222,7 +438,16 @@ class Listener {
         return new Connection(handle);
     }
 
+    fileno() {
+        return this[kHandle].fileno();
+    }
+
     close() {
+        for (const handle of this[kAccepted]) {
+            handle.close();
+        }
+
+        this[kAccepted] = [];
         this[kHandle].close();
     }
 
@@ -236,6 +461,11 @@ class Listener {
     async next() {
         const value = await this.accept();
 
+        // Connections that were ready at the same time are picked up without waiting again.
+        if (typeof value !== 'undefined' && !this[kAccepted].length) {
+            this[kAccepted] = this[kHandle].acceptQueued();
+        }
+
         return {
             value,
             done: typeof value === 'undefined'
@@ -256,6 +486,22 @@ class DatagramEndpoint {
         return this[kHandle].send(buf, taddr);
     }
 
+    recvBatch(bufs) {
+        return this[kHandle].recvBatch(bufs);
+    }
+
+    sendBatch(messages) {
+        return this[kHandle].sendBatch(messages);
+    }
+
+    setSegmentSize(size) {
+        this[kHandle].setSegmentSize(size);
+    }
+
+    setGro(enable = true) {
+        this[kHandle].setGro(enable);
+    }
+
     get localAddress() {
         if (!this[kLocalAddress]) {
             this[kLocalAddress] = this[kHandle].getsockname();
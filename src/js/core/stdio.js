@@ -112,6 +112,12 @@ function pathByFd(fd) {
     }
 }
 
+export function stdioHandle(stream) {
+    if (stream instanceof BaseIOStream) {
+        return stream[kStdioHandle];
+    }
+}
+
 export function createStdin() {
     return createStdioStream(core.STDIN_FILENO);
 }
@@ -8,7 +8,45 @@ function silentClose(handle) {
 
 const CHUNK_SIZE = 16640;  // Borrowed from Deno.
 
+// Matches the native default; reading pauses once this much data is queued.
+const FLOW_HIGH_WATER_MARK = 256 * 1024;
+
+// The handle keeps reading into a native queue, every pull takes all the chunks read so far.
+function flowingReadableStreamForHandle(handle) {
+    return new ReadableStream({
+        type: 'bytes',
+        start() {
+            handle.readStart(FLOW_HIGH_WATER_MARK);
+        },
+        async pull(controller) {
+            try {
+                const chunks = await handle.readChunks();
+
+                if (chunks === null) {
+                    silentClose(handle);
+                    controller.close();
+                    controller.byobRequest?.respond(0);
+                } else {
+                    for (const chunk of chunks) {
+                        controller.enqueue(chunk);
+                    }
+                }
+            } catch (e) {
+                controller.error(e);
+                silentClose(handle);
+            }
+        },
+        cancel() {
+            silentClose(handle);
+        }
+    });
+}
+
 export function readableStreamForHandle(handle) {
+    if (typeof handle.readStart === 'function') {
+        return flowingReadableStreamForHandle(handle);
+    }
+
     return new ReadableStream({
         autoAllocateChunkSize: CHUNK_SIZE,
         type: 'bytes',
@@ -36,7 +74,149 @@ export function readableStreamForHandle(handle) {
     });
 }
 
+// Writes are held back once this much data is waiting, either here or in libuv's write queue.
+const WRITE_HIGH_WATER_MARK = 1024 * 1024;
+const WRITE_LOW_WATER_MARK = WRITE_HIGH_WATER_MARK / 2;
+const MAX_BATCH_BUFFERS = 1024;
+
+async function writevAll(handle, chunks) {
+    let i = 0;
+
+    while (i < chunks.length) {
+        const batch = chunks.slice(i, i + MAX_BATCH_BUFFERS);
+        let written = await handle.writev(batch);
+
+        if (typeof written !== 'number') {
+            i += batch.length;
+            continue;
+        }
+
+        // No progress would mean looping forever, e.g. a file on a full disk.
+        if (written === 0 && batch.some(chunk => chunk.byteLength > 0)) {
+            throw new Error('writev wrote no data');
+        }
+
+        // Skip fully written chunks and resume partially written ones.
+        while (i < chunks.length && written > 0) {
+            const chunk = chunks[i];
+
+            if (written >= chunk.byteLength) {
+                written -= chunk.byteLength;
+                i++;
+            } else {
+                chunks[i] = chunk.subarray(written);
+                written = 0;
+            }
+        }
+
+        // Empty chunks.
+        while (i < chunks.length && chunks[i].byteLength === 0) {
+            i++;
+        }
+    }
+}
+
+// Chunks are queued while a write is in flight and flushed together with a single writev
+// call. Writes complete as soon as the chunk is queued, unless too much data is pending.
+// Queued chunks are copies, since callers may reuse their buffer once the write completes.
+// In that case they wait for the handle to drain, so the stream's desiredSize and
+// writer.ready reflect how far behind the connection is.
+function batchedWritableStreamForHandle(handle) {
+    let queue = [];
+    let queuedBytes = 0;
+    let flushing = null;
+    let error;
+    let controller;
+    const hasWriteQueue = typeof handle.writeQueueSize === 'function';
+
+    function flush() {
+        if (!flushing) {
+            flushing = (async () => {
+                try {
+                    while (queue.length) {
+                        const chunks = queue;
+
+                        queue = [];
+                        queuedBytes = 0;
+                        await writevAll(handle, chunks);
+                    }
+                } finally {
+                    flushing = null;
+                }
+            })().catch(e => {
+                error = e;
+                controller.error(e);
+                silentClose(handle);
+            });
+        }
+
+        return flushing;
+    }
+
+    return new WritableStream({
+        start(c) {
+            controller = c;
+        },
+        async write(chunk) {
+            if (error) {
+                throw error;
+            }
+
+            queue.push(chunk.slice());
+            queuedBytes += chunk.byteLength;
+
+            const p = flush();
+
+            if (hasWriteQueue) {
+                while (!error && queuedBytes + handle.writeQueueSize() >= WRITE_HIGH_WATER_MARK) {
+                    if (handle.writeQueueSize() > WRITE_LOW_WATER_MARK) {
+                        await handle.drain(WRITE_LOW_WATER_MARK);
+                    } else {
+                        // The data is still queued here, wait for it to be handed over.
+                        await flushing;
+                    }
+                }
+            } else if (queuedBytes >= WRITE_HIGH_WATER_MARK) {
+                // Files have no write queue, their writes complete once the data is written.
+                await p;
+            }
+
+            if (error) {
+                throw error;
+            }
+        },
+        async close() {
+            await flushing;
+
+            if (error) {
+                throw error;
+            }
+
+            silentClose(handle);
+        },
+        async abort() {
+            queue = [];
+
+            // The in-flight write may still be using the handle (a file's fd in the threadpool).
+            try {
+                await flushing;
+            } catch {
+                // Ignored.
+            }
+
+            silentClose(handle);
+        }
+    }, {
+        highWaterMark: WRITE_HIGH_WATER_MARK,
+        size: chunk => chunk.byteLength
+    });
+}
+
 export function writableStreamForHandle(handle) {
+    if (typeof handle.writev === 'function') {
+        return batchedWritableStreamForHandle(handle);
+    }
+
     return new WritableStream({
         async write(chunk, controller) {
             try {
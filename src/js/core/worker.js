@@ -0,0 +1,18 @@
+const kMessagePipe = Symbol.for('tjs.internal.worker.messagePipe');
+
+
+export function receiveMessageOnPort(port, options = {}) {
+    const messagePipe = port?.[kMessagePipe];
+
+    if (!messagePipe) {
+        throw new TypeError('port must be a Worker or the worker global scope');
+    }
+
+    const timeout = options.timeout ?? 0;
+
+    if (typeof timeout !== 'number' || Number.isNaN(timeout)) {
+        throw new TypeError('timeout must be a number');
+    }
+
+    return messagePipe.receive(timeout === Infinity ? -1 : Math.max(Math.trunc(timeout), 0));
+}
@@ -6,6 +6,7 @@ const _Worker = core.Worker;
 import { defineEventAttribute } from './event-target';
 
 const kWorker = Symbol('kWorker');
+const kMessagePipe = Symbol.for('tjs.internal.worker.messagePipe');
 
 function blobTextSync(blob) {
     if (!(blob instanceof Blob)) {
@@ -29,7 +30,7 @@ function blobTextSync(blob) {
 }
 
 class Worker extends EventTarget {
-    constructor(specifier) {
+    constructor(specifier, options = {}) {
         super();
 
         let source;
@@ -47,7 +48,7 @@ class Worker extends EventTarget {
             source = blobTextSync(blob);
         }
 
-        const worker = new _Worker(specifier, source);
+        const worker = new _Worker(specifier, source, options);
         const messagePipe = worker.messagePipe;
 
         messagePipe.onmessage = msg => {
@@ -59,6 +60,7 @@ class Worker extends EventTarget {
         };
 
         this[kWorker] = worker;
+        this[kMessagePipe] = messagePipe;
     }
 
     postMessage(message, transferOrOptions) {
@@ -92,6 +94,10 @@ class Worker extends EventTarget {
         this[kWorker].terminate();
     }
 
+    stats() {
+        return this[kWorker].stats();
+    }
+
     get [Symbol.toStringTag]() {
         return 'Worker';
     }
@@ -223,10 +223,7 @@ if (options.help) {
             newFileName += '.exe';
         }
 
-        const newFile = await tjs.open(newFileName, 'w', 0o755);
-
-        await newFile.write(newExe);
-        await newFile.close();
+        await tjs.writeFile(newFileName, newExe, { mode: 0o755 });
     } else {
         tjs.stdout.write(encode(help));
         tjs.exit(1);
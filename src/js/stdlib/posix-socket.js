@@ -51,6 +51,12 @@ if (posixSocketInt) {
         recvmsg(...args) {
             return this._psock.recvmsg(...args);
         }
+        recvmmsg(...args) {
+            return this._psock.recvmmsg(...args);
+        }
+        sendmmsg(...args) {
+            return this._psock.sendmmsg(...args);
+        }
         close(...args) {
             return this._psock.close(...args);
         }
@@ -139,6 +145,27 @@ if (posixSocketInt) {
             this._psock.poll(mask, this._handleEvent);
         }
 
+        pollBatch(bufs, cbs, flags = 0) {
+            this._cbs = {
+                read: cbs.read,
+                error: cbs.error,
+            };
+
+            this._handleBatch = (status, messages) => {
+                if (status !== 0) {
+                    if (this._cbs.error) {
+                        this._cbs.error(status);
+                    } else {
+                        console.error('uv_poll unhandled error:', status);
+                    }
+                } else {
+                    this._cbs.read?.(messages);
+                }
+            };
+
+            this._psock.pollBatch(bufs, this._handleBatch, flags);
+        }
+
         stopPoll() {
             this._psock.pollStop();
         }
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 
+#include "mem.h"
 #include "private.h"
 #include "utils.h"
 
@@ -31,6 +32,15 @@
 #if defined(_MSC_VER)
 #include <dirent_compat.h>
 #endif
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 static JSClassID tjs_file_class_id;
 
@@ -60,10 +70,19 @@ static JSClassDef tjs_file_class = {
 
 static JSClassID tjs_dir_class_id;
 
+#define TJS__DIR_BATCH_SIZE 256
+
 typedef struct {
     JSContext *ctx;
     uv_dir_t *dir;
-    uv_dirent_t dirent;  // TODO: Use an array and an index.
+    uv_dirent_t *dirents;
+    unsigned int batch_size;
+    /* DirEnt objects from the last uv_fs_readdir call, handed out one by one. */
+    struct {
+        JSValue *items;
+        unsigned int count;
+        unsigned int index;
+    } batch;
     JSValue path;
     bool done;
 } TJSDir;
@@ -76,12 +95,26 @@ static void tjs_dir_finalizer(JSRuntime *rt, JSValue val) {
             uv_fs_closedir(NULL, &req, d->dir, NULL);
             uv_fs_req_cleanup(&req);
         }
+        for (unsigned int i = d->batch.index; i < d->batch.count; i++) {
+            JS_FreeValueRT(rt, d->batch.items[i]);
+        }
+        js_free_rt(rt, d->batch.items);
+        js_free_rt(rt, d->dirents);
         JS_FreeValueRT(rt, d->path);
         js_free_rt(rt, d);
     }
 }
 
-static JSClassDef tjs_dir_class = { "Directory", .finalizer = tjs_dir_finalizer };
+static void tjs_dir_mark(JSRuntime *rt, JSValue val, JS_MarkFunc *mark_func) {
+    TJSDir *d = JS_GetOpaque(val, tjs_dir_class_id);
+    if (d) {
+        for (unsigned int i = d->batch.index; i < d->batch.count; i++) {
+            JS_MarkValue(rt, d->batch.items[i], mark_func);
+        }
+    }
+}
+
+static JSClassDef tjs_dir_class = { "Directory", .finalizer = tjs_dir_finalizer, .gc_mark = tjs_dir_mark };
 
 static JSClassID tjs_dirent_class_id;
 
@@ -123,6 +156,10 @@ typedef struct {
     struct {
         JSValue tarray;
     } rw;
+    struct {
+        unsigned int batch_size;
+        bool with_file_types;
+    } dir;
 } TJSFsReq;
 
 typedef struct {
@@ -130,10 +167,26 @@ typedef struct {
     DynBuf dbuf;
     JSContext *ctx;
     int r;
+    bool text;
     char *filename;
     TJSPromise result;
 } TJSReadFileReq;
 
+typedef struct {
+    uv_work_t req;
+    JSContext *ctx;
+    char *path;
+    JSValue data;
+    const char *str;
+    const uint8_t *buf;
+    size_t len;
+    int mode;
+    bool append;
+    bool atomic;
+    int r;
+    TJSPromise result;
+} TJSWriteFileReq;
+
 static JSValue tjs_new_file(JSContext *ctx, uv_file fd, const char *path) {
     TJSFile *f;
     JSValue obj;
@@ -161,7 +214,17 @@ static TJSFile *tjs_file_get(JSContext *ctx, JSValue obj) {
     return JS_GetOpaque2(ctx, obj, tjs_file_class_id);
 }
 
-static JSValue tjs_new_dir(JSContext *ctx, uv_dir_t *dir, const char *path) {
+bool tjs__file_fileno(JSValue obj, uv_file *fd) {
+    TJSFile *f = JS_GetOpaque(obj, tjs_file_class_id);
+    if (!f) {
+        return false;
+    }
+
+    *fd = f->fd;
+    return true;
+}
+
+static JSValue tjs_new_dir(JSContext *ctx, uv_dir_t *dir, const char *path, unsigned int batch_size) {
     TJSDir *d;
     JSValue obj;
 
@@ -170,15 +233,26 @@ static JSValue tjs_new_dir(JSContext *ctx, uv_dir_t *dir, const char *path) {
         return obj;
     }
 
-    d = js_malloc(ctx, sizeof(*d));
+    d = js_mallocz(ctx, sizeof(*d));
     if (!d) {
         JS_FreeValue(ctx, obj);
         return JS_EXCEPTION;
     }
 
+    d->dirents = js_malloc(ctx, batch_size * sizeof(*d->dirents));
+    d->batch.items = js_malloc(ctx, batch_size * sizeof(*d->batch.items));
+    if (!d->dirents || !d->batch.items) {
+        js_free(ctx, d->dirents);
+        js_free(ctx, d->batch.items);
+        js_free(ctx, d);
+        JS_FreeValue(ctx, obj);
+        return JS_EXCEPTION;
+    }
+
     d->path = JS_NewString(ctx, path);
     d->ctx = ctx;
     d->dir = dir;
+    d->batch_size = batch_size;
     d->done = false;
 
     JS_SetOpaque(obj, d);
@@ -208,11 +282,36 @@ static JSValue tjs_new_dirent(JSContext *ctx, uv_dirent_t *dent) {
     return obj;
 }
 
+static JSValue tjs_new_dir_result(JSContext *ctx, bool done, JSValue value) {
+    JSValue obj = JS_NewObjectProto(ctx, JS_NULL);
+    JS_DefinePropertyValueStr(ctx, obj, "done", JS_NewBool(ctx, done), JS_PROP_C_W_E);
+    if (!done) {
+        JS_DefinePropertyValueStr(ctx, obj, "value", value, JS_PROP_C_W_E);
+    }
+    return obj;
+}
+
+static JSValue tjs_new_scandir_result(JSContext *ctx, uv_fs_t *req, bool with_file_types) {
+    JSValue arr = JS_NewArray(ctx);
+    if (JS_IsException(arr)) {
+        return arr;
+    }
+
+    uv_dirent_t dent;
+    uint32_t i = 0;
+    while (uv_fs_scandir_next(req, &dent) != UV_EOF) {
+        JSValue item = with_file_types ? tjs_new_dirent(ctx, &dent) : JS_NewString(ctx, dent.name);
+        JS_DefinePropertyValueUint32(ctx, arr, i++, item, JS_PROP_C_W_E);
+    }
+
+    return arr;
+}
+
 static TJSDirEnt *tjs_dirent_get(JSContext *ctx, JSValue obj) {
     return JS_GetOpaque2(ctx, obj, tjs_dirent_class_id);
 }
 
-static JSValue tjs_new_stat(JSContext *ctx, uv_stat_t *st) {
+JSValue tjs_new_stat(JSContext *ctx, uv_stat_t *st) {
     JSValue obj = JS_NewObjectClass(ctx, tjs_stat_class_id);
     if (JS_IsException(obj)) {
         return obj;
@@ -372,7 +471,11 @@ static void uv__fs_req_cb(uv_fs_t *req) {
             break;
 
         case UV_FS_OPENDIR:
-            arg = tjs_new_dir(ctx, fr->req.ptr, fr->req.path);
+            arg = tjs_new_dir(ctx, fr->req.ptr, fr->req.path, fr->dir.batch_size);
+            break;
+
+        case UV_FS_SCANDIR:
+            arg = tjs_new_scandir_result(ctx, &fr->req, fr->dir.with_file_types);
             break;
 
         case UV_FS_CLOSEDIR:
@@ -387,12 +490,17 @@ static void uv__fs_req_cb(uv_fs_t *req) {
         case UV_FS_READDIR:
             d = tjs_dir_get(ctx, fr->obj);
             d->done = fr->req.result == 0;
-            arg = JS_NewObjectProto(ctx, JS_NULL);
-            JS_DefinePropertyValueStr(ctx, arg, "done", JS_NewBool(ctx, d->done), JS_PROP_C_W_E);
-            if (fr->req.result != 0) {
-                JSValue item = tjs_new_dirent(ctx, &d->dirent);
-                JS_DefinePropertyValueStr(ctx, arg, "value", item, JS_PROP_C_W_E);
+            if (d->done) {
+                arg = tjs_new_dir_result(ctx, true, JS_UNDEFINED);
+                break;
             }
+            /* Names are owned by the request, so wrap the whole batch before cleaning it up. */
+            d->batch.count = fr->req.result;
+            d->batch.index = 1;
+            for (unsigned int i = 0; i < d->batch.count; i++) {
+                d->batch.items[i] = tjs_new_dirent(ctx, &d->dirents[i]);
+            }
+            arg = tjs_new_dir_result(ctx, false, d->batch.items[0]);
             break;
 
         default:
@@ -453,6 +561,90 @@ static JSValue tjs_file_rw(JSContext *ctx, JSValue this_val, int argc, JSValue *
     return fr->result.p;
 }
 
+static JSValue tjs_file_rwv(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
+    TJSFile *f = tjs_file_get(ctx, this_val);
+    if (!f) {
+        return JS_EXCEPTION;
+    }
+
+    /* arg 0: buffers */
+    if (!JS_IsArray(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected an array of buffers");
+    }
+
+    int64_t nbufs;
+    if (JS_GetLength(ctx, argv[0], &nbufs)) {
+        return JS_EXCEPTION;
+    }
+
+    if (nbufs == 0) {
+        JSValue zero = JS_NewInt32(ctx, 0);
+        return TJS_NewResolvedPromise(ctx, 1, &zero);
+    }
+
+    if (nbufs > INT32_MAX) {
+        return JS_ThrowRangeError(ctx, "too many buffers");
+    }
+
+    /* arg 1: position (on the file) */
+    int64_t pos = -1;
+    if (!JS_IsUndefined(argv[1]) && JS_ToInt64(ctx, &pos, argv[1])) {
+        return JS_EXCEPTION;
+    }
+
+    uv_buf_t *bufs = js_malloc(ctx, sizeof(*bufs) * nbufs);
+    if (!bufs) {
+        return JS_EXCEPTION;
+    }
+
+    /* Keep our own references, the caller may modify the array while the request is in flight. */
+    JSValue tarrays = JS_NewArray(ctx);
+    if (JS_IsException(tarrays)) {
+        js_free(ctx, bufs);
+        return JS_EXCEPTION;
+    }
+
+    for (uint32_t i = 0; i < nbufs; i++) {
+        JSValue v = JS_GetPropertyUint32(ctx, argv[0], i);
+        size_t size;
+        uint8_t *buf = JS_GetUint8Array(ctx, &size, v);
+        if (!buf) {
+            JS_FreeValue(ctx, v);
+            goto fail;
+        }
+        bufs[i] = uv_buf_init((char *) buf, size);
+        JS_SetPropertyUint32(ctx, tarrays, i, v);
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        goto fail;
+    }
+
+    /* libuv copies the buffer descriptors into the request. */
+    int r;
+    if (magic) {
+        r = uv_fs_write(tjs_get_loop(ctx), &fr->req, f->fd, bufs, nbufs, pos, uv__fs_req_cb);
+    } else {
+        r = uv_fs_read(tjs_get_loop(ctx), &fr->req, f->fd, bufs, nbufs, pos, uv__fs_req_cb);
+    }
+    js_free(ctx, bufs);
+    if (r != 0) {
+        js_free(ctx, fr);
+        JS_FreeValue(ctx, tarrays);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    tjs_fsreq_init(ctx, fr, this_val);
+    fr->rw.tarray = tarrays;
+    return fr->result.p;
+
+fail:
+    js_free(ctx, bufs);
+    JS_FreeValue(ctx, tarrays);
+    return JS_EXCEPTION;
+}
+
 static JSValue tjs_file_close(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
     TJSFile *f = tjs_file_get(ctx, this_val);
     if (!f) {
@@ -661,557 +853,919 @@ static JSValue tjs_file_path_get(JSContext *ctx, JSValue this_val) {
     return JS_DupValue(ctx, f->path);
 }
 
-/* Dir functions */
+/* Buffered writer */
 
-static JSValue tjs_dir_close(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    TJSDir *d = tjs_dir_get(ctx, this_val);
-    if (!d) {
-        return JS_EXCEPTION;
-    }
+#define TJS__BW_DEFAULT_HWM (64 * 1024)
+/* Chunks smaller than this get copied into the batch arena, bigger ones are referenced. */
+#define TJS__BW_COPY_THRESHOLD (16 * 1024)
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        return JS_EXCEPTION;
-    }
+static JSClassID tjs_bwriter_class_id;
 
-    int r = uv_fs_closedir(tjs_get_loop(ctx), &fr->req, d->dir, uv__fs_req_cb);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+typedef struct {
+    size_t off; /* Offset into the arena, for copied chunks. */
+    size_t len;
+    const uint8_t *ptr; /* Referenced chunks only. */
+    JSValue ref;
+} TJSWriteSeg;
+
+typedef struct {
+    uint8_t *arena;
+    size_t arena_len;
+    size_t arena_cap;
+    TJSWriteSeg *segs;
+    size_t nsegs;
+    size_t segs_cap;
+    size_t size;
+} TJSWriteBatch;
+
+typedef struct {
+    uint64_t target;
+    bool sync;
+    TJSPromise result;
+} TJSWriteWaiter;
+
+typedef struct {
+    JSContext *ctx;
+    uv_fs_t req;
+    JSValue file;
+    TJSPromise result;
+} TJSWriterSyncReq;
+
+typedef struct {
+    JSContext *ctx;
+    JSValue self; /* Not owned. */
+    JSValue obj;  /* Owned while a write is in flight. */
+    JSValue file;
+    size_t hwm;
+    uint64_t flush_interval;
+    bool closed;
+    bool writing;
+    bool flush_requested;
+    int error;
+    /* Chunks are appended to the active batch while the inflight one is being written. */
+    TJSWriteBatch active;
+    TJSWriteBatch inflight;
+    size_t inflight_done;
+    uv_buf_t *bufs;
+    size_t bufs_cap;
+    uint64_t queued;
+    uint64_t written;
+    struct {
+        TJSWriteWaiter *items;
+        size_t len;
+        size_t cap;
+    } waiters;
+    TJSPromise ready;
+    uv_fs_t req;
+    uv_timer_t timer;
+} TJSBufferedWriter;
+
+static void tjs__bw_batch_reset(JSRuntime *rt, TJSWriteBatch *b) {
+    for (size_t i = 0; i < b->nsegs; i++) {
+        JS_FreeValueRT(rt, b->segs[i].ref);
     }
+    b->nsegs = 0;
+    b->arena_len = 0;
+    b->size = 0;
+}
 
-    return tjs_fsreq_init(ctx, fr, this_val);
+static void tjs__bw_batch_free(JSRuntime *rt, TJSWriteBatch *b) {
+    tjs__bw_batch_reset(rt, b);
+    js_free_rt(rt, b->arena);
+    js_free_rt(rt, b->segs);
 }
 
-static JSValue tjs_dir_path_get(JSContext *ctx, JSValue this_val) {
-    TJSDir *d = tjs_dir_get(ctx, this_val);
-    if (!d) {
-        return JS_EXCEPTION;
+static void tjs__bw_batch_mark(JSRuntime *rt, TJSWriteBatch *b, JS_MarkFunc *mark_func) {
+    for (size_t i = 0; i < b->nsegs; i++) {
+        JS_MarkValue(rt, b->segs[i].ref, mark_func);
     }
-    return JS_DupValue(ctx, d->path);
 }
 
-static JSValue tjs_dir_next(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    TJSDir *d = tjs_dir_get(ctx, this_val);
-    if (!d) {
-        return JS_EXCEPTION;
-    }
+static int tjs__bw_batch_add(JSContext *ctx, TJSWriteBatch *b, const uint8_t *buf, size_t len, JSValue ref) {
+    bool copy = JS_IsUndefined(ref);
 
-    if (d->done) {
-        return JS_UNDEFINED;
-    }
+    if (copy) {
+        if (b->arena_len + len > b->arena_cap) {
+            size_t cap = b->arena_cap ? b->arena_cap : 4096;
+            while (cap < b->arena_len + len) {
+                cap *= 2;
+            }
+            uint8_t *arena = js_realloc(ctx, b->arena, cap);
+            if (!arena) {
+                return -1;
+            }
+            b->arena = arena;
+            b->arena_cap = cap;
+        }
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        return JS_EXCEPTION;
+        memcpy(b->arena + b->arena_len, buf, len);
+
+        /* Consecutive copies extend the last segment. */
+        if (b->nsegs > 0) {
+            TJSWriteSeg *last = &b->segs[b->nsegs - 1];
+            if (!last->ptr && last->off + last->len == b->arena_len) {
+                last->len += len;
+                b->arena_len += len;
+                b->size += len;
+                return 0;
+            }
+        }
     }
 
-    d->dir->dirents = &d->dirent;
-    d->dir->nentries = 1;
+    if (b->nsegs == b->segs_cap) {
+        size_t cap = b->segs_cap ? b->segs_cap * 2 : 16;
+        TJSWriteSeg *segs = js_realloc(ctx, b->segs, cap * sizeof(*segs));
+        if (!segs) {
+            return -1;
+        }
+        b->segs = segs;
+        b->segs_cap = cap;
+    }
 
-    int r = uv_fs_readdir(tjs_get_loop(ctx), &fr->req, d->dir, uv__fs_req_cb);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+    TJSWriteSeg *seg = &b->segs[b->nsegs++];
+    seg->len = len;
+    if (copy) {
+        seg->off = b->arena_len;
+        seg->ptr = NULL;
+        seg->ref = JS_UNDEFINED;
+        b->arena_len += len;
+    } else {
+        seg->off = 0;
+        seg->ptr = buf;
+        seg->ref = JS_DupValue(ctx, ref);
     }
+    b->size += len;
 
-    return tjs_fsreq_init(ctx, fr, this_val);
+    return 0;
 }
 
-static JSValue tjs_dir_iterator(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    return JS_DupValue(ctx, this_val);
+static void tjs__bw_maybe_flush(TJSBufferedWriter *bw);
+
+/* The file may have been closed since the writer was created, its fd is looked up every time. */
+static uv_file tjs__bw_fd(TJSBufferedWriter *bw) {
+    TJSFile *f = JS_GetOpaque(bw->file, tjs_file_class_id);
+    return f ? f->fd : -1;
 }
 
-/* DirEnt functions */
+static void tjs__bw_sync_cb(uv_fs_t *req) {
+    TJSWriterSyncReq *sr = req->data;
+    CHECK_NOT_NULL(sr);
 
-static JSValue tjs_dirent_name_get(JSContext *ctx, JSValue this_val) {
-    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
-    if (!de) {
-        return JS_EXCEPTION;
+    JSContext *ctx = sr->ctx;
+    JSValue arg = JS_UNDEFINED;
+    bool is_reject = false;
+
+    if (req->result < 0) {
+        arg = tjs_new_error(ctx, req->result);
+        is_reject = true;
     }
-    return JS_DupValue(ctx, de->name);
+
+    uv_fs_req_cleanup(req);
+
+    TJS_SettlePromise(ctx, &sr->result, is_reject, 1, &arg);
+    JS_FreeValue(ctx, sr->file);
+    js_free(ctx, sr);
 }
 
-static JSValue tjs_dirent_isblockdevice(JSContext *ctx, JSValue this_val) {
-    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
-    if (!de) {
-        return JS_EXCEPTION;
+/* Takes ownership of the promise, which is settled once the fsync is done. */
+static void tjs__bw_sync(TJSBufferedWriter *bw, TJSPromise *p) {
+    JSContext *ctx = bw->ctx;
+    int r = UV_ENOMEM;
+
+    uv_file fd = tjs__bw_fd(bw);
+    TJSWriterSyncReq *sr = NULL;
+    if (fd == -1) {
+        r = UV_EBADF;
+    } else if ((sr = js_malloc(ctx, sizeof(*sr)))) {
+        sr->req.data = sr;
+        r = uv_fs_fsync(tjs_get_loop(ctx), &sr->req, fd, tjs__bw_sync_cb);
     }
 
-    return JS_NewBool(ctx, de->type == UV_DIRENT_BLOCK);
+    if (r != 0) {
+        js_free(ctx, sr);
+        JSValue arg = tjs_new_error(ctx, r);
+        TJS_SettlePromise(ctx, p, true, 1, &arg);
+        return;
+    }
+
+    sr->ctx = ctx;
+    sr->file = JS_DupValue(ctx, bw->file);
+    sr->result = *p;
 }
 
-static JSValue tjs_dirent_ischaracterdevice(JSContext *ctx, JSValue this_val) {
-    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
-    if (!de) {
-        return JS_EXCEPTION;
+/* Settles the flush and sync waiters whose data has been written, and the ready
+ * promise once the buffered amount drops below the high water mark. */
+static void tjs__bw_settle(TJSBufferedWriter *bw) {
+    JSContext *ctx = bw->ctx;
+    size_t j = 0;
+
+    for (size_t i = 0; i < bw->waiters.len; i++) {
+        TJSWriteWaiter *w = &bw->waiters.items[i];
+
+        if (bw->error != 0) {
+            JSValue arg = tjs_new_error(ctx, bw->error);
+            TJS_SettlePromise(ctx, &w->result, true, 1, &arg);
+        } else if (bw->written < w->target) {
+            bw->waiters.items[j++] = *w;
+        } else if (w->sync) {
+            tjs__bw_sync(bw, &w->result);
+        } else {
+            JSValue arg = JS_UNDEFINED;
+            TJS_SettlePromise(ctx, &w->result, false, 1, &arg);
+        }
     }
 
-    return JS_NewBool(ctx, de->type == UV_DIRENT_CHAR);
+    bw->waiters.len = j;
+
+    if (TJS_IsPromisePending(ctx, &bw->ready)) {
+        if (bw->error != 0) {
+            JSValue arg = tjs_new_error(ctx, bw->error);
+            TJS_SettlePromise(ctx, &bw->ready, true, 1, &arg);
+            TJS_ClearPromise(ctx, &bw->ready);
+        } else if (bw->queued - bw->written < bw->hwm) {
+            JSValue arg = JS_UNDEFINED;
+            TJS_SettlePromise(ctx, &bw->ready, false, 1, &arg);
+            TJS_ClearPromise(ctx, &bw->ready);
+        }
+    }
 }
 
-static JSValue tjs_dirent_isdirectory(JSContext *ctx, JSValue this_val) {
-    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
-    if (!de) {
-        return JS_EXCEPTION;
+static void tjs__bw_submit(TJSBufferedWriter *bw);
+static void tjs__bw_timer_cb(uv_timer_t *handle);
+
+static void tjs__bw_write_cb(uv_fs_t *req) {
+    TJSBufferedWriter *bw = req->data;
+    CHECK_NOT_NULL(bw);
+
+    JSContext *ctx = bw->ctx;
+    ssize_t r = req->result;
+
+    uv_fs_req_cleanup(req);
+
+    if (r < 0) {
+        bw->error = r;
+    } else {
+        bw->inflight_done += r;
+        bw->written += r;
+        if (bw->inflight_done < bw->inflight.size) {
+            /* Short write, submit the rest. */
+            tjs__bw_submit(bw);
+            return;
+        }
     }
 
-    return JS_NewBool(ctx, de->type == UV_DIRENT_DIR);
-}
+    bw->writing = false;
+    tjs__bw_batch_reset(JS_GetRuntime(ctx), &bw->inflight);
 
-static JSValue tjs_dirent_isfifo(JSContext *ctx, JSValue this_val) {
-    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
-    if (!de) {
-        return JS_EXCEPTION;
+    tjs__bw_settle(bw);
+    tjs__bw_maybe_flush(bw);
+
+    /* Data written while this batch was in flight didn't start the timer. */
+    if (!bw->writing && bw->error == 0 && bw->active.size > 0 && bw->flush_interval > 0) {
+        uv_timer_start(&bw->timer, tjs__bw_timer_cb, bw->flush_interval, 0);
     }
 
-    return JS_NewBool(ctx, de->type == UV_DIRENT_FIFO);
+    if (!bw->writing) {
+        JSValue obj = bw->obj;
+        bw->obj = JS_UNDEFINED;
+        JS_FreeValue(ctx, obj);
+    }
 }
 
-static JSValue tjs_dirent_isfile(JSContext *ctx, JSValue this_val) {
-    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
-    if (!de) {
-        return JS_EXCEPTION;
+/* Writes whatever is left of the inflight batch with a single writev. */
+static void tjs__bw_submit(TJSBufferedWriter *bw) {
+    TJSWriteBatch *b = &bw->inflight;
+    size_t skip = bw->inflight_done;
+    unsigned int n = 0;
+
+    for (size_t i = 0; i < b->nsegs; i++) {
+        TJSWriteSeg *seg = &b->segs[i];
+        const uint8_t *ptr = seg->ptr ? seg->ptr : b->arena + seg->off;
+        if (skip >= seg->len) {
+            skip -= seg->len;
+            continue;
+        }
+        bw->bufs[n++] = uv_buf_init((char *) ptr + skip, seg->len - skip);
+        skip = 0;
     }
 
-    return JS_NewBool(ctx, de->type == UV_DIRENT_FILE);
+    bw->req.data = bw;
+
+    uv_file fd = tjs__bw_fd(bw);
+    int r = UV_EBADF;
+    if (fd != -1) {
+        r = uv_fs_write(tjs_get_loop(bw->ctx), &bw->req, fd, bw->bufs, n, -1, tjs__bw_write_cb);
+    }
+    if (r != 0) {
+        bw->req.result = r;
+        tjs__bw_write_cb(&bw->req);
+    }
 }
 
-static JSValue tjs_dirent_issocket(JSContext *ctx, JSValue this_val) {
-    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
-    if (!de) {
-        return JS_EXCEPTION;
+/* Starts writing the active batch if it's over the high water mark or a flush was requested. */
+static void tjs__bw_maybe_flush(TJSBufferedWriter *bw) {
+    JSContext *ctx = bw->ctx;
+
+    if (bw->writing || bw->error != 0 || bw->active.size == 0) {
+        return;
     }
 
-    return JS_NewBool(ctx, de->type == UV_DIRENT_SOCKET);
-}
+    if (!bw->flush_requested && bw->active.size < bw->hwm) {
+        return;
+    }
 
-static JSValue tjs_dirent_issymlink(JSContext *ctx, JSValue this_val) {
-    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
-    if (!de) {
-        return JS_EXCEPTION;
+    if (bw->active.nsegs > bw->bufs_cap) {
+        uv_buf_t *bufs = js_realloc(ctx, bw->bufs, bw->active.nsegs * sizeof(*bufs));
+        if (!bufs) {
+            bw->error = UV_ENOMEM;
+            tjs__bw_settle(bw);
+            return;
+        }
+        bw->bufs = bufs;
+        bw->bufs_cap = bw->active.nsegs;
     }
 
-    return JS_NewBool(ctx, de->type == UV_DIRENT_LINK);
-}
+    uv_timer_stop(&bw->timer);
+    bw->flush_requested = false;
 
-/* StatResult functions */
+    TJSWriteBatch tmp = bw->inflight;
+    bw->inflight = bw->active;
+    bw->active = tmp;
+    bw->inflight_done = 0;
+    bw->writing = true;
 
-static JSValue tjs_stat_isblockdevice(JSContext *ctx, JSValue this_val) {
-    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
-    if (!sr) {
-        return JS_EXCEPTION;
+    if (JS_IsUndefined(bw->obj)) {
+        bw->obj = JS_DupValue(ctx, bw->self);
     }
 
-    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFBLK);
+    tjs__bw_submit(bw);
 }
 
-static JSValue tjs_stat_ischaracterdevice(JSContext *ctx, JSValue this_val) {
-    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
-    if (!sr) {
-        return JS_EXCEPTION;
-    }
+static void tjs__bw_timer_cb(uv_timer_t *handle) {
+    TJSBufferedWriter *bw = handle->data;
+    CHECK_NOT_NULL(bw);
 
-    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFCHR);
+    bw->flush_requested = true;
+    tjs__bw_maybe_flush(bw);
 }
 
-static JSValue tjs_stat_isdirectory(JSContext *ctx, JSValue this_val) {
-    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
-    if (!sr) {
-        return JS_EXCEPTION;
-    }
-
-    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFDIR);
+static void tjs__bw_close_cb(uv_handle_t *handle) {
+    TJSBufferedWriter *bw = handle->data;
+    tjs__free(bw);
 }
 
-static JSValue tjs_stat_isfifo(JSContext *ctx, JSValue this_val) {
-    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
-    if (!sr) {
-        return JS_EXCEPTION;
-    }
+static void tjs_bwriter_finalizer(JSRuntime *rt, JSValue val) {
+    TJSBufferedWriter *bw = JS_GetOpaque(val, tjs_bwriter_class_id);
+    if (bw) {
+        /* Data that was never flushed is dropped: the file may be gone already, and
+         * blocking writes don't belong in the GC. */
+        tjs__bw_batch_free(rt, &bw->active);
+        tjs__bw_batch_free(rt, &bw->inflight);
+        for (size_t i = 0; i < bw->waiters.len; i++) {
+            TJS_FreePromiseRT(rt, &bw->waiters.items[i].result);
+        }
+        js_free_rt(rt, bw->waiters.items);
+        js_free_rt(rt, bw->bufs);
+        TJS_FreePromiseRT(rt, &bw->ready);
+        JS_FreeValueRT(rt, bw->file);
 
-    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFIFO);
+        uv_close((uv_handle_t *) &bw->timer, tjs__bw_close_cb);
+    }
 }
 
-static JSValue tjs_stat_isfile(JSContext *ctx, JSValue this_val) {
-    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
-    if (!sr) {
-        return JS_EXCEPTION;
+static void tjs_bwriter_mark(JSRuntime *rt, JSValue val, JS_MarkFunc *mark_func) {
+    TJSBufferedWriter *bw = JS_GetOpaque(val, tjs_bwriter_class_id);
+    if (bw) {
+        /* bw->obj is deliberately not marked: it keeps the writer alive while writing. */
+        JS_MarkValue(rt, bw->file, mark_func);
+        tjs__bw_batch_mark(rt, &bw->active, mark_func);
+        tjs__bw_batch_mark(rt, &bw->inflight, mark_func);
+        for (size_t i = 0; i < bw->waiters.len; i++) {
+            TJS_MarkPromise(rt, &bw->waiters.items[i].result, mark_func);
+        }
+        TJS_MarkPromise(rt, &bw->ready, mark_func);
     }
-
-    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFREG);
 }
 
-static JSValue tjs_stat_issocket(JSContext *ctx, JSValue this_val) {
-    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
-    if (!sr) {
-        return JS_EXCEPTION;
-    }
+static JSClassDef tjs_bwriter_class = {
+    "BufferedWriter",
+    .finalizer = tjs_bwriter_finalizer,
+    .gc_mark = tjs_bwriter_mark,
+};
 
-#if defined(S_IFSOCK)
-    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFSOCK);
-#else
-    return JS_FALSE;
-#endif
+static TJSBufferedWriter *tjs_bwriter_get(JSContext *ctx, JSValue obj) {
+    return JS_GetOpaque2(ctx, obj, tjs_bwriter_class_id);
 }
 
-static JSValue tjs_stat_issymlink(JSContext *ctx, JSValue this_val) {
-    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
-    if (!sr) {
+static JSValue tjs_file_buffered_writer(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSFile *f = tjs_file_get(ctx, this_val);
+    if (!f) {
         return JS_EXCEPTION;
     }
 
-    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFLNK);
-}
+    if (f->fd == -1) {
+        return tjs_throw_errno(ctx, UV_EBADF);
+    }
 
-/* Module functions */
+    int64_t hwm = TJS__BW_DEFAULT_HWM;
+    int64_t flush_interval = 0;
 
-static int js__uv_open_flags(const char *strflags, size_t len) {
-    int flags = 0, read = 0, write = 0;
+    JSValue opts = argv[0];
+    if (JS_IsObject(opts)) {
+        JSValue js_hwm = JS_GetPropertyStr(ctx, opts, "highWaterMark");
+        int ret = !JS_IsUndefined(js_hwm) && JS_ToInt64(ctx, &hwm, js_hwm);
+        JS_FreeValue(ctx, js_hwm);
+        if (ret) {
+            return JS_EXCEPTION;
+        }
 
-    for (int i = 0; i < len; i++) {
-        switch (strflags[i]) {
-            case 'r':
-                read = 1;
-                break;
-            case 'w':
-                write = 1;
-                flags |= O_TRUNC | O_CREAT;
-                break;
-            case 'a':
-                write = 1;
-                flags |= O_APPEND | O_CREAT;
-                break;
-            case '+':
-                read = 1;
-                write = 1;
-                break;
-            case 'x':
-                flags |= O_EXCL;
-                break;
-            default:
-                break;
+        JSValue js_interval = JS_GetPropertyStr(ctx, opts, "flushInterval");
+        ret = !JS_IsUndefined(js_interval) && JS_ToInt64(ctx, &flush_interval, js_interval);
+        JS_FreeValue(ctx, js_interval);
+        if (ret) {
+            return JS_EXCEPTION;
         }
     }
 
-    flags |= read ? (write ? O_RDWR : O_RDONLY) : (write ? O_WRONLY : 0);
+    if (hwm < 1) {
+        return JS_ThrowRangeError(ctx, "highWaterMark must be positive");
+    }
 
-    return flags;
-}
+    if (flush_interval < 0) {
+        return JS_ThrowRangeError(ctx, "flushInterval must not be negative");
+    }
 
-static JSValue tjs_fs_open(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path;
-    const char *strflags;
-    size_t len;
-    int flags;
-    int32_t mode;
+    JSValue obj = JS_NewObjectClass(ctx, tjs_bwriter_class_id);
+    if (JS_IsException(obj)) {
+        return obj;
+    }
 
-    path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
+    TJSBufferedWriter *bw = tjs__mallocz(sizeof(*bw));
+    if (!bw) {
+        JS_FreeValue(ctx, obj);
+        return JS_ThrowOutOfMemory(ctx);
     }
 
-    strflags = JS_ToCStringLen(ctx, &len, argv[1]);
-    if (!strflags) {
-        JS_FreeCString(ctx, path);
+    bw->ctx = ctx;
+    bw->self = obj;
+    bw->obj = JS_UNDEFINED;
+    bw->file = JS_DupValue(ctx, this_val);
+    bw->hwm = hwm;
+    bw->flush_interval = flush_interval;
+    TJS_ClearPromise(ctx, &bw->ready);
+
+    CHECK_EQ(uv_timer_init(tjs_get_loop(ctx), &bw->timer), 0);
+    bw->timer.data = bw;
+    uv_unref((uv_handle_t *) &bw->timer);
+
+    JS_SetOpaque(obj, bw);
+
+    return obj;
+}
+
+static JSValue tjs_bwriter_write(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSBufferedWriter *bw = tjs_bwriter_get(ctx, this_val);
+    if (!bw) {
         return JS_EXCEPTION;
     }
-    flags = js__uv_open_flags(strflags, len);
-    JS_FreeCString(ctx, strflags);
 
-    mode = 0666;
-    if (!JS_IsUndefined(argv[2]) && JS_ToInt32(ctx, &mode, argv[2])) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
+    if (bw->error != 0) {
+        return tjs_throw_errno(ctx, bw->error);
     }
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
+    if (bw->closed) {
+        return JS_ThrowTypeError(ctx, "writer is closed");
     }
 
-    int r = uv_fs_open(tjs_get_loop(ctx), &fr->req, path, flags, mode, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+    JSValue data = argv[0];
+    JSValue ref = JS_UNDEFINED;
+    const char *str = NULL;
+    const uint8_t *buf;
+    size_t len;
+
+    if (JS_IsString(data)) {
+        str = JS_ToCStringLen(ctx, &len, data);
+        if (!str) {
+            return JS_EXCEPTION;
+        }
+        buf = (const uint8_t *) str;
+    } else if (JS_IsArrayBuffer(data)) {
+        buf = JS_GetArrayBuffer(ctx, &len, data);
+        if (!buf && len != 0) {
+            return JS_EXCEPTION;
+        }
+        ref = data;
+    } else {
+        size_t offset, bpe;
+        JSValue abuf = JS_GetTypedArrayBuffer(ctx, data, &offset, &len, &bpe);
+        if (JS_IsException(abuf)) {
+            JS_FreeValue(ctx, JS_GetException(ctx));
+            return JS_ThrowTypeError(ctx, "expected a string, ArrayBuffer or TypedArray");
+        }
+        size_t abuf_len;
+        buf = JS_GetArrayBuffer(ctx, &abuf_len, abuf);
+        JS_FreeValue(ctx, abuf);
+        if (!buf && len != 0) {
+            return JS_EXCEPTION;
+        }
+        buf += offset;
+        ref = data;
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
-}
+    if (len > 0) {
+        bool was_empty = bw->active.size == 0;
 
-static JSValue tjs_fs_new_stdio_file(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path;
-    uv_file fd;
+        /* Small chunks are copied, big ones are written straight from the JS memory. */
+        if (len < TJS__BW_COPY_THRESHOLD) {
+            ref = JS_UNDEFINED;
+        }
 
-    path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
-    }
+        int r = tjs__bw_batch_add(ctx, &bw->active, buf, len, ref);
+        if (str) {
+            JS_FreeCString(ctx, str);
+        }
+        if (r != 0) {
+            return JS_ThrowOutOfMemory(ctx);
+        }
 
-    if (JS_ToInt32(ctx, &fd, argv[1])) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
-    }
+        bw->queued += len;
 
-    JSValue obj = tjs_new_file(ctx, fd, path);
+        if (was_empty && bw->flush_interval > 0 && !bw->writing) {
+            uv_timer_start(&bw->timer, tjs__bw_timer_cb, bw->flush_interval, 0);
+        }
 
-    JS_FreeCString(ctx, path);
+        tjs__bw_maybe_flush(bw);
+    } else if (str) {
+        JS_FreeCString(ctx, str);
+    }
 
-    return obj;
+    return JS_NewBool(ctx, bw->queued - bw->written < bw->hwm);
 }
 
-static JSValue tjs_fs_stat(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
+static JSValue tjs_bwriter_flush(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
+    TJSBufferedWriter *bw = tjs_bwriter_get(ctx, this_val);
+    if (!bw) {
         return JS_EXCEPTION;
     }
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
-    }
+    bool sync = magic == 1;
 
-    int r;
-    if (magic) {
-        r = uv_fs_lstat(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
-    } else {
-        r = uv_fs_stat(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    if (magic == 2) {
+        bw->closed = true;
     }
-    JS_FreeCString(ctx, path);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+
+    if (bw->error != 0) {
+        JSValue arg = tjs_new_error(ctx, bw->error);
+        return TJS_NewRejectedPromise(ctx, 1, &arg);
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
-}
+    TJSPromise p;
+    JSValue ret = TJS_InitPromise(ctx, &p);
+    if (JS_IsException(ret)) {
+        return ret;
+    }
 
-static JSValue tjs_fs_stat_sync(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
+    if (bw->written >= bw->queued) {
+        if (sync) {
+            tjs__bw_sync(bw, &p);
+        } else {
+            JSValue arg = JS_UNDEFINED;
+            TJS_SettlePromise(ctx, &p, false, 1, &arg);
+        }
+        return ret;
     }
 
-    uv_fs_t req;
-    int r = uv_fs_stat(NULL, &req, path, NULL);
-    JS_FreeCString(ctx, path);
-    if (r != 0) {
-        uv_fs_req_cleanup(&req);
-        return tjs_throw_errno(ctx, r);
+    if (bw->waiters.len == bw->waiters.cap) {
+        size_t cap = bw->waiters.cap ? bw->waiters.cap * 2 : 4;
+        TJSWriteWaiter *items = js_realloc(ctx, bw->waiters.items, cap * sizeof(*items));
+        if (!items) {
+            TJS_FreePromise(ctx, &p);
+            JS_FreeValue(ctx, ret);
+            return JS_EXCEPTION;
+        }
+        bw->waiters.items = items;
+        bw->waiters.cap = cap;
     }
 
-    JSValue ret = tjs_new_stat(ctx, &req.statbuf);
-    uv_fs_req_cleanup(&req);
+    TJSWriteWaiter *w = &bw->waiters.items[bw->waiters.len++];
+    w->target = bw->queued;
+    w->sync = sync;
+    w->result = p;
+
+    bw->flush_requested = true;
+    tjs__bw_maybe_flush(bw);
 
     return ret;
 }
 
-static JSValue tjs_fs_realpath(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
+static JSValue tjs_bwriter_ready_get(JSContext *ctx, JSValue this_val) {
+    TJSBufferedWriter *bw = tjs_bwriter_get(ctx, this_val);
+    if (!bw) {
         return JS_EXCEPTION;
     }
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
+    if (bw->error != 0) {
+        JSValue arg = tjs_new_error(ctx, bw->error);
+        return TJS_NewRejectedPromise(ctx, 1, &arg);
     }
 
-    int r = uv_fs_realpath(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+    if (bw->queued - bw->written < bw->hwm) {
+        return TJS_NewResolvedPromise(ctx, 0, NULL);
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+    if (TJS_IsPromisePending(ctx, &bw->ready)) {
+        return JS_DupValue(ctx, bw->ready.p);
+    }
+
+    return TJS_InitPromise(ctx, &bw->ready);
 }
 
-static JSValue tjs_fs_unlink(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
+static JSValue tjs_bwriter_buffered_amount_get(JSContext *ctx, JSValue this_val) {
+    TJSBufferedWriter *bw = tjs_bwriter_get(ctx, this_val);
+    if (!bw) {
         return JS_EXCEPTION;
     }
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
-    }
+    return JS_NewInt64(ctx, bw->queued - bw->written);
+}
 
-    int r = uv_fs_unlink(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+static JSValue tjs_bwriter_hwm_get(JSContext *ctx, JSValue this_val) {
+    TJSBufferedWriter *bw = tjs_bwriter_get(ctx, this_val);
+    if (!bw) {
+        return JS_EXCEPTION;
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+    return JS_NewInt64(ctx, bw->hwm);
 }
 
-static JSValue tjs_fs_rename(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
-    }
+/* Dir functions */
 
-    const char *new_path = JS_ToCString(ctx, argv[1]);
-    if (!new_path) {
-        JS_FreeCString(ctx, path);
+static JSValue tjs_dir_close(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSDir *d = tjs_dir_get(ctx, this_val);
+    if (!d) {
         return JS_EXCEPTION;
     }
 
     TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
     if (!fr) {
-        JS_FreeCString(ctx, path);
-        JS_FreeCString(ctx, new_path);
         return JS_EXCEPTION;
     }
 
-    int r = uv_fs_rename(tjs_get_loop(ctx), &fr->req, path, new_path, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    JS_FreeCString(ctx, new_path);
+    int r = uv_fs_closedir(tjs_get_loop(ctx), &fr->req, d->dir, uv__fs_req_cb);
     if (r != 0) {
         js_free(ctx, fr);
         return tjs_throw_errno(ctx, r);
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+    return tjs_fsreq_init(ctx, fr, this_val);
 }
 
-static JSValue tjs_fs_mkdtemp(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *tpl = JS_ToCString(ctx, argv[0]);
-    if (!tpl) {
+static JSValue tjs_dir_path_get(JSContext *ctx, JSValue this_val) {
+    TJSDir *d = tjs_dir_get(ctx, this_val);
+    if (!d) {
         return JS_EXCEPTION;
     }
+    return JS_DupValue(ctx, d->path);
+}
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, tpl);
+static JSValue tjs_dir_next(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSDir *d = tjs_dir_get(ctx, this_val);
+    if (!d) {
         return JS_EXCEPTION;
     }
 
-    int r = uv_fs_mkdtemp(tjs_get_loop(ctx), &fr->req, tpl, uv__fs_req_cb);
-    JS_FreeCString(ctx, tpl);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+    if (d->done) {
+        return JS_UNDEFINED;
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
-}
-
-static JSValue tjs_fs_mkstemp(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *tpl = JS_ToCString(ctx, argv[0]);
-    if (!tpl) {
-        return JS_EXCEPTION;
+    /* Serve from the current batch if possible, avoiding a threadpool round-trip. */
+    if (d->batch.index < d->batch.count) {
+        JSValue result = tjs_new_dir_result(ctx, false, d->batch.items[d->batch.index++]);
+        return TJS_NewResolvedPromise(ctx, 1, &result);
     }
 
     TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
     if (!fr) {
-        JS_FreeCString(ctx, tpl);
         return JS_EXCEPTION;
     }
 
-    int r = uv_fs_mkstemp(tjs_get_loop(ctx), &fr->req, tpl, uv__fs_req_cb);
-    JS_FreeCString(ctx, tpl);
+    d->batch.count = 0;
+    d->batch.index = 0;
+    d->dir->dirents = d->dirents;
+    d->dir->nentries = d->batch_size;
+
+    int r = uv_fs_readdir(tjs_get_loop(ctx), &fr->req, d->dir, uv__fs_req_cb);
     if (r != 0) {
         js_free(ctx, fr);
         return tjs_throw_errno(ctx, r);
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+    return tjs_fsreq_init(ctx, fr, this_val);
 }
 
-static JSValue tjs_fs_rmdir(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
+static JSValue tjs_dir_iterator(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    return JS_DupValue(ctx, this_val);
+}
+
+/* DirEnt functions */
+
+static JSValue tjs_dirent_name_get(JSContext *ctx, JSValue this_val) {
+    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
+    if (!de) {
         return JS_EXCEPTION;
     }
+    return JS_DupValue(ctx, de->name);
+}
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
+static JSValue tjs_dirent_isblockdevice(JSContext *ctx, JSValue this_val) {
+    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
+    if (!de) {
         return JS_EXCEPTION;
     }
 
-    int r = uv_fs_rmdir(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+    return JS_NewBool(ctx, de->type == UV_DIRENT_BLOCK);
+}
+
+static JSValue tjs_dirent_ischaracterdevice(JSContext *ctx, JSValue this_val) {
+    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
+    if (!de) {
+        return JS_EXCEPTION;
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+    return JS_NewBool(ctx, de->type == UV_DIRENT_CHAR);
 }
 
-static JSValue tjs_fs_mkdir(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
+static JSValue tjs_dirent_isdirectory(JSContext *ctx, JSValue this_val) {
+    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
+    if (!de) {
         return JS_EXCEPTION;
     }
 
-    int32_t mode = 0777;
-    if (argc >= 2 && !JS_IsUndefined(argv[1])) {
-        if (JS_ToInt32(ctx, &mode, argv[1])) {
-            JS_FreeCString(ctx, path);
-            return JS_EXCEPTION;
-        }
+    return JS_NewBool(ctx, de->type == UV_DIRENT_DIR);
+}
+
+static JSValue tjs_dirent_isfifo(JSContext *ctx, JSValue this_val) {
+    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
+    if (!de) {
+        return JS_EXCEPTION;
     }
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
+    return JS_NewBool(ctx, de->type == UV_DIRENT_FIFO);
+}
+
+static JSValue tjs_dirent_isfile(JSContext *ctx, JSValue this_val) {
+    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
+    if (!de) {
         return JS_EXCEPTION;
     }
 
-    int r = uv_fs_mkdir(tjs_get_loop(ctx), &fr->req, path, mode, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+    return JS_NewBool(ctx, de->type == UV_DIRENT_FILE);
+}
+
+static JSValue tjs_dirent_issocket(JSContext *ctx, JSValue this_val) {
+    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
+    if (!de) {
+        return JS_EXCEPTION;
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+    return JS_NewBool(ctx, de->type == UV_DIRENT_SOCKET);
 }
 
-static JSValue tjs_fs_mkdir_sync(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
+static JSValue tjs_dirent_issymlink(JSContext *ctx, JSValue this_val) {
+    TJSDirEnt *de = tjs_dirent_get(ctx, this_val);
+    if (!de) {
         return JS_EXCEPTION;
     }
 
-    int32_t mode = 0777;
-    if (argc >= 2 && !JS_IsUndefined(argv[1])) {
-        if (JS_ToInt32(ctx, &mode, argv[1])) {
-            JS_FreeCString(ctx, path);
-            return JS_EXCEPTION;
-        }
+    return JS_NewBool(ctx, de->type == UV_DIRENT_LINK);
+}
+
+/* StatResult functions */
+
+static JSValue tjs_stat_isblockdevice(JSContext *ctx, JSValue this_val) {
+    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
+    if (!sr) {
+        return JS_EXCEPTION;
     }
 
-    uv_fs_t req;
-    int r = uv_fs_mkdir(NULL, &req, path, mode, NULL);
-    JS_FreeCString(ctx, path);
-    uv_fs_req_cleanup(&req);
-    if (r != 0) {
-        return tjs_throw_errno(ctx, r);
+    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFBLK);
+}
+
+static JSValue tjs_stat_ischaracterdevice(JSContext *ctx, JSValue this_val) {
+    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
+    if (!sr) {
+        return JS_EXCEPTION;
     }
 
-    return JS_UNDEFINED;
+    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFCHR);
 }
 
-static JSValue tjs_fs_copyfile(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path = JS_ToCString(ctx, argv[0]);
+static JSValue tjs_stat_isdirectory(JSContext *ctx, JSValue this_val) {
+    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
+    if (!sr) {
+        return JS_EXCEPTION;
+    }
+
+    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFDIR);
+}
+
+static JSValue tjs_stat_isfifo(JSContext *ctx, JSValue this_val) {
+    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
+    if (!sr) {
+        return JS_EXCEPTION;
+    }
+
+    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFIFO);
+}
+
+static JSValue tjs_stat_isfile(JSContext *ctx, JSValue this_val) {
+    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
+    if (!sr) {
+        return JS_EXCEPTION;
+    }
+
+    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFREG);
+}
+
+static JSValue tjs_stat_issocket(JSContext *ctx, JSValue this_val) {
+    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
+    if (!sr) {
+        return JS_EXCEPTION;
+    }
+
+#if defined(S_IFSOCK)
+    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFSOCK);
+#else
+    return JS_FALSE;
+#endif
+}
+
+static JSValue tjs_stat_issymlink(JSContext *ctx, JSValue this_val) {
+    TJSStatResult *sr = tjs_stat_get(ctx, this_val);
+    if (!sr) {
+        return JS_EXCEPTION;
+    }
+
+    return JS_NewBool(ctx, (sr->st_mode & S_IFMT) == S_IFLNK);
+}
+
+/* Module functions */
+
+static int js__uv_open_flags(const char *strflags, size_t len) {
+    int flags = 0, read = 0, write = 0;
+
+    for (int i = 0; i < len; i++) {
+        switch (strflags[i]) {
+            case 'r':
+                read = 1;
+                break;
+            case 'w':
+                write = 1;
+                flags |= O_TRUNC | O_CREAT;
+                break;
+            case 'a':
+                write = 1;
+                flags |= O_APPEND | O_CREAT;
+                break;
+            case '+':
+                read = 1;
+                write = 1;
+                break;
+            case 'x':
+                flags |= O_EXCL;
+                break;
+            default:
+                break;
+        }
+    }
+
+    flags |= read ? (write ? O_RDWR : O_RDONLY) : (write ? O_WRONLY : 0);
+
+    return flags;
+}
+
+static JSValue tjs_fs_open(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *path;
+    const char *strflags;
+    size_t len;
+    int flags;
+    int32_t mode;
+
+    path = JS_ToCString(ctx, argv[0]);
     if (!path) {
         return JS_EXCEPTION;
     }
 
-    const char *new_path = JS_ToCString(ctx, argv[1]);
-    if (!new_path) {
+    strflags = JS_ToCStringLen(ctx, &len, argv[1]);
+    if (!strflags) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+    flags = js__uv_open_flags(strflags, len);
+    JS_FreeCString(ctx, strflags);
+
+    mode = 0666;
+    if (!JS_IsUndefined(argv[2]) && JS_ToInt32(ctx, &mode, argv[2])) {
         JS_FreeCString(ctx, path);
         return JS_EXCEPTION;
     }
@@ -1219,13 +1773,11 @@ static JSValue tjs_fs_copyfile(JSContext *ctx, JSValue this_val, int argc, JSVal
     TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
     if (!fr) {
         JS_FreeCString(ctx, path);
-        JS_FreeCString(ctx, new_path);
         return JS_EXCEPTION;
     }
 
-    int r = uv_fs_copyfile(tjs_get_loop(ctx), &fr->req, path, new_path, 0, uv__fs_req_cb);
+    int r = uv_fs_open(tjs_get_loop(ctx), &fr->req, path, flags, mode, uv__fs_req_cb);
     JS_FreeCString(ctx, path);
-    JS_FreeCString(ctx, new_path);
     if (r != 0) {
         js_free(ctx, fr);
         return tjs_throw_errno(ctx, r);
@@ -1234,7 +1786,28 @@ static JSValue tjs_fs_copyfile(JSContext *ctx, JSValue this_val, int argc, JSVal
     return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
 }
 
-static JSValue tjs_fs_readdir(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+static JSValue tjs_fs_new_stdio_file(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *path;
+    uv_file fd;
+
+    path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    if (JS_ToInt32(ctx, &fd, argv[1])) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    JSValue obj = tjs_new_file(ctx, fd, path);
+
+    JS_FreeCString(ctx, path);
+
+    return obj;
+}
+
+static JSValue tjs_fs_stat(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
     const char *path = JS_ToCString(ctx, argv[0]);
     if (!path) {
         return JS_EXCEPTION;
@@ -1246,7 +1819,12 @@ static JSValue tjs_fs_readdir(JSContext *ctx, JSValue this_val, int argc, JSValu
         return JS_EXCEPTION;
     }
 
-    int r = uv_fs_opendir(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    int r;
+    if (magic) {
+        r = uv_fs_lstat(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    } else {
+        r = uv_fs_stat(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    }
     JS_FreeCString(ctx, path);
     if (r != 0) {
         js_free(ctx, fr);
@@ -1256,115 +1834,2149 @@ static JSValue tjs_fs_readdir(JSContext *ctx, JSValue this_val, int argc, JSValu
     return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
 }
 
-static void tjs__readfile_work_cb(uv_work_t *req) {
-    TJSReadFileReq *fr = req->data;
-    CHECK_NOT_NULL(fr);
-
-    fr->r = tjs__load_file(fr->ctx, &fr->dbuf, fr->filename);
+static JSValue tjs_fs_stat_sync(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    uv_fs_t req;
+    int r = uv_fs_stat(NULL, &req, path, NULL);
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        uv_fs_req_cleanup(&req);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    JSValue ret = tjs_new_stat(ctx, &req.statbuf);
+    uv_fs_req_cleanup(&req);
+
+    return ret;
+}
+
+static JSValue tjs_fs_realpath(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_realpath(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_unlink(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_unlink(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_rename(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    const char *new_path = JS_ToCString(ctx, argv[1]);
+    if (!new_path) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        JS_FreeCString(ctx, new_path);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_rename(tjs_get_loop(ctx), &fr->req, path, new_path, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    JS_FreeCString(ctx, new_path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_mkdtemp(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *tpl = JS_ToCString(ctx, argv[0]);
+    if (!tpl) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, tpl);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_mkdtemp(tjs_get_loop(ctx), &fr->req, tpl, uv__fs_req_cb);
+    JS_FreeCString(ctx, tpl);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_mkstemp(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *tpl = JS_ToCString(ctx, argv[0]);
+    if (!tpl) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, tpl);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_mkstemp(tjs_get_loop(ctx), &fr->req, tpl, uv__fs_req_cb);
+    JS_FreeCString(ctx, tpl);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_rmdir(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_rmdir(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_mkdir(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    int32_t mode = 0777;
+    if (argc >= 2 && !JS_IsUndefined(argv[1])) {
+        if (JS_ToInt32(ctx, &mode, argv[1])) {
+            JS_FreeCString(ctx, path);
+            return JS_EXCEPTION;
+        }
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_mkdir(tjs_get_loop(ctx), &fr->req, path, mode, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_mkdir_sync(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    int32_t mode = 0777;
+    if (argc >= 2 && !JS_IsUndefined(argv[1])) {
+        if (JS_ToInt32(ctx, &mode, argv[1])) {
+            JS_FreeCString(ctx, path);
+            return JS_EXCEPTION;
+        }
+    }
+
+    uv_fs_t req;
+    int r = uv_fs_mkdir(NULL, &req, path, mode, NULL);
+    JS_FreeCString(ctx, path);
+    uv_fs_req_cleanup(&req);
+    if (r != 0) {
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return JS_UNDEFINED;
+}
+
+static JSValue tjs_fs_copyfile(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    const char *new_path = JS_ToCString(ctx, argv[1]);
+    if (!new_path) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    /* arg 2: options. Cloning (reflinks) is attempted by default, libuv falls back to
+     * copy_file_range / sendfile so the data never goes through userland buffers. */
+    int flags = UV_FS_COPYFILE_FICLONE;
+    if (JS_IsObject(argv[2])) {
+        JSValue js_exclusive = JS_GetPropertyStr(ctx, argv[2], "exclusive");
+        if (JS_ToBool(ctx, js_exclusive)) {
+            flags |= UV_FS_COPYFILE_EXCL;
+        }
+        JS_FreeValue(ctx, js_exclusive);
+
+        JSValue js_clone = JS_GetPropertyStr(ctx, argv[2], "clone");
+        if (JS_IsString(js_clone)) {
+            const char *clone = JS_ToCString(ctx, js_clone);
+            if (clone && strcmp(clone, "force") == 0) {
+                flags |= UV_FS_COPYFILE_FICLONE_FORCE;
+            }
+            JS_FreeCString(ctx, clone);
+        } else if (!JS_IsUndefined(js_clone) && !JS_ToBool(ctx, js_clone)) {
+            flags &= ~UV_FS_COPYFILE_FICLONE;
+        }
+        JS_FreeValue(ctx, js_clone);
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        JS_FreeCString(ctx, new_path);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_copyfile(tjs_get_loop(ctx), &fr->req, path, new_path, flags, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    JS_FreeCString(ctx, new_path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_readdir(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    uint32_t batch_size = TJS__DIR_BATCH_SIZE;
+    bool all = false;
+    bool with_file_types = false;
+
+    /* arg 1: options */
+    if (JS_IsObject(argv[1])) {
+        JSValue js_batch_size = JS_GetPropertyStr(ctx, argv[1], "batchSize");
+        if (!JS_IsUndefined(js_batch_size)) {
+            int r = JS_ToUint32(ctx, &batch_size, js_batch_size);
+            JS_FreeValue(ctx, js_batch_size);
+            if (r != 0) {
+                return JS_EXCEPTION;
+            }
+            if (batch_size == 0) {
+                return JS_ThrowRangeError(ctx, "batchSize must be greater than 0");
+            }
+        }
+
+        /* With all, the entries are returned at once in an array (of names, unless withFileTypes is set). */
+        JSValue js_all = JS_GetPropertyStr(ctx, argv[1], "all");
+        all = JS_ToBool(ctx, js_all);
+        JS_FreeValue(ctx, js_all);
+
+        JSValue js_with_file_types = JS_GetPropertyStr(ctx, argv[1], "withFileTypes");
+        with_file_types = JS_ToBool(ctx, js_with_file_types);
+        JS_FreeValue(ctx, js_with_file_types);
+    }
+
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    int r;
+    if (all) {
+        r = uv_fs_scandir(tjs_get_loop(ctx), &fr->req, path, 0, uv__fs_req_cb);
+    } else {
+        r = uv_fs_opendir(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    }
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    JSValue ret = tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+    fr->dir.batch_size = batch_size;
+    fr->dir.with_file_types = with_file_types;
+
+    return ret;
+}
+
+static void tjs__readfile_work_cb(uv_work_t *req) {
+    TJSReadFileReq *fr = req->data;
+    CHECK_NOT_NULL(fr);
+
+    fr->r = tjs__load_file(fr->ctx, &fr->dbuf, fr->filename);
+}
+
+static void tjs__readfile_after_work_cb(uv_work_t *req, int status) {
+    TJSReadFileReq *fr = req->data;
+    CHECK_NOT_NULL(fr);
+
+    JSContext *ctx = fr->ctx;
+    JSValue arg;
+    bool is_reject = false;
+
+    if (status != 0) {
+        arg = tjs_new_error(ctx, status);
+        is_reject = true;
+        dbuf_free(&fr->dbuf);
+    } else if (fr->r < 0) {
+        arg = tjs_new_error(ctx, fr->r);
+        is_reject = true;
+        dbuf_free(&fr->dbuf);
+    } else if (fr->text) {
+        /* Decode straight from the read buffer, skipping the UTF-8 BOM like TextDecoder does. */
+        const char *p = (const char *) fr->dbuf.buf;
+        size_t len = fr->dbuf.size;
+        if (len >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0) {
+            p += 3;
+            len -= 3;
+        }
+        arg = JS_NewStringLen(ctx, p, len);
+        dbuf_free(&fr->dbuf);
+    } else {
+        arg = TJS_NewUint8Array(ctx, fr->dbuf.buf, fr->dbuf.size);
+        if (JS_IsException(arg)) {
+            dbuf_free(&fr->dbuf);
+        }
+    }
+
+    TJS_SettlePromise(ctx, &fr->result, is_reject, 1, &arg);
+
+    js_free(ctx, fr->filename);
+    js_free(ctx, fr);
+}
+
+static JSValue tjs_fs_readfile(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSReadFileReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    fr->ctx = ctx;
+    tjs_dbuf_init(ctx, &fr->dbuf);
+    fr->r = -1;
+    fr->text = magic;
+    fr->filename = js_strdup(ctx, path);
+    fr->req.data = fr;
+    JS_FreeCString(ctx, path);
+
+    int r = uv_queue_work(tjs_get_loop(ctx), &fr->req, tjs__readfile_work_cb, tjs__readfile_after_work_cb);
+    if (r != 0) {
+        js_free(ctx, fr->filename);
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return TJS_InitPromise(ctx, &fr->result);
+}
+
+static int tjs__write_all(uv_file fd, const uint8_t *buf, size_t len) {
+    uv_fs_t req;
+    size_t offset = 0;
+
+    while (offset < len) {
+        size_t chunk = len - offset;
+        uv_buf_t b = uv_buf_init((char *) buf + offset, chunk > INT32_MAX ? INT32_MAX : chunk);
+        int r = uv_fs_write(NULL, &req, fd, &b, 1, -1, NULL);
+        uv_fs_req_cleanup(&req);
+        if (r < 0) {
+            return r;
+        }
+        offset += r;
+    }
+
+    return 0;
+}
+
+static int tjs__write_file(const char *path, const uint8_t *buf, size_t len, int mode, bool append) {
+    uv_fs_t req;
+    int flags = UV_FS_O_WRONLY | UV_FS_O_CREAT | (append ? UV_FS_O_APPEND : UV_FS_O_TRUNC);
+
+    int fd = uv_fs_open(NULL, &req, path, flags, mode, NULL);
+    uv_fs_req_cleanup(&req);
+    if (fd < 0) {
+        return fd;
+    }
+
+    int r = tjs__write_all(fd, buf, len);
+
+    int r2 = uv_fs_close(NULL, &req, fd, NULL);
+    uv_fs_req_cleanup(&req);
+
+    return r < 0 ? r : r2;
+}
+
+/* Writes to a temporary file next to the target, syncs it and renames it over the target,
+ * so readers observe either the old or the new contents, never a partial write. */
+static int tjs__write_file_atomic(const char *path, const uint8_t *buf, size_t len, int mode) {
+    uv_fs_t req;
+    size_t path_len = strlen(path);
+    char *tmp_path = tjs__malloc(path_len + 32);
+    int fd = UV_EEXIST;
+    int r;
+
+    if (!tmp_path) {
+        return UV_ENOMEM;
+    }
+
+    for (int i = 0; i < 8 && fd == UV_EEXIST; i++) {
+        uint32_t rnd;
+        r = uv_random(NULL, NULL, &rnd, sizeof(rnd), 0, NULL);
+        if (r != 0) {
+            tjs__free(tmp_path);
+            return r;
+        }
+        snprintf(tmp_path, path_len + 32, "%s.%08x.tmp", path, rnd);
+        fd = uv_fs_open(NULL, &req, tmp_path, UV_FS_O_WRONLY | UV_FS_O_CREAT | UV_FS_O_EXCL, mode, NULL);
+        uv_fs_req_cleanup(&req);
+    }
+
+    if (fd < 0) {
+        tjs__free(tmp_path);
+        return fd;
+    }
+
+    /* Keep the permissions of the file being replaced. */
+    if (uv_fs_stat(NULL, &req, path, NULL) == 0) {
+        uv_fs_t chmod_req;
+        uv_fs_fchmod(NULL, &chmod_req, fd, req.statbuf.st_mode & 07777, NULL);
+        uv_fs_req_cleanup(&chmod_req);
+    }
+    uv_fs_req_cleanup(&req);
+
+    r = tjs__write_all(fd, buf, len);
+    if (r == 0) {
+        r = uv_fs_fsync(NULL, &req, fd, NULL);
+        uv_fs_req_cleanup(&req);
+    }
+
+    int r2 = uv_fs_close(NULL, &req, fd, NULL);
+    uv_fs_req_cleanup(&req);
+    if (r == 0) {
+        r = r2;
+    }
+
+    if (r == 0) {
+        r = uv_fs_rename(NULL, &req, tmp_path, path, NULL);
+        uv_fs_req_cleanup(&req);
+    }
+
+    if (r != 0) {
+        uv_fs_unlink(NULL, &req, tmp_path, NULL);
+        uv_fs_req_cleanup(&req);
+    }
+
+    tjs__free(tmp_path);
+
+    return r;
+}
+
+static void tjs__writefile_work_cb(uv_work_t *req) {
+    TJSWriteFileReq *wr = req->data;
+    CHECK_NOT_NULL(wr);
+
+    if (wr->atomic) {
+        wr->r = tjs__write_file_atomic(wr->path, wr->buf, wr->len, wr->mode);
+    } else {
+        wr->r = tjs__write_file(wr->path, wr->buf, wr->len, wr->mode, wr->append);
+    }
+}
+
+static void tjs__writefile_after_work_cb(uv_work_t *req, int status) {
+    TJSWriteFileReq *wr = req->data;
+    CHECK_NOT_NULL(wr);
+
+    JSContext *ctx = wr->ctx;
+    JSValue arg = JS_UNDEFINED;
+    bool is_reject = false;
+
+    if (status != 0) {
+        arg = tjs_new_error(ctx, status);
+        is_reject = true;
+    } else if (wr->r < 0) {
+        arg = tjs_new_error(ctx, wr->r);
+        is_reject = true;
+    }
+
+    TJS_SettlePromise(ctx, &wr->result, is_reject, 1, &arg);
+
+    if (wr->str) {
+        JS_FreeCString(ctx, wr->str);
+    }
+    JS_FreeValue(ctx, wr->data);
+    js_free(ctx, wr->path);
+    js_free(ctx, wr);
+}
+
+static JSValue tjs_fs_writefile(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
+    const char *str = NULL;
+    const uint8_t *buf;
+    size_t len;
+    int32_t mode = 0666;
+    bool atomic = false;
+
+    /* arg 2: options */
+    JSValue opts = argv[2];
+    if (JS_IsObject(opts)) {
+        JSValue js_mode = JS_GetPropertyStr(ctx, opts, "mode");
+        int ret = !JS_IsUndefined(js_mode) && JS_ToInt32(ctx, &mode, js_mode);
+        JS_FreeValue(ctx, js_mode);
+        if (ret) {
+            return JS_EXCEPTION;
+        }
+
+        if (!magic) {
+            JSValue js_atomic = JS_GetPropertyStr(ctx, opts, "atomic");
+            atomic = JS_ToBool(ctx, js_atomic);
+            JS_FreeValue(ctx, js_atomic);
+        }
+    }
+
+    /* arg 1: data, written straight from the JS memory, which is kept alive until the write is done */
+    if (JS_IsString(argv[1])) {
+        str = JS_ToCStringLen(ctx, &len, argv[1]);
+        if (!str) {
+            return JS_EXCEPTION;
+        }
+        buf = (const uint8_t *) str;
+    } else if (JS_IsArrayBuffer(argv[1])) {
+        buf = JS_GetArrayBuffer(ctx, &len, argv[1]);
+        if (!buf && len != 0) {
+            return JS_EXCEPTION;
+        }
+    } else {
+        size_t offset, bpe;
+        JSValue abuf = JS_GetTypedArrayBuffer(ctx, argv[1], &offset, &len, &bpe);
+        if (JS_IsException(abuf)) {
+            JS_FreeValue(ctx, JS_GetException(ctx));
+            return JS_ThrowTypeError(ctx, "expected a string, ArrayBuffer or TypedArray");
+        }
+        size_t abuf_len;
+        buf = JS_GetArrayBuffer(ctx, &abuf_len, abuf);
+        JS_FreeValue(ctx, abuf);
+        if (!buf && len != 0) {
+            return JS_EXCEPTION;
+        }
+        buf += offset;
+    }
+
+    /* arg 0: path */
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        if (str) {
+            JS_FreeCString(ctx, str);
+        }
+        return JS_EXCEPTION;
+    }
+
+    TJSWriteFileReq *wr = js_mallocz(ctx, sizeof(*wr));
+    if (!wr) {
+        JS_FreeCString(ctx, path);
+        if (str) {
+            JS_FreeCString(ctx, str);
+        }
+        return JS_EXCEPTION;
+    }
+
+    wr->ctx = ctx;
+    wr->path = js_strdup(ctx, path);
+    wr->data = JS_DupValue(ctx, argv[1]);
+    wr->str = str;
+    wr->buf = buf;
+    wr->len = len;
+    wr->mode = mode;
+    wr->append = magic;
+    wr->atomic = atomic;
+    wr->req.data = wr;
+    JS_FreeCString(ctx, path);
+
+    int r = uv_queue_work(tjs_get_loop(ctx), &wr->req, tjs__writefile_work_cb, tjs__writefile_after_work_cb);
+    if (r != 0) {
+        if (str) {
+            JS_FreeCString(ctx, str);
+        }
+        JS_FreeValue(ctx, wr->data);
+        js_free(ctx, wr->path);
+        js_free(ctx, wr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return TJS_InitPromise(ctx, &wr->result);
+}
+
+/* Memory mapped files */
+
+enum {
+    TJS_MAP_ADVICE_NONE = -1,
+    TJS_MAP_ADVICE_NORMAL = 0,
+    TJS_MAP_ADVICE_SEQUENTIAL,
+    TJS_MAP_ADVICE_RANDOM,
+    TJS_MAP_ADVICE_WILLNEED,
+    TJS_MAP_ADVICE_DONTNEED,
+};
+
+typedef struct TJSFileMapping {
+    void *base;
+    size_t len;
+    /* Private mappings are registered while their ArrayBuffer is alive, so unmapFile can tell them apart. */
+    uint8_t *data;
+    struct TJSFileMapping *prev;
+    struct TJSFileMapping *next;
+} TJSFileMapping;
+
+static struct {
+    uv_once_t once;
+    uv_mutex_t lock;
+    TJSFileMapping *head;
+} tjs__mappings = { .once = UV_ONCE_INIT };
+
+static void tjs__mappings_init_once(void) {
+    CHECK_EQ(uv_mutex_init(&tjs__mappings.lock), 0);
+}
+
+static void tjs__mappings_add(TJSFileMapping *m) {
+    uv_once(&tjs__mappings.once, tjs__mappings_init_once);
+    uv_mutex_lock(&tjs__mappings.lock);
+    m->prev = NULL;
+    m->next = tjs__mappings.head;
+    if (m->next) {
+        m->next->prev = m;
+    }
+    tjs__mappings.head = m;
+    uv_mutex_unlock(&tjs__mappings.lock);
+}
+
+static void tjs__mappings_remove(TJSFileMapping *m) {
+    uv_mutex_lock(&tjs__mappings.lock);
+    if (m->prev) {
+        m->prev->next = m->next;
+    } else {
+        tjs__mappings.head = m->next;
+    }
+    if (m->next) {
+        m->next->prev = m->prev;
+    }
+    uv_mutex_unlock(&tjs__mappings.lock);
+}
+
+static bool tjs__mappings_has(const uint8_t *data) {
+    bool found = false;
+    uv_once(&tjs__mappings.once, tjs__mappings_init_once);
+    uv_mutex_lock(&tjs__mappings.lock);
+    for (TJSFileMapping *m = tjs__mappings.head; m; m = m->next) {
+        if (m->data == data) {
+            found = true;
+            break;
+        }
+    }
+    uv_mutex_unlock(&tjs__mappings.lock);
+    return found;
+}
+
+typedef struct {
+    uv_work_t req;
+    JSContext *ctx;
+    char *path;
+    int64_t offset;
+    int64_t length;
+    bool writable;
+    bool shared;
+    int advice;
+    int r;
+    uint8_t *data;
+    size_t data_len;
+    TJSFileMapping *mapping;
+    TJSPromise result;
+} TJSMapFileReq;
+
+static void tjs__unmap(void *base, size_t len) {
+    if (!base) {
+        /* Empty mapping. */
+        return;
+    }
+#if defined(_WIN32)
+    (void) len;
+    UnmapViewOfFile(base);
+#else
+    munmap(base, len);
+#endif
+}
+
+static void tjs__mapping_free(JSRuntime *rt, void *opaque, void *ptr) {
+    TJSFileMapping *m = opaque;
+    tjs__mappings_remove(m);
+    tjs__unmap(m->base, m->len);
+    tjs__free(m);
+}
+
+/* Shared mappings live right after a private page holding their bookkeeping and SAB header. */
+static void tjs__mapping_sab_release(TJSSABHeader *sab) {
+    TJSFileMapping m = *(TJSFileMapping *) ((uint8_t *) sab - sizeof(TJSFileMapping));
+    tjs__unmap(m.base, m.len);
+}
+
+static void tjs__madvise(void *base, size_t len, int advice) {
+#if !defined(_WIN32)
+    static const int advices[] = {
+        [TJS_MAP_ADVICE_NORMAL] = POSIX_MADV_NORMAL,     [TJS_MAP_ADVICE_SEQUENTIAL] = POSIX_MADV_SEQUENTIAL,
+        [TJS_MAP_ADVICE_RANDOM] = POSIX_MADV_RANDOM,     [TJS_MAP_ADVICE_WILLNEED] = POSIX_MADV_WILLNEED,
+        [TJS_MAP_ADVICE_DONTNEED] = POSIX_MADV_DONTNEED,
+    };
+    if (advice != TJS_MAP_ADVICE_NONE) {
+        posix_madvise(base, len, advices[advice]);
+    }
+#else
+    (void) base;
+    (void) len;
+    (void) advice;
+#endif
+}
+
+static void tjs__mapfile_work_cb(uv_work_t *req) {
+    TJSMapFileReq *mr = req->data;
+    CHECK_NOT_NULL(mr);
+
+    uv_fs_t fs_req;
+    int fd = uv_fs_open(NULL, &fs_req, mr->path, mr->writable ? UV_FS_O_RDWR : UV_FS_O_RDONLY, 0, NULL);
+    uv_fs_req_cleanup(&fs_req);
+    if (fd < 0) {
+        mr->r = fd;
+        return;
+    }
+
+    mr->r = uv_fs_fstat(NULL, &fs_req, fd, NULL);
+    uint64_t size = fs_req.statbuf.st_size;
+    uv_fs_req_cleanup(&fs_req);
+    if (mr->r < 0) {
+        goto end;
+    }
+
+    if ((uint64_t) mr->offset > size) {
+        mr->r = UV_EINVAL;
+        goto end;
+    }
+
+    /* Never map past the end of the file, touching those pages would raise SIGBUS. */
+    uint64_t len = size - mr->offset;
+    if (mr->length >= 0 && (uint64_t) mr->length < len) {
+        len = mr->length;
+    }
+    if (len == 0) {
+        goto end;
+    }
+
+#if defined(_WIN32)
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    uint64_t granularity = si.dwAllocationGranularity;
+#else
+    uint64_t granularity = sysconf(_SC_PAGESIZE);
+#endif
+    uint64_t aligned_offset = mr->offset & ~(granularity - 1);
+    size_t delta = mr->offset - aligned_offset;
+    size_t map_len = delta + len;
+
+#if defined(_WIN32)
+    if (mr->shared) {
+        mr->r = UV_ENOTSUP;
+        goto end;
+    }
+
+    HANDLE fh = (HANDLE) uv_get_osfhandle(fd);
+    HANDLE mh = CreateFileMappingW(fh, NULL, mr->writable ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, NULL);
+    if (!mh) {
+        mr->r = uv_translate_sys_error(GetLastError());
+        goto end;
+    }
+    uint8_t *base = MapViewOfFile(mh,
+                                  mr->writable ? FILE_MAP_WRITE : FILE_MAP_COPY,
+                                  (DWORD) (aligned_offset >> 32),
+                                  (DWORD) aligned_offset,
+                                  map_len);
+    CloseHandle(mh);
+    if (!base) {
+        mr->r = uv_translate_sys_error(GetLastError());
+        goto end;
+    }
+#else
+    /* Read-only mappings are private (copy-on-write), so stray writes from JS never fault. */
+    int prot = PROT_READ | PROT_WRITE;
+    int flags = mr->writable ? MAP_SHARED : MAP_PRIVATE;
+    uint8_t *base;
+
+    if (mr->shared) {
+        /* The SharedArrayBuffer header must directly precede the data. */
+        if (delta != 0) {
+            mr->r = UV_EINVAL;
+            goto end;
+        }
+        size_t total_len = granularity + map_len;
+        uint8_t *reserved = mmap(NULL, total_len, prot, MAP_PRIVATE | MAP_ANON, -1, 0);
+        if (reserved == MAP_FAILED) {
+            mr->r = -errno;
+            goto end;
+        }
+        base = mmap(reserved + granularity, map_len, prot, flags | MAP_FIXED, fd, aligned_offset);
+        if (base == MAP_FAILED) {
+            mr->r = -errno;
+            munmap(reserved, total_len);
+            goto end;
+        }
+        TJSSABHeader *sab = (TJSSABHeader *) (base - sizeof(TJSSABHeader));
+        sab->ref_count = 1;
+        sab->release = tjs__mapping_sab_release;
+        TJSFileMapping *m = (TJSFileMapping *) ((uint8_t *) sab - sizeof(TJSFileMapping));
+        m->base = reserved;
+        m->len = total_len;
+    } else {
+        base = mmap(NULL, map_len, prot, flags, fd, aligned_offset);
+        if (base == MAP_FAILED) {
+            mr->r = -errno;
+            goto end;
+        }
+    }
+#endif
+
+    tjs__madvise(base, map_len, mr->advice);
+
+    if (!mr->shared) {
+        mr->mapping = tjs__malloc(sizeof(*mr->mapping));
+        if (!mr->mapping) {
+            tjs__unmap(base, map_len);
+            mr->r = UV_ENOMEM;
+            goto end;
+        }
+        mr->mapping->base = base;
+        mr->mapping->len = map_len;
+    }
+
+    mr->data = base + delta;
+    mr->data_len = len;
+
+end:
+    /* The mapping stays valid after the file is closed. */
+    uv_fs_close(NULL, &fs_req, fd, NULL);
+    uv_fs_req_cleanup(&fs_req);
+}
+
+static void tjs__sab_free_func(JSRuntime *rt, void *opaque, void *ptr) {
+    tjs__sab_free(opaque, ptr);
+}
+
+/* Undoes a mapping which never made it into an ArrayBuffer. */
+static void tjs__mapfile_release(TJSMapFileReq *mr) {
+    if (mr->shared) {
+        if (mr->data) {
+            tjs__mapping_sab_release((TJSSABHeader *) (mr->data - sizeof(TJSSABHeader)));
+        }
+    } else if (mr->mapping) {
+        tjs__unmap(mr->mapping->base, mr->mapping->len);
+        tjs__free(mr->mapping);
+    }
+    mr->data = NULL;
+    mr->mapping = NULL;
+}
+
+static void tjs__mapfile_after_work_cb(uv_work_t *req, int status) {
+    TJSMapFileReq *mr = req->data;
+    CHECK_NOT_NULL(mr);
+
+    JSContext *ctx = mr->ctx;
+    JSValue arg;
+    bool is_reject = false;
+
+    if (status != 0) {
+        /* Cancelled, whatever got mapped is released. */
+        tjs__mapfile_release(mr);
+        arg = tjs_new_error(ctx, status);
+        is_reject = true;
+    } else if (mr->r < 0) {
+        arg = tjs_new_error(ctx, mr->r);
+        is_reject = true;
+    } else if (!mr->data && mr->shared) {
+        /* Empty file or range. */
+        uint8_t *buf = tjs__sab_alloc(NULL, 1);
+        arg = buf ? JS_NewArrayBuffer(ctx, buf, 0, tjs__sab_free_func, NULL, true) : JS_ThrowOutOfMemory(ctx);
+    } else if (mr->shared) {
+        arg = JS_NewArrayBuffer(ctx, mr->data, mr->data_len, tjs__sab_free_func, NULL, true);
+    } else {
+        /* Empty ranges get an empty mapping, so they can be unmapped like any other. Its address stands in
+         * for the data pointer, which identifies the mapping. */
+        if (!mr->mapping) {
+            mr->mapping = tjs__mallocz(sizeof(*mr->mapping));
+            mr->data = (uint8_t *) mr->mapping;
+            mr->data_len = 0;
+        }
+        if (!mr->mapping) {
+            arg = JS_ThrowOutOfMemory(ctx);
+        } else {
+            mr->mapping->data = mr->data;
+            arg = JS_NewArrayBuffer(ctx, mr->data, mr->data_len, tjs__mapping_free, mr->mapping, false);
+            if (!JS_IsException(arg)) {
+                tjs__mappings_add(mr->mapping);
+            }
+        }
+    }
+
+    if (JS_IsException(arg)) {
+        tjs__mapfile_release(mr);
+        arg = JS_GetException(ctx);
+        is_reject = true;
+    }
+
+    TJS_SettlePromise(ctx, &mr->result, is_reject, 1, &arg);
+
+    js_free(ctx, mr->path);
+    js_free(ctx, mr);
+}
+
+static JSValue tjs_fs_mapfile(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    int64_t offset = 0;
+    int64_t length = -1;
+    bool writable = false;
+    bool shared = false;
+    int advice = TJS_MAP_ADVICE_NONE;
+
+    /* arg 1: options */
+    JSValue opts = argv[1];
+    if (JS_IsObject(opts)) {
+        JSValue js_offset = JS_GetPropertyStr(ctx, opts, "offset");
+        if (!JS_IsUndefined(js_offset) && (JS_ToInt64(ctx, &offset, js_offset) || offset < 0)) {
+            JS_FreeValue(ctx, js_offset);
+            return JS_ThrowRangeError(ctx, "offset must be a positive integer");
+        }
+        JS_FreeValue(ctx, js_offset);
+
+        JSValue js_length = JS_GetPropertyStr(ctx, opts, "length");
+        if (!JS_IsUndefined(js_length) && (JS_ToInt64(ctx, &length, js_length) || length < 0)) {
+            JS_FreeValue(ctx, js_length);
+            return JS_ThrowRangeError(ctx, "length must be a positive integer");
+        }
+        JS_FreeValue(ctx, js_length);
+
+        JSValue js_mode = JS_GetPropertyStr(ctx, opts, "mode");
+        if (!JS_IsUndefined(js_mode)) {
+            const char *mode = JS_ToCString(ctx, js_mode);
+            JS_FreeValue(ctx, js_mode);
+            if (!mode) {
+                return JS_EXCEPTION;
+            }
+            bool valid = strcmp(mode, "r") == 0 || strcmp(mode, "rw") == 0;
+            writable = strcmp(mode, "rw") == 0;
+            JS_FreeCString(ctx, mode);
+            if (!valid) {
+                return JS_ThrowTypeError(ctx, "mode must be 'r' or 'rw'");
+            }
+        }
+
+        JSValue js_shared = JS_GetPropertyStr(ctx, opts, "shared");
+        shared = JS_ToBool(ctx, js_shared);
+        JS_FreeValue(ctx, js_shared);
+
+        JSValue js_advice = JS_GetPropertyStr(ctx, opts, "advice");
+        if (!JS_IsUndefined(js_advice)) {
+            static const char *advices[] = { "normal", "sequential", "random", "willneed", "dontneed" };
+            const char *str = JS_ToCString(ctx, js_advice);
+            JS_FreeValue(ctx, js_advice);
+            if (!str) {
+                return JS_EXCEPTION;
+            }
+            for (int i = 0; i < countof(advices); i++) {
+                if (strcmp(str, advices[i]) == 0) {
+                    advice = i;
+                    break;
+                }
+            }
+            JS_FreeCString(ctx, str);
+            if (advice == TJS_MAP_ADVICE_NONE) {
+                return JS_ThrowTypeError(ctx, "invalid advice");
+            }
+        }
+    }
+
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSMapFileReq *mr = js_mallocz(ctx, sizeof(*mr));
+    if (!mr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    mr->ctx = ctx;
+    mr->path = js_strdup(ctx, path);
+    mr->offset = offset;
+    mr->length = length;
+    mr->writable = writable;
+    mr->shared = shared;
+    mr->advice = advice;
+    mr->req.data = mr;
+    JS_FreeCString(ctx, path);
+
+    int r = uv_queue_work(tjs_get_loop(ctx), &mr->req, tjs__mapfile_work_cb, tjs__mapfile_after_work_cb);
+    if (r != 0) {
+        js_free(ctx, mr->path);
+        js_free(ctx, mr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return TJS_InitPromise(ctx, &mr->result);
+}
+
+static JSValue tjs_fs_unmapfile(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    /* SharedArrayBuffers can't be detached, and other workers may still be using the mapping: it's released once
+     * the last of them is collected. */
+    if (!JS_IsArrayBuffer(argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected an ArrayBuffer returned by mapFile");
+    }
+
+    size_t size;
+    uint8_t *data = JS_GetArrayBuffer(ctx, &size, argv[0]);
+    if (!data) {
+        /* Already detached. */
+        return JS_EXCEPTION;
+    }
+    if (!tjs__mappings_has(data)) {
+        return JS_ThrowTypeError(ctx, "expected an ArrayBuffer returned by mapFile");
+    }
+
+    /* Detaching runs the free function, which unmaps the file. */
+    JS_DetachArrayBuffer(ctx, argv[0]);
+
+    return JS_UNDEFINED;
+}
+
+static JSValue tjs_fs_xchown(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
+    if (!JS_IsString(argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    }
+
+    int uid;
+    if (JS_IsUndefined(argv[1]) || JS_ToInt32(ctx, &uid, argv[1])) {
+        return JS_ThrowTypeError(ctx, "expected a number for uid parameter");
+    }
+
+    int gid;
+    if (JS_IsUndefined(argv[2]) || JS_ToInt32(ctx, &gid, argv[2])) {
+        return JS_ThrowTypeError(ctx, "expected a number for gid parameter");
+    }
+
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    int r = (magic == 1 ? uv_fs_lchown : uv_fs_chown)(tjs_get_loop(ctx), &fr->req, path, uid, gid, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_chmod(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    if (!JS_IsString(argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    }
+
+    int mode;
+    if (JS_IsUndefined(argv[1]) || JS_ToInt32(ctx, &mode, argv[1])) {
+        return JS_ThrowTypeError(ctx, "expected a number for mode parameter");
+    }
+
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_chmod(tjs_get_loop(ctx), &fr->req, path, mode, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_xutime(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
+    if (!JS_IsString(argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    }
+
+    double atime;
+    if (JS_ToFloat64(ctx, &atime, argv[1])) {
+        return JS_EXCEPTION;
+    }
+
+    double mtime;
+    if (JS_ToFloat64(ctx, &mtime, argv[2])) {
+        return JS_EXCEPTION;
+    }
+
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    /* Date.getTime is in ms, convert to seconds. */
+    int r = (magic == 1 ? uv_fs_lutime
+                        : uv_fs_utime)(tjs_get_loop(ctx), &fr->req, path, atime / 1000, mtime / 1000, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_readlink(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    if (!JS_IsString(argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    }
+
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_readlink(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_link(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    if (!JS_IsString(argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    }
+    if (!JS_IsString(argv[1])) {
+        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    }
+
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    const char *path2 = JS_ToCString(ctx, argv[1]);
+    if (!path2) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        JS_FreeCString(ctx, path2);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_link(tjs_get_loop(ctx), &fr->req, path, path2, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    JS_FreeCString(ctx, path2);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_symlink(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    if (!JS_IsString(argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    }
+    if (!JS_IsString(argv[1])) {
+        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    }
+
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    const char *path2 = JS_ToCString(ctx, argv[1]);
+    if (!path2) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    int flags;
+    if (JS_ToInt32(ctx, &flags, argv[2])) {
+        JS_FreeCString(ctx, path);
+        JS_FreeCString(ctx, path2);
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        JS_FreeCString(ctx, path2);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_symlink(tjs_get_loop(ctx), &fr->req, path, path2, flags, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    JS_FreeCString(ctx, path2);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+}
+
+static JSValue tjs_fs_statfs(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    if (!JS_IsString(argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    }
+
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
+    if (!fr) {
+        JS_FreeCString(ctx, path);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_fs_statfs(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    JS_FreeCString(ctx, path);
+    if (r != 0) {
+        js_free(ctx, fr);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
 }
 
-static void tjs__readfile_after_work_cb(uv_work_t *req, int status) {
-    TJSReadFileReq *fr = req->data;
-    CHECK_NOT_NULL(fr);
+/* Batched operations */
+
+/* Upper bound for the concurrency option, so a single batch can't take over the whole threadpool. */
+#define TJS__FS_BATCH_MAX_GROUPS 4
+
+enum {
+    TJS_FS_BATCH_STAT = 0,
+    TJS_FS_BATCH_LSTAT,
+    TJS_FS_BATCH_REALPATH,
+    TJS_FS_BATCH_UNLINK,
+    TJS_FS_BATCH_RENAME,
+    TJS_FS_BATCH_RMDIR,
+    TJS_FS_BATCH_MKDIR,
+    TJS_FS_BATCH_COPYFILE,
+    TJS_FS_BATCH_CHMOD,
+    TJS_FS_BATCH_READLINK,
+    TJS_FS_BATCH_LINK,
+    TJS_FS_BATCH_SYMLINK,
+};
+
+static const char *tjs_fs_batch_ops[] = {
+    [TJS_FS_BATCH_STAT] = "stat",         [TJS_FS_BATCH_LSTAT] = "lstat",       [TJS_FS_BATCH_REALPATH] = "realPath",
+    [TJS_FS_BATCH_UNLINK] = "unlink",     [TJS_FS_BATCH_RENAME] = "rename",     [TJS_FS_BATCH_RMDIR] = "rmdir",
+    [TJS_FS_BATCH_MKDIR] = "mkdir",       [TJS_FS_BATCH_COPYFILE] = "copyFile", [TJS_FS_BATCH_CHMOD] = "chmod",
+    [TJS_FS_BATCH_READLINK] = "readLink", [TJS_FS_BATCH_LINK] = "link",         [TJS_FS_BATCH_SYMLINK] = "symlink",
+};
+
+typedef struct {
+    int type;
+    char *path;
+    char *new_path;
+    int mode;
+    int r;
+    uv_stat_t statbuf;
+    char *str;
+} TJSFsBatchOp;
+
+typedef struct TJSFsBatch TJSFsBatch;
+
+typedef struct {
+    uv_work_t req;
+    TJSFsBatch *batch;
+    uint32_t start;
+    uint32_t end;
+} TJSFsBatchGroup;
+
+struct TJSFsBatch {
+    JSContext *ctx;
+    TJSFsBatchOp *ops;
+    uint32_t nops;
+    int ngroups;
+    int pending;
+    int status;
+    TJSPromise result;
+    TJSFsBatchGroup groups[TJS__FS_BATCH_MAX_GROUPS];
+};
+
+static char *tjs__fs_batch_strdup(const char *str) {
+    size_t len = strlen(str);
+    char *p = tjs__malloc(len + 1);
+    if (p) {
+        memcpy(p, str, len + 1);
+    }
+    return p;
+}
+
+static void tjs__fs_batch_run(TJSFsBatchOp *op) {
+    uv_fs_t req;
+
+    switch (op->type) {
+        case TJS_FS_BATCH_STAT:
+            op->r = uv_fs_stat(NULL, &req, op->path, NULL);
+            break;
+        case TJS_FS_BATCH_LSTAT:
+            op->r = uv_fs_lstat(NULL, &req, op->path, NULL);
+            break;
+        case TJS_FS_BATCH_REALPATH:
+            op->r = uv_fs_realpath(NULL, &req, op->path, NULL);
+            break;
+        case TJS_FS_BATCH_UNLINK:
+            op->r = uv_fs_unlink(NULL, &req, op->path, NULL);
+            break;
+        case TJS_FS_BATCH_RENAME:
+            op->r = uv_fs_rename(NULL, &req, op->path, op->new_path, NULL);
+            break;
+        case TJS_FS_BATCH_RMDIR:
+            op->r = uv_fs_rmdir(NULL, &req, op->path, NULL);
+            break;
+        case TJS_FS_BATCH_MKDIR:
+            op->r = uv_fs_mkdir(NULL, &req, op->path, op->mode, NULL);
+            break;
+        case TJS_FS_BATCH_COPYFILE:
+            op->r = uv_fs_copyfile(NULL, &req, op->path, op->new_path, 0, NULL);
+            break;
+        case TJS_FS_BATCH_CHMOD:
+            op->r = uv_fs_chmod(NULL, &req, op->path, op->mode, NULL);
+            break;
+        case TJS_FS_BATCH_READLINK:
+            op->r = uv_fs_readlink(NULL, &req, op->path, NULL);
+            break;
+        case TJS_FS_BATCH_LINK:
+            op->r = uv_fs_link(NULL, &req, op->path, op->new_path, NULL);
+            break;
+        case TJS_FS_BATCH_SYMLINK:
+            op->r = uv_fs_symlink(NULL, &req, op->path, op->new_path, op->mode, NULL);
+            break;
+        default:
+            abort();
+    }
+
+    if (op->r == 0) {
+        switch (op->type) {
+            case TJS_FS_BATCH_STAT:
+            case TJS_FS_BATCH_LSTAT:
+                op->statbuf = req.statbuf;
+                break;
+            case TJS_FS_BATCH_REALPATH:
+            case TJS_FS_BATCH_READLINK:
+                op->str = tjs__fs_batch_strdup(req.ptr);
+                if (!op->str) {
+                    op->r = UV_ENOMEM;
+                }
+                break;
+        }
+    }
+
+    uv_fs_req_cleanup(&req);
+}
+
+/* Runs on the threadpool. Operations in a group run in order. */
+static void tjs__fs_batch_work_cb(uv_work_t *req) {
+    TJSFsBatchGroup *g = req->data;
+    CHECK_NOT_NULL(g);
+
+    for (uint32_t i = g->start; i < g->end; i++) {
+        tjs__fs_batch_run(&g->batch->ops[i]);
+    }
+}
+
+static void tjs__fs_batch_free(JSContext *ctx, TJSFsBatch *b) {
+    for (uint32_t i = 0; i < b->nops; i++) {
+        js_free(ctx, b->ops[i].path);
+        js_free(ctx, b->ops[i].new_path);
+        tjs__free(b->ops[i].str);
+    }
+    js_free(ctx, b->ops);
+    js_free(ctx, b);
+}
+
+static void tjs__fs_batch_after_work_cb(uv_work_t *req, int status) {
+    TJSFsBatchGroup *g = req->data;
+    CHECK_NOT_NULL(g);
+
+    TJSFsBatch *b = g->batch;
+    JSContext *ctx = b->ctx;
+
+    if (status != 0) {
+        b->status = status;
+    }
+
+    if (--b->pending > 0) {
+        return;
+    }
 
-    JSContext *ctx = fr->ctx;
     JSValue arg;
     bool is_reject = false;
 
-    if (status != 0) {
-        arg = tjs_new_error(ctx, status);
+    if (b->status != 0) {
+        arg = tjs_new_error(ctx, b->status);
         is_reject = true;
-        dbuf_free(&fr->dbuf);
-    } else if (fr->r < 0) {
-        arg = tjs_new_error(ctx, fr->r);
+    } else {
+        arg = JS_NewArray(ctx);
+        for (uint32_t i = 0; i < b->nops; i++) {
+            TJSFsBatchOp *op = &b->ops[i];
+            JSValue v;
+            if (op->r < 0) {
+                v = tjs_new_error(ctx, op->r);
+            } else {
+                switch (op->type) {
+                    case TJS_FS_BATCH_STAT:
+                    case TJS_FS_BATCH_LSTAT:
+                        v = tjs_new_stat(ctx, &op->statbuf);
+                        break;
+                    case TJS_FS_BATCH_REALPATH:
+                    case TJS_FS_BATCH_READLINK:
+                        v = JS_NewString(ctx, op->str);
+                        break;
+                    default:
+                        v = JS_UNDEFINED;
+                        break;
+                }
+            }
+            JS_SetPropertyUint32(ctx, arg, i, v);
+        }
+    }
+
+    TJS_SettlePromise(ctx, &b->result, is_reject, 1, &arg);
+
+    tjs__fs_batch_free(ctx, b);
+}
+
+static char *tjs__fs_batch_get_path(JSContext *ctx, JSValue obj, const char *prop) {
+    JSValue val = JS_GetPropertyStr(ctx, obj, prop);
+    if (JS_IsException(val)) {
+        return NULL;
+    }
+    if (!JS_IsString(val)) {
+        JS_FreeValue(ctx, val);
+        JS_ThrowTypeError(ctx, "expected a string for '%s'", prop);
+        return NULL;
+    }
+    const char *str = JS_ToCString(ctx, val);
+    JS_FreeValue(ctx, val);
+    if (!str) {
+        return NULL;
+    }
+    char *p = js_strdup(ctx, str);
+    JS_FreeCString(ctx, str);
+    return p;
+}
+
+static int tjs__fs_batch_parse_op(JSContext *ctx, JSValue obj, TJSFsBatchOp *op) {
+    if (!JS_IsObject(obj)) {
+        JS_ThrowTypeError(ctx, "expected an operation object");
+        return -1;
+    }
+
+    JSValue js_op = JS_GetPropertyStr(ctx, obj, "op");
+    const char *name = JS_ToCString(ctx, js_op);
+    JS_FreeValue(ctx, js_op);
+    if (!name) {
+        return -1;
+    }
+    op->type = -1;
+    for (int i = 0; i < countof(tjs_fs_batch_ops); i++) {
+        if (strcmp(name, tjs_fs_batch_ops[i]) == 0) {
+            op->type = i;
+            break;
+        }
+    }
+    if (op->type == -1) {
+        JS_ThrowTypeError(ctx, "invalid operation: %s", name);
+        JS_FreeCString(ctx, name);
+        return -1;
+    }
+    JS_FreeCString(ctx, name);
+
+    op->path = tjs__fs_batch_get_path(ctx, obj, "path");
+    if (!op->path) {
+        return -1;
+    }
+
+    switch (op->type) {
+        case TJS_FS_BATCH_RENAME:
+        case TJS_FS_BATCH_COPYFILE:
+        case TJS_FS_BATCH_LINK:
+        case TJS_FS_BATCH_SYMLINK:
+            op->new_path = tjs__fs_batch_get_path(ctx, obj, "newPath");
+            if (!op->new_path) {
+                return -1;
+            }
+            break;
+    }
+
+    op->mode = op->type == TJS_FS_BATCH_MKDIR ? 0777 : 0;
+    JSValue js_mode = JS_GetPropertyStr(ctx, obj, "mode");
+    int ret = !JS_IsUndefined(js_mode) && JS_ToInt32(ctx, &op->mode, js_mode);
+    JS_FreeValue(ctx, js_mode);
+    if (ret) {
+        return -1;
+    }
+    if (op->type == TJS_FS_BATCH_CHMOD && JS_IsUndefined(js_mode)) {
+        JS_ThrowTypeError(ctx, "expected a mode for 'chmod'");
+        return -1;
+    }
+
+    return 0;
+}
+
+static JSValue tjs_fs_batch(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    /* arg 0: operations */
+    if (!JS_IsArray(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected an array of operations");
+    }
+
+    int64_t len;
+    if (JS_GetLength(ctx, argv[0], &len)) {
+        return JS_EXCEPTION;
+    }
+    if (len > UINT32_MAX) {
+        return JS_ThrowRangeError(ctx, "too many operations");
+    }
+
+    /* arg 1: options. Operations run in order unless asked otherwise, later ones may depend on earlier ones. */
+    int32_t concurrency = 1;
+    if (JS_IsObject(argv[1])) {
+        JSValue js_concurrency = JS_GetPropertyStr(ctx, argv[1], "concurrency");
+        int ret = !JS_IsUndefined(js_concurrency) && JS_ToInt32(ctx, &concurrency, js_concurrency);
+        JS_FreeValue(ctx, js_concurrency);
+        if (ret) {
+            return JS_EXCEPTION;
+        }
+        concurrency = concurrency < 1 ? 1 : concurrency;
+        concurrency = concurrency > TJS__FS_BATCH_MAX_GROUPS ? TJS__FS_BATCH_MAX_GROUPS : concurrency;
+    }
+
+    if (len == 0) {
+        JSValue arr = JS_NewArray(ctx);
+        return TJS_NewResolvedPromise(ctx, 1, &arr);
+    }
+
+    TJSFsBatch *b = js_mallocz(ctx, sizeof(*b));
+    if (!b) {
+        return JS_EXCEPTION;
+    }
+
+    b->ctx = ctx;
+    b->nops = len;
+    b->ops = js_mallocz(ctx, sizeof(*b->ops) * len);
+    if (!b->ops) {
+        js_free(ctx, b);
+        return JS_EXCEPTION;
+    }
+
+    for (uint32_t i = 0; i < b->nops; i++) {
+        JSValue obj = JS_GetPropertyUint32(ctx, argv[0], i);
+        int ret = tjs__fs_batch_parse_op(ctx, obj, &b->ops[i]);
+        JS_FreeValue(ctx, obj);
+        if (ret) {
+            tjs__fs_batch_free(ctx, b);
+            return JS_EXCEPTION;
+        }
+    }
+
+    /* Split the operations in contiguous groups, one threadpool job each. */
+    b->ngroups = b->nops < (uint32_t) concurrency ? (int) b->nops : concurrency;
+    for (int i = 0; i < b->ngroups; i++) {
+        TJSFsBatchGroup *g = &b->groups[i];
+        g->batch = b;
+        g->start = (uint64_t) b->nops * i / b->ngroups;
+        g->end = (uint64_t) b->nops * (i + 1) / b->ngroups;
+        g->req.data = g;
+    }
+
+    for (int i = 0; i < b->ngroups; i++) {
+        int r = uv_queue_work(tjs_get_loop(ctx), &b->groups[i].req, tjs__fs_batch_work_cb, tjs__fs_batch_after_work_cb);
+        if (r != 0) {
+            if (i == 0) {
+                tjs__fs_batch_free(ctx, b);
+                return tjs_throw_errno(ctx, r);
+            }
+            /* Groups already queued will settle the promise. */
+            b->status = r;
+            break;
+        }
+        b->pending++;
+    }
+
+    return TJS_InitPromise(ctx, &b->result);
+}
+
+/* Bulk stat */
+
+enum {
+    TJS_STAT_FIELD_DEV = 0,
+    TJS_STAT_FIELD_INO,
+    TJS_STAT_FIELD_MODE,
+    TJS_STAT_FIELD_NLINK,
+    TJS_STAT_FIELD_UID,
+    TJS_STAT_FIELD_GID,
+    TJS_STAT_FIELD_RDEV,
+    TJS_STAT_FIELD_SIZE,
+    TJS_STAT_FIELD_BLOCKS,
+    TJS_STAT_FIELD_ATIM,
+    TJS_STAT_FIELD_MTIM,
+    TJS_STAT_FIELD_CTIM,
+    TJS_STAT_FIELD_BIRTHTIM,
+    TJS_STAT_FIELD_MAX,
+};
+
+static const struct {
+    const char *name;
+    JSTypedArrayEnum type;
+    size_t item_size;
+} tjs_stat_fields[] = {
+    [TJS_STAT_FIELD_DEV] = { "dev", JS_TYPED_ARRAY_BIG_UINT64, sizeof(uint64_t) },
+    [TJS_STAT_FIELD_INO] = { "ino", JS_TYPED_ARRAY_BIG_UINT64, sizeof(uint64_t) },
+    [TJS_STAT_FIELD_MODE] = { "mode", JS_TYPED_ARRAY_UINT32, sizeof(uint32_t) },
+    [TJS_STAT_FIELD_NLINK] = { "nlink", JS_TYPED_ARRAY_UINT32, sizeof(uint32_t) },
+    [TJS_STAT_FIELD_UID] = { "uid", JS_TYPED_ARRAY_UINT32, sizeof(uint32_t) },
+    [TJS_STAT_FIELD_GID] = { "gid", JS_TYPED_ARRAY_UINT32, sizeof(uint32_t) },
+    [TJS_STAT_FIELD_RDEV] = { "rdev", JS_TYPED_ARRAY_BIG_UINT64, sizeof(uint64_t) },
+    [TJS_STAT_FIELD_SIZE] = { "size", JS_TYPED_ARRAY_BIG_UINT64, sizeof(uint64_t) },
+    [TJS_STAT_FIELD_BLOCKS] = { "blocks", JS_TYPED_ARRAY_BIG_UINT64, sizeof(uint64_t) },
+    [TJS_STAT_FIELD_ATIM] = { "atim", JS_TYPED_ARRAY_FLOAT64, sizeof(double) },
+    [TJS_STAT_FIELD_MTIM] = { "mtim", JS_TYPED_ARRAY_FLOAT64, sizeof(double) },
+    [TJS_STAT_FIELD_CTIM] = { "ctim", JS_TYPED_ARRAY_FLOAT64, sizeof(double) },
+    [TJS_STAT_FIELD_BIRTHTIM] = { "birthtim", JS_TYPED_ARRAY_FLOAT64, sizeof(double) },
+};
+
+typedef struct TJSStatMany TJSStatMany;
+
+typedef struct {
+    uv_work_t req;
+    TJSStatMany *sm;
+    uint32_t start;
+    uint32_t end;
+} TJSStatManyGroup;
+
+struct TJSStatMany {
+    JSContext *ctx;
+    char **paths;
+    uint32_t npaths;
+    bool lstat;
+    int32_t *errors;
+    void *columns[TJS_STAT_FIELD_MAX];
+    int ngroups;
+    int pending;
+    int status;
+    TJSPromise result;
+    TJSStatManyGroup groups[TJS__FS_BATCH_MAX_GROUPS];
+};
+
+static void tjs__statmany_set(TJSStatMany *sm, int field, uint32_t i, const uv_stat_t *st) {
+#define SET_UINT64(x)  ((uint64_t *) sm->columns[field])[i] = st->st_##x
+#define SET_UINT32(x)  ((uint32_t *) sm->columns[field])[i] = st->st_##x
+#define SET_TIMESPEC(x) ((double *) sm->columns[field])[i] = st->st_##x.tv_sec * 1e3 + st->st_##x.tv_nsec / 1e6
+    switch (field) {
+        case TJS_STAT_FIELD_DEV:
+            SET_UINT64(dev);
+            break;
+        case TJS_STAT_FIELD_INO:
+            SET_UINT64(ino);
+            break;
+        case TJS_STAT_FIELD_MODE:
+            SET_UINT32(mode);
+            break;
+        case TJS_STAT_FIELD_NLINK:
+            SET_UINT32(nlink);
+            break;
+        case TJS_STAT_FIELD_UID:
+            SET_UINT32(uid);
+            break;
+        case TJS_STAT_FIELD_GID:
+            SET_UINT32(gid);
+            break;
+        case TJS_STAT_FIELD_RDEV:
+            SET_UINT64(rdev);
+            break;
+        case TJS_STAT_FIELD_SIZE:
+            SET_UINT64(size);
+            break;
+        case TJS_STAT_FIELD_BLOCKS:
+            SET_UINT64(blocks);
+            break;
+        case TJS_STAT_FIELD_ATIM:
+            SET_TIMESPEC(atim);
+            break;
+        case TJS_STAT_FIELD_MTIM:
+            SET_TIMESPEC(mtim);
+            break;
+        case TJS_STAT_FIELD_CTIM:
+            SET_TIMESPEC(ctim);
+            break;
+        case TJS_STAT_FIELD_BIRTHTIM:
+            SET_TIMESPEC(birthtim);
+            break;
+    }
+#undef SET_UINT64
+#undef SET_UINT32
+#undef SET_TIMESPEC
+}
+
+/* Runs on the threadpool. Each group writes its own slice of the columns. */
+static void tjs__statmany_work_cb(uv_work_t *req) {
+    TJSStatManyGroup *g = req->data;
+    CHECK_NOT_NULL(g);
+
+    TJSStatMany *sm = g->sm;
+
+    for (uint32_t i = g->start; i < g->end; i++) {
+        uv_fs_t fs_req;
+        int r = sm->lstat ? uv_fs_lstat(NULL, &fs_req, sm->paths[i], NULL) :
+                            uv_fs_stat(NULL, &fs_req, sm->paths[i], NULL);
+        sm->errors[i] = r;
+        if (r == 0) {
+            for (int f = 0; f < TJS_STAT_FIELD_MAX; f++) {
+                if (sm->columns[f]) {
+                    tjs__statmany_set(sm, f, i, &fs_req.statbuf);
+                }
+            }
+        }
+        uv_fs_req_cleanup(&fs_req);
+    }
+}
+
+static void tjs__statmany_free(JSContext *ctx, TJSStatMany *sm) {
+    for (uint32_t i = 0; i < sm->npaths; i++) {
+        js_free(ctx, sm->paths[i]);
+    }
+    js_free(ctx, sm->paths);
+    js_free(ctx, sm->errors);
+    for (int f = 0; f < TJS_STAT_FIELD_MAX; f++) {
+        js_free(ctx, sm->columns[f]);
+    }
+    js_free(ctx, sm);
+}
+
+static void tjs__statmany_buf_free(JSRuntime *rt, void *opaque, void *ptr) {
+    js_free_rt(rt, ptr);
+}
+
+/* Wraps a column in a typed array, handing over its memory. */
+static JSValue tjs__statmany_new_column(JSContext *ctx, void **data, size_t len, JSTypedArrayEnum type, size_t item_size) {
+    JSValue abuf = JS_NewArrayBuffer(ctx, *data, len * item_size, tjs__statmany_buf_free, NULL, false);
+    if (JS_IsException(abuf)) {
+        return abuf;
+    }
+    *data = NULL;
+
+    JSValue args[] = { abuf, JS_NewInt32(ctx, 0), JS_NewInt64(ctx, len) };
+    JSValue arr = JS_NewTypedArray(ctx, countof(args), args, type);
+    JS_FreeValue(ctx, abuf);
+
+    return arr;
+}
+
+static void tjs__statmany_after_work_cb(uv_work_t *req, int status) {
+    TJSStatManyGroup *g = req->data;
+    CHECK_NOT_NULL(g);
+
+    TJSStatMany *sm = g->sm;
+    JSContext *ctx = sm->ctx;
+
+    if (status != 0) {
+        sm->status = status;
+    }
+
+    if (--sm->pending > 0) {
+        return;
+    }
+
+    JSValue arg;
+    bool is_reject = false;
+
+    if (sm->status != 0) {
+        arg = tjs_new_error(ctx, sm->status);
         is_reject = true;
-        dbuf_free(&fr->dbuf);
     } else {
-        arg = TJS_NewUint8Array(ctx, fr->dbuf.buf, fr->dbuf.size);
-        if (JS_IsException(arg)) {
-            dbuf_free(&fr->dbuf);
+        arg = JS_NewObject(ctx);
+        JS_DefinePropertyValueStr(ctx,
+                                  arg,
+                                  "errors",
+                                  tjs__statmany_new_column(ctx,
+                                                           (void **) &sm->errors,
+                                                           sm->npaths,
+                                                           JS_TYPED_ARRAY_INT32,
+                                                           sizeof(int32_t)),
+                                  JS_PROP_C_W_E);
+        for (int f = 0; f < TJS_STAT_FIELD_MAX; f++) {
+            if (sm->columns[f]) {
+                JS_DefinePropertyValueStr(ctx,
+                                          arg,
+                                          tjs_stat_fields[f].name,
+                                          tjs__statmany_new_column(ctx,
+                                                                   &sm->columns[f],
+                                                                   sm->npaths,
+                                                                   tjs_stat_fields[f].type,
+                                                                   tjs_stat_fields[f].item_size),
+                                          JS_PROP_C_W_E);
+            }
         }
     }
 
-    TJS_SettlePromise(ctx, &fr->result, is_reject, 1, &arg);
+    TJS_SettlePromise(ctx, &sm->result, is_reject, 1, &arg);
 
-    js_free(ctx, fr->filename);
-    js_free(ctx, fr);
+    tjs__statmany_free(ctx, sm);
+}
+
+static JSValue tjs_fs_statmany(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    /* arg 0: paths */
+    if (!JS_IsArray(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected an array of paths");
+    }
+
+    int64_t len;
+    if (JS_GetLength(ctx, argv[0], &len)) {
+        return JS_EXCEPTION;
+    }
+    if (len > UINT32_MAX) {
+        return JS_ThrowRangeError(ctx, "too many paths");
+    }
+
+    TJSStatMany *sm = js_mallocz(ctx, sizeof(*sm));
+    if (!sm) {
+        return JS_EXCEPTION;
+    }
+
+    sm->ctx = ctx;
+
+    /* arg 1: options */
+    bool fields[TJS_STAT_FIELD_MAX] = {
+        [TJS_STAT_FIELD_MODE] = true,
+        [TJS_STAT_FIELD_SIZE] = true,
+        [TJS_STAT_FIELD_MTIM] = true,
+    };
+    if (JS_IsObject(argv[1])) {
+        JSValue js_lstat = JS_GetPropertyStr(ctx, argv[1], "lstat");
+        sm->lstat = JS_ToBool(ctx, js_lstat);
+        JS_FreeValue(ctx, js_lstat);
+
+        JSValue js_fields = JS_GetPropertyStr(ctx, argv[1], "fields");
+        if (!JS_IsUndefined(js_fields)) {
+            int64_t nfields;
+            if (!JS_IsArray(ctx, js_fields)) {
+                JS_FreeValue(ctx, js_fields);
+                js_free(ctx, sm);
+                return JS_ThrowTypeError(ctx, "expected an array of field names");
+            }
+            if (JS_GetLength(ctx, js_fields, &nfields)) {
+                JS_FreeValue(ctx, js_fields);
+                js_free(ctx, sm);
+                return JS_EXCEPTION;
+            }
+            memset(fields, 0, sizeof(fields));
+            for (int64_t i = 0; i < nfields; i++) {
+                JSValue v = JS_GetPropertyUint32(ctx, js_fields, i);
+                const char *name = JS_ToCString(ctx, v);
+                JS_FreeValue(ctx, v);
+                if (!name) {
+                    JS_FreeValue(ctx, js_fields);
+                    js_free(ctx, sm);
+                    return JS_EXCEPTION;
+                }
+                int f;
+                for (f = 0; f < TJS_STAT_FIELD_MAX; f++) {
+                    if (strcmp(name, tjs_stat_fields[f].name) == 0) {
+                        fields[f] = true;
+                        break;
+                    }
+                }
+                if (f == TJS_STAT_FIELD_MAX) {
+                    JS_ThrowTypeError(ctx, "invalid field: %s", name);
+                    JS_FreeCString(ctx, name);
+                    JS_FreeValue(ctx, js_fields);
+                    js_free(ctx, sm);
+                    return JS_EXCEPTION;
+                }
+                JS_FreeCString(ctx, name);
+            }
+        }
+        JS_FreeValue(ctx, js_fields);
+    }
+
+    /* Allocate at least one item so empty results still get valid buffers. */
+    size_t nitems = len > 0 ? len : 1;
+    sm->errors = js_mallocz(ctx, nitems * sizeof(int32_t));
+    sm->paths = js_mallocz(ctx, nitems * sizeof(char *));
+    if (!sm->errors || !sm->paths) {
+        tjs__statmany_free(ctx, sm);
+        return JS_EXCEPTION;
+    }
+    for (int f = 0; f < TJS_STAT_FIELD_MAX; f++) {
+        if (fields[f]) {
+            sm->columns[f] = js_mallocz(ctx, nitems * tjs_stat_fields[f].item_size);
+            if (!sm->columns[f]) {
+                tjs__statmany_free(ctx, sm);
+                return JS_EXCEPTION;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < len; i++) {
+        JSValue v = JS_GetPropertyUint32(ctx, argv[0], i);
+        const char *path = JS_ToCString(ctx, v);
+        JS_FreeValue(ctx, v);
+        if (!path) {
+            tjs__statmany_free(ctx, sm);
+            return JS_EXCEPTION;
+        }
+        sm->paths[i] = js_strdup(ctx, path);
+        JS_FreeCString(ctx, path);
+        if (!sm->paths[i]) {
+            tjs__statmany_free(ctx, sm);
+            return JS_EXCEPTION;
+        }
+        sm->npaths++;
+    }
+
+    /* Split the paths in contiguous groups, one threadpool job each. */
+    sm->ngroups = sm->npaths < TJS__FS_BATCH_MAX_GROUPS ? (int) sm->npaths : TJS__FS_BATCH_MAX_GROUPS;
+    if (sm->ngroups == 0) {
+        sm->ngroups = 1;
+    }
+    for (int i = 0; i < sm->ngroups; i++) {
+        TJSStatManyGroup *g = &sm->groups[i];
+        g->sm = sm;
+        g->start = (uint64_t) sm->npaths * i / sm->ngroups;
+        g->end = (uint64_t) sm->npaths * (i + 1) / sm->ngroups;
+        g->req.data = g;
+    }
+
+    for (int i = 0; i < sm->ngroups; i++) {
+        int r = uv_queue_work(tjs_get_loop(ctx), &sm->groups[i].req, tjs__statmany_work_cb, tjs__statmany_after_work_cb);
+        if (r != 0) {
+            if (i == 0) {
+                tjs__statmany_free(ctx, sm);
+                return tjs_throw_errno(ctx, r);
+            }
+            /* Groups already queued will settle the promise. */
+            sm->status = r;
+            break;
+        }
+        sm->pending++;
+    }
+
+    return TJS_InitPromise(ctx, &sm->result);
+}
+
+/* Recursive makeDir / remove */
+
+typedef struct {
+    JSContext *ctx;
+    uv_work_t req;
+    char *path;
+    int mode;
+    int r;
+    TJSPromise result;
+} TJSMkdirpReq;
+
+static bool tjs__is_dir(const char *path) {
+    uv_fs_t req;
+    int r = uv_fs_stat(NULL, &req, path, NULL);
+    bool is_dir = r == 0 && (req.statbuf.st_mode & S_IFMT) == S_IFDIR;
+    uv_fs_req_cleanup(&req);
+    return is_dir;
+}
+
+static int tjs__mkdir(const char *path, int mode) {
+    uv_fs_t req;
+    int r = uv_fs_mkdir(NULL, &req, path, mode, NULL);
+    uv_fs_req_cleanup(&req);
+    return r;
+}
+
+static bool tjs__is_sep(char c) {
+#if defined(_WIN32)
+    return c == '/' || c == '\\';
+#else
+    return c == '/';
+#endif
 }
 
-static JSValue tjs_fs_readfile(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
+/* Creates the directory and any missing parents. The path is modified in place and restored. */
+static int tjs__mkdirp(char *path, int mode) {
+    int r = tjs__mkdir(path, mode);
+    if (r == 0) {
+        return 0;
     }
 
-    TJSReadFileReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
-    }
+    if (r == UV_ENOENT) {
+        size_t len = strlen(path);
+        while (len > 0 && tjs__is_sep(path[len - 1])) {
+            len--;
+        }
+        while (len > 0 && !tjs__is_sep(path[len - 1])) {
+            len--;
+        }
+        size_t end = len;
+        while (end > 1 && tjs__is_sep(path[end - 1])) {
+            end--;
+        }
+        if (end == 0) {
+            return r;
+        }
 
-    fr->ctx = ctx;
-    tjs_dbuf_init(ctx, &fr->dbuf);
-    fr->r = -1;
-    fr->filename = js_strdup(ctx, path);
-    fr->req.data = fr;
-    JS_FreeCString(ctx, path);
+        char c = path[end];
+        path[end] = '\0';
+        int pr = tjs__mkdirp(path, mode);
+        path[end] = c;
+        if (pr != 0) {
+            return pr;
+        }
 
-    int r = uv_queue_work(tjs_get_loop(ctx), &fr->req, tjs__readfile_work_cb, tjs__readfile_after_work_cb);
-    if (r != 0) {
-        js_free(ctx, fr->filename);
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+        r = tjs__mkdir(path, mode);
+        if (r == 0) {
+            return 0;
+        }
     }
 
-    return TJS_InitPromise(ctx, &fr->result);
+    /* Cannot rely on EEXIST since the OS could return other errors like EROFS. */
+    return tjs__is_dir(path) ? 0 : r;
 }
 
-static JSValue tjs_fs_xchown(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
-    if (!JS_IsString(argv[0])) {
-        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
-    }
+static void tjs__mkdirp_work_cb(uv_work_t *req) {
+    TJSMkdirpReq *mr = req->data;
+    CHECK_NOT_NULL(mr);
 
-    int uid;
-    if (JS_IsUndefined(argv[1]) || JS_ToInt32(ctx, &uid, argv[1])) {
-        return JS_ThrowTypeError(ctx, "expected a number for uid parameter");
-    }
+    mr->r = tjs__mkdirp(mr->path, mr->mode);
+}
 
-    int gid;
-    if (JS_IsUndefined(argv[2]) || JS_ToInt32(ctx, &gid, argv[2])) {
-        return JS_ThrowTypeError(ctx, "expected a number for gid parameter");
-    }
+static void tjs__mkdirp_after_work_cb(uv_work_t *req, int status) {
+    TJSMkdirpReq *mr = req->data;
+    CHECK_NOT_NULL(mr);
 
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
-    }
+    JSContext *ctx = mr->ctx;
+    JSValue arg = JS_UNDEFINED;
+    bool is_reject = false;
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
+    if (status != 0 || mr->r != 0) {
+        arg = tjs_new_error(ctx, status != 0 ? status : mr->r);
+        is_reject = true;
     }
 
-    int r = (magic == 1 ? uv_fs_lchown : uv_fs_chown)(tjs_get_loop(ctx), &fr->req, path, uid, gid, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
-    }
+    TJS_SettlePromise(ctx, &mr->result, is_reject, 1, &arg);
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+    js_free(ctx, mr->path);
+    js_free(ctx, mr);
 }
 
-static JSValue tjs_fs_chmod(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    if (!JS_IsString(argv[0])) {
-        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
-    }
-
-    int mode;
-    if (JS_IsUndefined(argv[1]) || JS_ToInt32(ctx, &mode, argv[1])) {
-        return JS_ThrowTypeError(ctx, "expected a number for mode parameter");
+static JSValue tjs_fs_mkdirp(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    int32_t mode = 0777;
+    if (!JS_IsUndefined(argv[1]) && JS_ToInt32(ctx, &mode, argv[1])) {
+        return JS_EXCEPTION;
     }
 
     const char *path = JS_ToCString(ctx, argv[0]);
@@ -1372,196 +3984,347 @@ static JSValue tjs_fs_chmod(JSContext *ctx, JSValue this_val, int argc, JSValue
         return JS_EXCEPTION;
     }
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
+    TJSMkdirpReq *mr = js_mallocz(ctx, sizeof(*mr));
+    if (!mr) {
         JS_FreeCString(ctx, path);
         return JS_EXCEPTION;
     }
 
-    int r = uv_fs_chmod(tjs_get_loop(ctx), &fr->req, path, mode, uv__fs_req_cb);
+    mr->ctx = ctx;
+    mr->path = js_strdup(ctx, path);
+    mr->mode = mode;
+    mr->req.data = mr;
     JS_FreeCString(ctx, path);
+
+    if (!mr->path) {
+        js_free(ctx, mr);
+        return JS_EXCEPTION;
+    }
+
+    int r = uv_queue_work(tjs_get_loop(ctx), &mr->req, tjs__mkdirp_work_cb, tjs__mkdirp_after_work_cb);
     if (r != 0) {
-        js_free(ctx, fr);
+        js_free(ctx, mr->path);
+        js_free(ctx, mr);
         return tjs_throw_errno(ctx, r);
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+    return TJS_InitPromise(ctx, &mr->result);
 }
 
-static JSValue tjs_fs_xutime(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
-    if (!JS_IsString(argv[0])) {
-        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
-    }
+#if !defined(_WIN32)
+#define TJS__RMTREE_WORKERS 4
+
+/* A directory being removed. It's deleted once its own entries are gone and so are all the
+ * subdirectories, which are removed in parallel by whichever worker picks them up. Workers exit as
+ * soon as the work stack is empty, and new ones are queued from the loop as directories are found,
+ * so no threadpool thread is parked waiting for work. */
+typedef struct TJSRmNode {
+    struct TJSRmNode *parent;
+    struct TJSRmNode *next; /* Work stack link. */
+    int fd;
+    _Atomic(int) pending;
+    char name[];
+} TJSRmNode;
 
-    double atime;
-    if (JS_ToFloat64(ctx, &atime, argv[1])) {
-        return JS_EXCEPTION;
-    }
+typedef struct {
+    JSContext *ctx;
+    char *path;
+    uv_mutex_t lock;
+    TJSRmNode *stack;
+    int queued; /* Nodes on the stack. */
+    _Atomic(int) error;
+    /* Only touched on the loop thread. */
+    uv_async_t async;
+    int busy;
+    bool is_busy[TJS__RMTREE_WORKERS];
+    uv_work_t workers[TJS__RMTREE_WORKERS];
+    TJSPromise result;
+} TJSRmTree;
 
-    double mtime;
-    if (JS_ToFloat64(ctx, &mtime, argv[2])) {
-        return JS_EXCEPTION;
-    }
+static void tjs__rmtree_set_error(TJSRmTree *rm, int err) {
+    int expected = 0;
+    atomic_compare_exchange_strong(&rm->error, &expected, err);
+}
 
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
-    }
+/* Called once a directory has no entries left: removes it and walks up the finished parents. */
+static void tjs__rmtree_complete(TJSRmTree *rm, TJSRmNode *node) {
+    while (node) {
+        TJSRmNode *parent = node->parent;
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
-    }
+        if (node->fd != -1) {
+            close(node->fd);
+        }
 
-    /* Date.getTime is in ms, convert to seconds. */
-    int r = (magic == 1 ? uv_fs_lutime
-                        : uv_fs_utime)(tjs_get_loop(ctx), &fr->req, path, atime / 1000, mtime / 1000, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
-    }
+        if (rm->error == 0) {
+            int r = parent ? unlinkat(parent->fd, node->name, AT_REMOVEDIR) : rmdir(rm->path);
+            if (r != 0 && errno != ENOENT) {
+                tjs__rmtree_set_error(rm, -errno);
+            }
+        }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
-}
+        tjs__free(node);
 
-static JSValue tjs_fs_readlink(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    if (!JS_IsString(argv[0])) {
-        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
-    }
+        if (!parent || atomic_fetch_sub(&parent->pending, 1) != 1) {
+            break;
+        }
 
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
+        node = parent;
     }
+}
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
+static void tjs__rmtree_scan(TJSRmTree *rm, TJSRmNode *node) {
+    int dfd = node->parent ? node->parent->fd : AT_FDCWD;
+    const char *name = node->parent ? node->name : rm->path;
+
+    node->fd = openat(dfd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (node->fd == -1) {
+        int err = errno;
+        if (err == ENOTDIR || err == ELOOP) {
+            /* Not a directory (anymore), a plain unlink will do. */
+            if (unlinkat(dfd, name, 0) != 0 && errno != ENOENT) {
+                tjs__rmtree_set_error(rm, -errno);
+            }
+        } else if (err != ENOENT) {
+            tjs__rmtree_set_error(rm, -err);
+        }
+        /* Nothing left to rmdir, detach from the parent. */
+        TJSRmNode *parent = node->parent;
+        tjs__free(node);
+        if (parent && atomic_fetch_sub(&parent->pending, 1) == 1) {
+            tjs__rmtree_complete(rm, parent);
+        }
+        return;
     }
 
-    int r = uv_fs_readlink(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+    int fd2 = dup(node->fd);
+    DIR *dir = fd2 == -1 ? NULL : fdopendir(fd2);
+    if (!dir) {
+        if (fd2 != -1) {
+            close(fd2);
+        }
+        tjs__rmtree_set_error(rm, -errno);
+        if (atomic_fetch_sub(&node->pending, 1) == 1) {
+            tjs__rmtree_complete(rm, node);
+        }
+        return;
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
-}
+    TJSRmNode *children = NULL;
+    TJSRmNode *last = NULL;
+    int nchildren = 0;
+    struct dirent *d;
 
-static JSValue tjs_fs_link(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    if (!JS_IsString(argv[0])) {
-        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
-    }
-    if (!JS_IsString(argv[1])) {
-        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    while (rm->error == 0 && (d = readdir(dir)) != NULL) {
+        if (strcmp(d->d_name, ".") == 0 || strcmp(d->d_name, "..") == 0) {
+            continue;
+        }
+
+        bool is_dir = d->d_type == DT_DIR;
+        if (d->d_type == DT_UNKNOWN) {
+            struct stat st;
+            is_dir = fstatat(node->fd, d->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+        }
+
+        if (!is_dir) {
+            if (unlinkat(node->fd, d->d_name, 0) == 0 || errno == ENOENT) {
+                continue;
+            }
+            if (errno != EISDIR && errno != EPERM) {
+                tjs__rmtree_set_error(rm, -errno);
+                break;
+            }
+            /* Raced with a directory showing up under that name. */
+        }
+
+        size_t len = strlen(d->d_name);
+        TJSRmNode *child = tjs__malloc(sizeof(*child) + len + 1);
+        if (!child) {
+            tjs__rmtree_set_error(rm, UV_ENOMEM);
+            break;
+        }
+        child->parent = node;
+        child->next = NULL;
+        child->fd = -1;
+        atomic_init(&child->pending, 1);
+        memcpy(child->name, d->d_name, len + 1);
+
+        atomic_fetch_add(&node->pending, 1);
+        if (last) {
+            last->next = child;
+        } else {
+            children = child;
+        }
+        last = child;
+        nchildren++;
     }
 
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
+    closedir(dir);
+
+    if (children) {
+        uv_mutex_lock(&rm->lock);
+        last->next = rm->stack;
+        rm->stack = children;
+        rm->queued += nchildren;
+        uv_mutex_unlock(&rm->lock);
+        /* Let the loop put idle workers on them. */
+        uv_async_send(&rm->async);
     }
 
-    const char *path2 = JS_ToCString(ctx, argv[1]);
-    if (!path2) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
+    /* Drop the reference held while scanning. */
+    if (atomic_fetch_sub(&node->pending, 1) == 1) {
+        tjs__rmtree_complete(rm, node);
     }
+}
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
-        JS_FreeCString(ctx, path2);
-        return JS_EXCEPTION;
+static void tjs__rmtree_work_cb(uv_work_t *req) {
+    TJSRmTree *rm = req->data;
+    CHECK_NOT_NULL(rm);
+
+    for (;;) {
+        uv_mutex_lock(&rm->lock);
+        TJSRmNode *node = rm->stack;
+        if (node) {
+            rm->stack = node->next;
+            rm->queued--;
+        }
+        uv_mutex_unlock(&rm->lock);
+
+        if (!node) {
+            /* Directories found later get a new worker. */
+            break;
+        }
+
+        if (rm->error == 0) {
+            tjs__rmtree_scan(rm, node);
+        } else {
+            /* Unwind without touching the file system, so the parents get closed. */
+            TJSRmNode *parent = node->parent;
+            tjs__free(node);
+            if (parent && atomic_fetch_sub(&parent->pending, 1) == 1) {
+                tjs__rmtree_complete(rm, parent);
+            }
+        }
     }
+}
 
-    int r = uv_fs_link(tjs_get_loop(ctx), &fr->req, path, path2, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    JS_FreeCString(ctx, path2);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+static void tjs__rmtree_after_work_cb(uv_work_t *req, int status);
+
+/* Queues a worker per waiting directory, up to TJS__RMTREE_WORKERS in total. Runs on the loop thread. */
+static void tjs__rmtree_spawn(TJSRmTree *rm) {
+    uv_mutex_lock(&rm->lock);
+    int queued = rm->queued;
+    uv_mutex_unlock(&rm->lock);
+
+    for (int i = 0; i < TJS__RMTREE_WORKERS && queued > 0; i++) {
+        if (rm->is_busy[i]) {
+            continue;
+        }
+        queued--;
+        rm->workers[i].data = rm;
+        CHECK_EQ(uv_queue_work(tjs_get_loop(rm->ctx), &rm->workers[i], tjs__rmtree_work_cb, tjs__rmtree_after_work_cb),
+                 0);
+        rm->is_busy[i] = true;
+        rm->busy++;
     }
+}
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+static void uv__rmtree_async_cb(uv_async_t *handle) {
+    TJSRmTree *rm = handle->data;
+    CHECK_NOT_NULL(rm);
+
+    tjs__rmtree_spawn(rm);
 }
 
-static JSValue tjs_fs_symlink(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    if (!JS_IsString(argv[0])) {
-        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
-    }
-    if (!JS_IsString(argv[1])) {
-        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
-    }
+static void uv__rmtree_close_cb(uv_handle_t *handle) {
+    TJSRmTree *rm = handle->data;
+    CHECK_NOT_NULL(rm);
 
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
-    }
+    JSContext *ctx = rm->ctx;
+    JSValue arg = JS_UNDEFINED;
+    bool is_reject = false;
 
-    const char *path2 = JS_ToCString(ctx, argv[1]);
-    if (!path2) {
-        JS_FreeCString(ctx, path);
-        return JS_EXCEPTION;
+    if (rm->error != 0) {
+        arg = tjs_new_error(ctx, rm->error);
+        is_reject = true;
     }
 
-    int flags;
-    if (JS_ToInt32(ctx, &flags, argv[2])) {
-        JS_FreeCString(ctx, path);
-        JS_FreeCString(ctx, path2);
-        return JS_EXCEPTION;
-    }
+    TJS_SettlePromise(ctx, &rm->result, is_reject, 1, &arg);
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
-        JS_FreeCString(ctx, path);
-        JS_FreeCString(ctx, path2);
-        return JS_EXCEPTION;
-    }
+    uv_mutex_destroy(&rm->lock);
+    js_free(ctx, rm->path);
+    js_free(ctx, rm);
+}
 
-    int r = uv_fs_symlink(tjs_get_loop(ctx), &fr->req, path, path2, flags, uv__fs_req_cb);
-    JS_FreeCString(ctx, path);
-    JS_FreeCString(ctx, path2);
-    if (r != 0) {
-        js_free(ctx, fr);
-        return tjs_throw_errno(ctx, r);
+static void tjs__rmtree_after_work_cb(uv_work_t *req, int status) {
+    TJSRmTree *rm = req->data;
+    CHECK_NOT_NULL(rm);
+
+    if (status != 0 && rm->error == 0) {
+        rm->error = status;
     }
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
-}
+    rm->is_busy[req - rm->workers] = false;
+    rm->busy--;
 
-static JSValue tjs_fs_statfs(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    if (!JS_IsString(argv[0])) {
-        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    tjs__rmtree_spawn(rm);
+
+    /* A worker only exits with the stack empty, so with none left everything has been removed. */
+    if (rm->busy == 0) {
+        uv_close((uv_handle_t *) &rm->async, uv__rmtree_close_cb);
     }
+}
 
+static JSValue tjs_fs_rmtree(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
     const char *path = JS_ToCString(ctx, argv[0]);
     if (!path) {
         return JS_EXCEPTION;
     }
 
-    TJSFsReq *fr = js_malloc(ctx, sizeof(*fr));
-    if (!fr) {
+    TJSRmTree *rm = js_mallocz(ctx, sizeof(*rm));
+    if (!rm) {
         JS_FreeCString(ctx, path);
         return JS_EXCEPTION;
     }
 
-    int r = uv_fs_statfs(tjs_get_loop(ctx), &fr->req, path, uv__fs_req_cb);
+    rm->ctx = ctx;
+    rm->path = js_strdup(ctx, path);
     JS_FreeCString(ctx, path);
+
+    TJSRmNode *root = tjs__mallocz(sizeof(*root) + 1);
+    if (!rm->path || !root) {
+        tjs__free(root);
+        js_free(ctx, rm->path);
+        js_free(ctx, rm);
+        return JS_ThrowOutOfMemory(ctx);
+    }
+
+    root->fd = -1;
+    atomic_init(&root->pending, 1);
+    rm->stack = root;
+    rm->queued = 1;
+
+    int r = uv_async_init(tjs_get_loop(ctx), &rm->async, uv__rmtree_async_cb);
     if (r != 0) {
-        js_free(ctx, fr);
+        tjs__free(root);
+        js_free(ctx, rm->path);
+        js_free(ctx, rm);
         return tjs_throw_errno(ctx, r);
     }
+    rm->async.data = rm;
 
-    return tjs_fsreq_init(ctx, fr, JS_UNDEFINED);
+    CHECK_EQ(uv_mutex_init(&rm->lock), 0);
+
+    tjs__rmtree_spawn(rm);
+
+    return TJS_InitPromise(ctx, &rm->result);
 }
+#endif
 
 static const JSCFunctionListEntry tjs_file_proto_funcs[] = {
     TJS_CFUNC_MAGIC_DEF("read", 2, tjs_file_rw, 0),
     TJS_CFUNC_MAGIC_DEF("write", 2, tjs_file_rw, 1),
+    TJS_CFUNC_MAGIC_DEF("readv", 2, tjs_file_rwv, 0),
+    TJS_CFUNC_MAGIC_DEF("writev", 2, tjs_file_rwv, 1),
     TJS_CFUNC_DEF("close", 0, tjs_file_close),
     TJS_CFUNC_DEF("fileno", 0, tjs_file_fileno),
     TJS_CFUNC_DEF("stat", 0, tjs_file_stat),
@@ -1571,10 +4334,22 @@ static const JSCFunctionListEntry tjs_file_proto_funcs[] = {
     TJS_CFUNC_DEF("chmod", 1, tjs_file_chmod),
     TJS_CFUNC_DEF("chown", 2, tjs_file_chown),
     TJS_CFUNC_DEF("utime", 2, tjs_file_utime),
+    TJS_CFUNC_DEF("bufferedWriter", 1, tjs_file_buffered_writer),
     TJS_CGETSET_DEF("path", tjs_file_path_get, NULL),
     JS_PROP_STRING_DEF("[Symbol.toStringTag]", "FileHandle", JS_PROP_C_W_E),
 };
 
+static const JSCFunctionListEntry tjs_bwriter_proto_funcs[] = {
+    TJS_CFUNC_DEF("write", 1, tjs_bwriter_write),
+    TJS_CFUNC_MAGIC_DEF("flush", 0, tjs_bwriter_flush, 0),
+    TJS_CFUNC_MAGIC_DEF("sync", 0, tjs_bwriter_flush, 1),
+    TJS_CFUNC_MAGIC_DEF("close", 0, tjs_bwriter_flush, 2),
+    TJS_CGETSET_DEF("ready", tjs_bwriter_ready_get, NULL),
+    TJS_CGETSET_DEF("bufferedAmount", tjs_bwriter_buffered_amount_get, NULL),
+    TJS_CGETSET_DEF("highWaterMark", tjs_bwriter_hwm_get, NULL),
+    JS_PROP_STRING_DEF("[Symbol.toStringTag]", "BufferedWriter", JS_PROP_C_W_E),
+};
+
 static const JSCFunctionListEntry tjs_dir_proto_funcs[] = {
     TJS_CFUNC_DEF("close", 0, tjs_dir_close),
     JS_CGETSET_DEF("path", tjs_dir_path_get, NULL),
@@ -1619,10 +4394,19 @@ static const JSCFunctionListEntry tjs_fs_funcs[] = {
     TJS_CFUNC_DEF("makeTempDir", 1, tjs_fs_mkdtemp),
     TJS_CFUNC_DEF("mkstemp", 1, tjs_fs_mkstemp),
     TJS_CFUNC_DEF("rmdir", 1, tjs_fs_rmdir),
+    TJS_CFUNC_DEF("mkdirp", 2, tjs_fs_mkdirp),
+#if !defined(_WIN32)
+    TJS_CFUNC_DEF("removeTree", 1, tjs_fs_rmtree),
+#endif
     TJS_CFUNC_DEF("mkdir", 2, tjs_fs_mkdir),
-    TJS_CFUNC_DEF("copyFile", 2, tjs_fs_copyfile),
-    TJS_CFUNC_DEF("readDir", 1, tjs_fs_readdir),
-    TJS_CFUNC_DEF("readFile", 1, tjs_fs_readfile),
+    TJS_CFUNC_DEF("copyFile", 3, tjs_fs_copyfile),
+    TJS_CFUNC_DEF("readDir", 2, tjs_fs_readdir),
+    TJS_CFUNC_MAGIC_DEF("readFile", 1, tjs_fs_readfile, 0),
+    TJS_CFUNC_MAGIC_DEF("readTextFile", 1, tjs_fs_readfile, 1),
+    TJS_CFUNC_MAGIC_DEF("writeFile", 3, tjs_fs_writefile, 0),
+    TJS_CFUNC_MAGIC_DEF("appendFile", 3, tjs_fs_writefile, 1),
+    TJS_CFUNC_DEF("mapFile", 2, tjs_fs_mapfile),
+    TJS_CFUNC_DEF("unmapFile", 1, tjs_fs_unmapfile),
     TJS_CFUNC_MAGIC_DEF("chown", 3, tjs_fs_xchown, 0),
     TJS_CFUNC_MAGIC_DEF("lchown", 3, tjs_fs_xchown, 1),
     TJS_CFUNC_DEF("chmod", 2, tjs_fs_chmod),
@@ -1632,6 +4416,8 @@ static const JSCFunctionListEntry tjs_fs_funcs[] = {
     TJS_CFUNC_DEF("link", 2, tjs_fs_link),
     TJS_CFUNC_DEF("symlink", 3, tjs_fs_symlink),
     TJS_CFUNC_DEF("statFs", 1, tjs_fs_statfs),
+    TJS_CFUNC_DEF("fsBatch", 2, tjs_fs_batch),
+    TJS_CFUNC_DEF("statMany", 2, tjs_fs_statmany),
     /* Internal */
     TJS_CFUNC_DEF("mkdirSync", 2, tjs_fs_mkdir_sync),
     TJS_CFUNC_DEF("statSync", 1, tjs_fs_stat_sync),
@@ -1648,6 +4434,13 @@ void tjs__mod_fs_init(JSContext *ctx, JSValue ns) {
     JS_SetPropertyFunctionList(ctx, proto, tjs_file_proto_funcs, countof(tjs_file_proto_funcs));
     JS_SetClassProto(ctx, tjs_file_class_id, proto);
 
+    /* BufferedWriter object */
+    JS_NewClassID(rt, &tjs_bwriter_class_id);
+    JS_NewClass(rt, tjs_bwriter_class_id, &tjs_bwriter_class);
+    proto = JS_NewObject(ctx);
+    JS_SetPropertyFunctionList(ctx, proto, tjs_bwriter_proto_funcs, countof(tjs_bwriter_proto_funcs));
+    JS_SetClassProto(ctx, tjs_bwriter_class_id, proto);
+
     /* Dir object */
     JS_NewClassID(rt, &tjs_dir_class_id);
     JS_NewClass(rt, tjs_dir_class_id, &tjs_dir_class);
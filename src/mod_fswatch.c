@@ -26,10 +26,64 @@
 #include "private.h"
 #include "utils.h"
 
+#include <string.h>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TJS__INOTIFY_MASK                                                                                              \
+    (IN_ATTRIB | IN_CREATE | IN_MODIFY | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO)
+#endif
+
+/* Batches are flushed after this many debounce windows even if events keep coming. */
+#define TJS__FSWATCH_MAX_WINDOWS 4
+
+typedef struct {
+    char *filename;
+    int events;
+} TJSFsWatchEvent;
+
+typedef struct {
+    int wd;
+    char *path; /* Relative to the root, empty for the root itself. */
+} TJSFsWatchDir;
+
 typedef struct {
     JSContext *ctx;
-    uv_fs_event_t handle;
+    union {
+        uv_handle_t handle;
+        uv_fs_event_t fs_event;
+        uv_poll_t poll;
+    } h;
+    uv_timer_t timer;
+    bool inotify;
+    bool started;
+    int fd;
+    char *path;
+    /* inotify watch descriptors, sorted. */
+    struct {
+        TJSFsWatchDir *items;
+        size_t len;
+        size_t cap;
+    } dirs;
+    /* Coalesced events, in arrival order, and a hash index on the file name. */
+    bool batched;
+    uint64_t debounce;
+    uint64_t batch_start;
+    struct {
+        TJSFsWatchEvent *items;
+        size_t len;
+        size_t cap;
+        uint32_t *index;
+        size_t index_cap;
+    } batch;
     JSValue callback;
+    int pending_close;
     int closed;
     int finalized;
 } TJSFsWatch;
@@ -40,9 +94,51 @@ static TJSFsWatch *tjs_fswatch_get(JSValue obj) {
     return JS_GetOpaque(obj, tjs_fswatch_class_id);
 }
 
+static char *tjs__fswatch_join(const char *a, const char *b, size_t b_len) {
+    size_t a_len = strlen(a);
+    char *s = tjs__malloc(a_len + b_len + 2);
+    if (!s) {
+        return NULL;
+    }
+    if (a_len > 0) {
+        memcpy(s, a, a_len);
+        s[a_len++] = '/';
+    }
+    memcpy(s + a_len, b, b_len);
+    s[a_len + b_len] = '\0';
+    return s;
+}
+
+static void tjs__fswatch_batch_reset(TJSFsWatch *fw) {
+    for (size_t i = 0; i < fw->batch.len; i++) {
+        tjs__free(fw->batch.items[i].filename);
+    }
+    fw->batch.len = 0;
+    if (fw->batch.index) {
+        memset(fw->batch.index, 0, fw->batch.index_cap * sizeof(*fw->batch.index));
+    }
+}
+
+static void tjs__fswatch_free_resources(TJSFsWatch *fw) {
+    tjs__fswatch_batch_reset(fw);
+    tjs__free(fw->batch.items);
+    tjs__free(fw->batch.index);
+    for (size_t i = 0; i < fw->dirs.len; i++) {
+        tjs__free(fw->dirs.items[i].path);
+    }
+    tjs__free(fw->dirs.items);
+    tjs__free(fw->path);
+#if defined(__linux__)
+    if (fw->inotify && fw->fd != -1) {
+        close(fw->fd);
+    }
+#endif
+}
+
 static void uv__fsevent_close_cb(uv_handle_t *handle) {
     TJSFsWatch *fw = handle->data;
-    if (fw) {
+    if (fw && --fw->pending_close == 0) {
+        tjs__fswatch_free_resources(fw);
         fw->closed = 1;
         if (fw->finalized) {
             tjs__free(fw);
@@ -51,8 +147,12 @@ static void uv__fsevent_close_cb(uv_handle_t *handle) {
 }
 
 static void maybe_close(TJSFsWatch *fw) {
-    if (!uv_is_closing((uv_handle_t *) &fw->handle)) {
-        uv_close((uv_handle_t *) &fw->handle, uv__fsevent_close_cb);
+    if (!uv_is_closing((uv_handle_t *) &fw->timer)) {
+        fw->pending_close = fw->started ? 2 : 1;
+        if (fw->started) {
+            uv_close(&fw->h.handle, uv__fsevent_close_cb);
+        }
+        uv_close((uv_handle_t *) &fw->timer, uv__fsevent_close_cb);
     }
 }
 
@@ -97,12 +197,16 @@ static JSValue tjs_fswatch_path_get(JSContext *ctx, JSValue this_val) {
         return JS_UNDEFINED;
     }
 
+    if (fw->inotify) {
+        return JS_NewString(ctx, fw->path);
+    }
+
     char buf[1024];
     size_t size = sizeof(buf);
     char *dbuf = buf;
     int r;
 
-    r = uv_fs_event_getpath(&fw->handle, dbuf, &size);
+    r = uv_fs_event_getpath(&fw->h.fs_event, dbuf, &size);
     if (r != 0) {
         if (r != UV_ENOBUFS) {
             return tjs_throw_errno(ctx, r);
@@ -111,7 +215,7 @@ static JSValue tjs_fswatch_path_get(JSContext *ctx, JSValue this_val) {
         if (!dbuf) {
             return JS_EXCEPTION;
         }
-        uv_fs_event_getpath(&fw->handle, dbuf, &size);
+        uv_fs_event_getpath(&fw->h.fs_event, dbuf, &size);
         if (r != 0) {
             js_free(ctx, dbuf);
             return tjs_throw_errno(ctx, r);
@@ -127,51 +231,437 @@ static JSValue tjs_fswatch_path_get(JSContext *ctx, JSValue this_val) {
     return ret;
 }
 
-static void uv__fs_event_cb(uv_fs_event_t *handle, const char *filename, int events, int status) {
+static JSValue tjs__fswatch_event_name(JSContext *ctx, int events) {
+    // libuv could set both, if we get rename, ignore change.
+    if (events & UV_RENAME) {
+        return JS_NewString(ctx, "rename");
+    }
+    return JS_NewString(ctx, "change");
+}
+
+static void uv__fswatch_timer_cb(uv_timer_t *handle) {
     TJSFsWatch *fw = handle->data;
     CHECK_NOT_NULL(fw);
     JSContext *ctx = fw->ctx;
 
+    JSValue arr = JS_NewArray(ctx);
+    for (uint32_t i = 0; i < fw->batch.len; i++) {
+        TJSFsWatchEvent *ev = &fw->batch.items[i];
+        JSValue item = JS_NewObject(ctx);
+        JS_DefinePropertyValueStr(ctx, item, "filename", JS_NewString(ctx, ev->filename), JS_PROP_C_W_E);
+        JS_DefinePropertyValueStr(ctx, item, "event", tjs__fswatch_event_name(ctx, ev->events), JS_PROP_C_W_E);
+        JS_DefinePropertyValueUint32(ctx, arr, i, item, JS_PROP_C_W_E);
+    }
+
+    /* The handler may close the watcher, so the batch is reset before calling it. */
+    tjs__fswatch_batch_reset(fw);
+
+    tjs_call_handler(ctx, fw->callback, 1, &arr);
+
+    JS_FreeValue(ctx, arr);
+}
+
+static uint32_t tjs__fswatch_hash(const char *s) {
+    uint32_t h = 2166136261u;
+    for (; *s; s++) {
+        h = (h ^ (uint8_t) *s) * 16777619u;
+    }
+    return h;
+}
+
+static int tjs__fswatch_index_grow(TJSFsWatch *fw) {
+    size_t cap = fw->batch.index_cap ? fw->batch.index_cap * 2 : 64;
+    uint32_t *index = tjs__calloc(cap, sizeof(*index));
+    if (!index) {
+        return -1;
+    }
+    for (size_t i = 0; i < fw->batch.len; i++) {
+        size_t slot = tjs__fswatch_hash(fw->batch.items[i].filename) & (cap - 1);
+        while (index[slot] != 0) {
+            slot = (slot + 1) & (cap - 1);
+        }
+        index[slot] = i + 1;
+    }
+    tjs__free(fw->batch.index);
+    fw->batch.index = index;
+    fw->batch.index_cap = cap;
+    return 0;
+}
+
+/* Adds the event to the pending batch, merging it with earlier events on the same file. */
+static void tjs__fswatch_batch_add(TJSFsWatch *fw, const char *filename, int events) {
+    if ((fw->batch.len + 1) * 2 > fw->batch.index_cap && tjs__fswatch_index_grow(fw) != 0) {
+        return;
+    }
+
+    size_t mask = fw->batch.index_cap - 1;
+    size_t slot = tjs__fswatch_hash(filename) & mask;
+    while (fw->batch.index[slot] != 0) {
+        TJSFsWatchEvent *ev = &fw->batch.items[fw->batch.index[slot] - 1];
+        if (strcmp(ev->filename, filename) == 0) {
+            ev->events |= events;
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (fw->batch.len == fw->batch.cap) {
+        size_t cap = fw->batch.cap ? fw->batch.cap * 2 : 32;
+        TJSFsWatchEvent *items = tjs__realloc(fw->batch.items, cap * sizeof(*items));
+        if (!items) {
+            return;
+        }
+        fw->batch.items = items;
+        fw->batch.cap = cap;
+    }
+
+    char *s = tjs__fswatch_join("", filename, strlen(filename));
+    if (!s) {
+        return;
+    }
+
+    fw->batch.items[fw->batch.len].filename = s;
+    fw->batch.items[fw->batch.len].events = events;
+    fw->batch.index[slot] = ++fw->batch.len;
+}
+
+static void tjs__fswatch_emit(TJSFsWatch *fw, const char *filename, int events) {
+    JSContext *ctx = fw->ctx;
+
+    if (!fw->batched) {
+        JSValue args[2] = {
+            JS_NewString(ctx, filename),
+            tjs__fswatch_event_name(ctx, events),
+        };
+
+        tjs_call_handler(ctx, fw->callback, countof(args), args);
+
+        JS_FreeValue(ctx, args[0]);
+        JS_FreeValue(ctx, args[1]);
+        return;
+    }
+
+    uint64_t now = uv_now(tjs_get_loop(ctx));
+
+    if (fw->batch.len == 0) {
+        fw->batch_start = now;
+    }
+
+    tjs__fswatch_batch_add(fw, filename, events);
+
+    /* Wait for a quiet window, but don't hold the batch back forever. */
+    bool overdue = now - fw->batch_start >= fw->debounce * TJS__FSWATCH_MAX_WINDOWS;
+    if (fw->batch.len > 0 && (!overdue || !uv_is_active((uv_handle_t *) &fw->timer))) {
+        uv_timer_start(&fw->timer, uv__fswatch_timer_cb, fw->debounce, 0);
+    }
+}
+
+static void uv__fs_event_cb(uv_fs_event_t *handle, const char *filename, int events, int status) {
+    TJSFsWatch *fw = handle->data;
+    CHECK_NOT_NULL(fw);
+
     // TODO: handle error case?
     if (status != 0) {
         return;
     }
 
-    // libuv could set both, if we get rename, ignore change.
+    // This shouldn't happen.
+    CHECK((events & (UV_RENAME | UV_CHANGE)) && "invalid fs events");
 
-    JSValue event;
-    if (events & UV_RENAME) {
-        event = JS_NewString(ctx, "rename");
-    } else if (events & UV_CHANGE) {
-        event = JS_NewString(ctx, "change");
-    } else {
-        // This shouldn't happen.
-        CHECK(0 && "invalid fs events");
+    tjs__fswatch_emit(fw, filename ? filename : "", events);
+}
+
+#if defined(__linux__)
+static ssize_t tjs__inotify_find(TJSFsWatch *fw, int wd) {
+    size_t lo = 0;
+    size_t hi = fw->dirs.len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (fw->dirs.items[mid].wd < wd) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int tjs__inotify_set(TJSFsWatch *fw, int wd, char *path) {
+    size_t i = tjs__inotify_find(fw, wd);
+
+    if (i < fw->dirs.len && fw->dirs.items[i].wd == wd) {
+        /* Same directory reached through a new path. */
+        tjs__free(fw->dirs.items[i].path);
+        fw->dirs.items[i].path = path;
+        return 0;
+    }
+
+    if (fw->dirs.len == fw->dirs.cap) {
+        size_t cap = fw->dirs.cap ? fw->dirs.cap * 2 : 64;
+        TJSFsWatchDir *items = tjs__realloc(fw->dirs.items, cap * sizeof(*items));
+        if (!items) {
+            return UV_ENOMEM;
+        }
+        fw->dirs.items = items;
+        fw->dirs.cap = cap;
+    }
+
+    memmove(&fw->dirs.items[i + 1], &fw->dirs.items[i], (fw->dirs.len - i) * sizeof(*fw->dirs.items));
+    fw->dirs.items[i].wd = wd;
+    fw->dirs.items[i].path = path;
+    fw->dirs.len++;
+
+    return 0;
+}
+
+static void tjs__inotify_remove_at(TJSFsWatch *fw, size_t i) {
+    tjs__free(fw->dirs.items[i].path);
+    memmove(&fw->dirs.items[i], &fw->dirs.items[i + 1], (fw->dirs.len - i - 1) * sizeof(*fw->dirs.items));
+    fw->dirs.len--;
+}
+
+/* Drops the watches for a directory that was moved out of its place, and everything below it. */
+static void tjs__inotify_remove_tree(TJSFsWatch *fw, const char *rel) {
+    size_t rel_len = strlen(rel);
+
+    for (size_t i = 0; i < fw->dirs.len;) {
+        const char *p = fw->dirs.items[i].path;
+        if (strncmp(p, rel, rel_len) == 0 && (p[rel_len] == '\0' || p[rel_len] == '/')) {
+            inotify_rm_watch(fw->fd, fw->dirs.items[i].wd);
+            tjs__inotify_remove_at(fw, i);
+        } else {
+            i++;
+        }
+    }
+}
+
+/* Watches the directory at rel and everything below it. New directories found after the
+ * watcher started report their contents, since those may have been created before the
+ * watch was in place. */
+static int tjs__inotify_add_tree(TJSFsWatch *fw, const char *rel, bool emit) {
+    char *full = tjs__fswatch_join(fw->path, rel, strlen(rel));
+    if (!full) {
+        return UV_ENOMEM;
+    }
+
+    uint32_t mask = TJS__INOTIFY_MASK | IN_ONLYDIR | IN_EXCL_UNLINK;
+    if (rel[0] != '\0') {
+        mask |= IN_DONT_FOLLOW;
+    }
+
+    int wd = inotify_add_watch(fw->fd, full, mask);
+    if (wd < 0) {
+        int err = -errno;
+        tjs__free(full);
+        return err;
+    }
+
+    char *path = tjs__fswatch_join("", rel, strlen(rel));
+    if (!path || tjs__inotify_set(fw, wd, path) != 0) {
+        tjs__free(path);
+        tjs__free(full);
+        return UV_ENOMEM;
+    }
+
+    DIR *dir = opendir(full);
+    if (!dir) {
+        tjs__free(full);
+        return 0;
+    }
+
+    int r = 0;
+    struct dirent *d;
+    while ((d = readdir(dir)) != NULL) {
+        if (strcmp(d->d_name, ".") == 0 || strcmp(d->d_name, "..") == 0) {
+            continue;
+        }
+
+        bool is_dir = d->d_type == DT_DIR;
+        if (d->d_type == DT_UNKNOWN) {
+            struct stat st;
+            is_dir = fstatat(dirfd(dir), d->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+        }
+
+        if (!emit && !is_dir) {
+            continue;
+        }
+
+        char *child = tjs__fswatch_join(rel, d->d_name, strlen(d->d_name));
+        if (!child) {
+            r = UV_ENOMEM;
+            break;
+        }
+
+        if (emit) {
+            tjs__fswatch_emit(fw, child, UV_RENAME);
+        }
+
+        if (is_dir) {
+            r = tjs__inotify_add_tree(fw, child, emit);
+            /* Directories can vanish or be unreadable while scanning, only running out
+             * of watches or memory is fatal. */
+            if (r != UV_ENOSPC && r != UV_ENOMEM) {
+                r = 0;
+            }
+        }
+
+        tjs__free(child);
+
+        if (r != 0) {
+            break;
+        }
+    }
+
+    closedir(dir);
+    tjs__free(full);
+
+    return r;
+}
+
+static void uv__inotify_poll_cb(uv_poll_t *handle, int status, int events) {
+    TJSFsWatch *fw = handle->data;
+    CHECK_NOT_NULL(fw);
+
+    if (status != 0) {
         return;
     }
 
-    JSValue args[2] = {
-        JS_NewString(ctx, filename),
-        event,
-    };
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    for (;;) {
+        ssize_t n = read(fw->fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+
+        const struct inotify_event *ev;
+        for (char *p = buf; p < buf + n; p += sizeof(*ev) + ev->len) {
+            ev = (const struct inotify_event *) p;
+
+            /* The handler may close the watcher, stop delivering events if it did. */
+            if (uv_is_closing(&fw->h.handle)) {
+                return;
+            }
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                /* Events were dropped, the empty name tells the handler to rescan. */
+                tjs__fswatch_emit(fw, "", UV_RENAME);
+                continue;
+            }
+
+            size_t i = tjs__inotify_find(fw, ev->wd);
+            if (i == fw->dirs.len || fw->dirs.items[i].wd != ev->wd) {
+                continue;
+            }
+
+            if (ev->mask & IN_IGNORED) {
+                tjs__inotify_remove_at(fw, i);
+                continue;
+            }
+
+            const char *dir = fw->dirs.items[i].path;
+
+            if (ev->len == 0) {
+                /* Self events on subdirectories are already reported by their parent. */
+                if (dir[0] == '\0') {
+                    tjs__fswatch_emit(fw, "", UV_RENAME);
+                }
+                continue;
+            }
+
+            char *rel = tjs__fswatch_join(dir, ev->name, strlen(ev->name));
+            if (!rel) {
+                continue;
+            }
+
+            int uv_events = 0;
+            if (ev->mask & (IN_ATTRIB | IN_MODIFY)) {
+                uv_events |= UV_CHANGE;
+            }
+            if (ev->mask & ~(IN_ATTRIB | IN_MODIFY)) {
+                uv_events |= UV_RENAME;
+            }
+
+            tjs__fswatch_emit(fw, rel, uv_events);
+
+            if (ev->mask & IN_ISDIR) {
+                if (ev->mask & IN_MOVED_FROM) {
+                    tjs__inotify_remove_tree(fw, rel);
+                } else if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    tjs__inotify_add_tree(fw, rel, true);
+                }
+            }
+
+            tjs__free(rel);
+        }
+    }
+}
+
+static int tjs__inotify_start(TJSFsWatch *fw) {
+    fw->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fw->fd < 0) {
+        fw->fd = -1;
+        return -errno;
+    }
+
+    int r = tjs__inotify_add_tree(fw, "", false);
+    if (r != 0) {
+        return r;
+    }
+
+    r = uv_poll_init(tjs_get_loop(fw->ctx), &fw->h.poll, fw->fd);
+    if (r != 0) {
+        return r;
+    }
 
-    tjs_call_handler(ctx, fw->callback, countof(args), args);
+    fw->started = true;
 
-    JS_FreeValue(ctx, args[0]);
-    JS_FreeValue(ctx, args[1]);
+    return uv_poll_start(&fw->h.poll, UV_READABLE, uv__inotify_poll_cb);
 }
+#endif
 
 static JSValue tjs_fs_watch(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    const char *path = JS_ToCString(ctx, argv[0]);
-    if (!path) {
-        return JS_EXCEPTION;
+    /* Watchers have always been recursive where libuv supports it, keep that the default there. */
+#if defined(__linux__)
+    bool recursive = false;
+#else
+    bool recursive = true;
+#endif
+    bool batched = false;
+    int64_t debounce = 0;
+
+    JSValue opts = argv[2];
+    if (JS_IsObject(opts)) {
+        JSValue js_recursive = JS_GetPropertyStr(ctx, opts, "recursive");
+        if (!JS_IsUndefined(js_recursive)) {
+            recursive = JS_ToBool(ctx, js_recursive);
+        }
+        JS_FreeValue(ctx, js_recursive);
+
+        JSValue js_debounce = JS_GetPropertyStr(ctx, opts, "debounce");
+        batched = !JS_IsUndefined(js_debounce);
+        int ret = batched && JS_ToInt64(ctx, &debounce, js_debounce);
+        JS_FreeValue(ctx, js_debounce);
+        if (ret) {
+            return JS_EXCEPTION;
+        }
+        if (debounce < 0) {
+            return JS_ThrowRangeError(ctx, "debounce must not be negative");
+        }
     }
 
     if (!JS_IsFunction(ctx, argv[1])) {
-        JS_FreeCString(ctx, path);
         return JS_ThrowTypeError(ctx, "no callback function provided");
     }
 
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
     JSValue obj = JS_NewObjectClass(ctx, tjs_fswatch_class_id);
     if (JS_IsException(obj)) {
         JS_FreeCString(ctx, path);
@@ -185,29 +675,50 @@ static JSValue tjs_fs_watch(JSContext *ctx, JSValue this_val, int argc, JSValue
         return JS_ThrowOutOfMemory(ctx);
     }
 
-    int r = uv_fs_event_init(tjs_get_loop(ctx), &fw->handle);
-    if (r != 0) {
-        JS_FreeCString(ctx, path);
-        JS_FreeValue(ctx, obj);
-        tjs__free(fw);
-        return JS_ThrowInternalError(ctx, "couldn't initialize handle");
+    fw->ctx = ctx;
+    fw->fd = -1;
+    fw->batched = batched;
+    fw->debounce = debounce;
+
+    int r = 0;
+
+#if defined(__linux__)
+    /* inotify isn't recursive, so the tree is watched one directory at a time. */
+    struct stat st;
+    fw->inotify = recursive && stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+    if (fw->inotify) {
+        size_t len = strlen(path);
+        while (len > 1 && path[len - 1] == '/') {
+            len--;
+        }
+        fw->path = tjs__fswatch_join("", path, len);
+        r = fw->path ? tjs__inotify_start(fw) : UV_ENOMEM;
+    } else
+#endif
+    {
+        r = uv_fs_event_init(tjs_get_loop(ctx), &fw->h.fs_event);
+        if (r == 0) {
+            fw->started = true;
+            r = uv_fs_event_start(&fw->h.fs_event, uv__fs_event_cb, path, recursive ? UV_FS_EVENT_RECURSIVE : 0);
+        }
     }
 
-    r = uv_fs_event_start(&fw->handle, uv__fs_event_cb, path, UV_FS_EVENT_RECURSIVE);
+    JS_FreeCString(ctx, path);
+
+    fw->h.handle.data = fw;
+
+    CHECK_EQ(uv_timer_init(tjs_get_loop(ctx), &fw->timer), 0);
+    fw->timer.data = fw;
+
+    fw->callback = JS_DupValue(ctx, argv[1]);
+    JS_SetOpaque(obj, fw);
+
     if (r != 0) {
-        JS_FreeCString(ctx, path);
+        /* Whatever got initialized is torn down by the finalizer. */
         JS_FreeValue(ctx, obj);
-        tjs__free(fw);
         return tjs_throw_errno(ctx, r);
     }
 
-    JS_FreeCString(ctx, path);
-
-    fw->ctx = ctx;
-    fw->handle.data = fw;
-    fw->callback = JS_DupValue(ctx, argv[1]);
-
-    JS_SetOpaque(obj, fw);
     return obj;
 }
 
@@ -218,7 +729,7 @@ static const JSCFunctionListEntry tjs_fswatch_proto_funcs[] = {
 };
 
 static const JSCFunctionListEntry tjs_fswatch_funcs[] = {
-    TJS_CFUNC_DEF("watch", 2, tjs_fs_watch),
+    TJS_CFUNC_DEF("watch", 3, tjs_fs_watch),
 };
 
 void tjs__mod_fswatch_init(JSContext *ctx, JSValue ns) {
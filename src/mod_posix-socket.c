@@ -1,3 +1,8 @@
+/* For recvmmsg and sendmmsg. */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "private.h"
 
 #include <net/if.h>
@@ -10,6 +15,18 @@
 #endif
 
 #define TJS_SOCK_CLASS_NAME "PosixSocket"
+// like libuv, which reads a stream at most 32 times per wakeup
+#define TJS_SOCK_BATCH_MAX_READS 32
+
+#if defined(__linux__) || defined(__FreeBSD__)
+#define TJS_HAVE_MMSG
+typedef struct mmsghdr tjs_mmsghdr_t;
+#else
+typedef struct {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+} tjs_mmsghdr_t;
+#endif
 
 static JSClassID tjs_sock_classid;
 
@@ -22,6 +39,15 @@ typedef struct {
     JSContext *jsctx;
     bool in_cb;
     uv_poll_t poll;
+    // set by pollBatch, the buffers are refilled on every wakeup until the socket is drained
+    struct {
+        JSValue buffers;
+        unsigned count;
+        int flags;
+        tjs_mmsghdr_t *msgs;
+        struct iovec *iovs;
+        struct sockaddr_storage *addrs;
+    } batch;
 } tjs_sock_t;
 
 #define THROW_STRERROR() JS_ThrowInternalError(ctx, "%s (%d)", strerror(errno), errno)
@@ -45,6 +71,8 @@ static JSValue tjs_sock_new_from_fd(JSContext *ctx, int fd) {
     tjs_sock->jsctx = ctx;
     tjs_sock->in_cb = false;
     memset(&tjs_sock->poll, 0, sizeof(uv_poll_t));
+    memset(&tjs_sock->batch, 0, sizeof(tjs_sock->batch));
+    tjs_sock->batch.buffers = JS_UNDEFINED;
     JS_SetOpaque(obj, tjs_sock);
 
     return obj;
@@ -82,9 +110,19 @@ static void tjs_uv_socket_mark(JSRuntime *rt, JSValue val, JS_MarkFunc *mark_fun
             JS_MarkValue(rt, u->callback, mark_func);
         }
         JS_MarkValue(rt, u->this, mark_func);
+        JS_MarkValue(rt, u->batch.buffers, mark_func);
     }
 }
 
+static void tjs_sock_batch_free(JSContext *ctx, tjs_sock_t *s) {
+    JS_FreeValue(ctx, s->batch.buffers);
+    js_free(ctx, s->batch.msgs);
+    js_free(ctx, s->batch.iovs);
+    js_free(ctx, s->batch.addrs);
+    memset(&s->batch, 0, sizeof(s->batch));
+    s->batch.buffers = JS_UNDEFINED;
+}
+
 static void close_sock(tjs_sock_t *s) {
     if (!s->closed) {
         if (s->poll_init) {
@@ -100,6 +138,7 @@ static void close_sock(tjs_sock_t *s) {
             }
             s->poll_init = false;
         }
+        tjs_sock_batch_free(s->jsctx, s);
         close(s->sock);
         s->closed = true;
     }
@@ -496,6 +535,224 @@ static JSValue tjs_sock_sendmsg(JSContext *ctx, JSValue this_val, int argc, JSVa
     return JS_NewUint32(ctx, ret);
 }
 
+// recvmmsg/sendmmsg where available, otherwise one recvmsg/sendmsg per message.
+// Like the real ones, -1 is only returned if no message was transferred.
+static int tjs_sock_recvmmsg(int fd, tjs_mmsghdr_t *msgs, unsigned n, int flags) {
+    int ret;
+#ifdef TJS_HAVE_MMSG
+    // without it a blocking socket would wait for all n messages
+    flags |= MSG_WAITFORONE;
+    do {
+        ret = recvmmsg(fd, msgs, n, flags, NULL);
+    } while (ret < 0 && errno == EINTR);
+#else
+    for (ret = 0; ret < (int) n; ret++) {
+        ssize_t r;
+        do {
+            r = recvmsg(fd, &msgs[ret].msg_hdr, ret == 0 ? flags : flags | MSG_DONTWAIT);
+        } while (r < 0 && errno == EINTR);
+        if (r < 0) {
+            return ret == 0 ? -1 : ret;
+        }
+        msgs[ret].msg_len = r;
+    }
+#endif
+    return ret;
+}
+
+static int tjs_sock_sendmmsg(int fd, tjs_mmsghdr_t *msgs, unsigned n, int flags) {
+    int ret;
+#ifdef TJS_HAVE_MMSG
+    do {
+        ret = sendmmsg(fd, msgs, n, flags);
+    } while (ret < 0 && errno == EINTR);
+#else
+    for (ret = 0; ret < (int) n; ret++) {
+        ssize_t r;
+        do {
+            r = sendmsg(fd, &msgs[ret].msg_hdr, flags);
+        } while (r < 0 && errno == EINTR);
+        if (r < 0) {
+            return ret == 0 ? -1 : ret;
+        }
+        msgs[ret].msg_len = r;
+    }
+#endif
+    return ret;
+}
+
+// points one message header at each Uint8Array in the array, with room for the sender address
+static int tjs_sock_mmsg_setup(JSContext *ctx,
+                               JSValue buffers,
+                               unsigned n,
+                               tjs_mmsghdr_t *msgs,
+                               struct iovec *iovs,
+                               struct sockaddr_storage *addrs) {
+    memset(msgs, 0, sizeof(*msgs) * n);
+    for (unsigned i = 0; i < n; i++) {
+        size_t sz;
+        JSValue v = JS_GetPropertyUint32(ctx, buffers, i);
+        uint8_t *buf = JS_GetUint8Array(ctx, &sz, v);
+        JS_FreeValue(ctx, v);
+        if (buf == NULL) {
+            return -1;
+        }
+        iovs[i].iov_base = buf;
+        iovs[i].iov_len = sz;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    }
+    return 0;
+}
+
+// [{size, addr, truncated}, ...] for the first n messages, the data is in the caller's buffers
+static JSValue tjs_sock_mmsg_results(JSContext *ctx, tjs_mmsghdr_t *msgs, int n) {
+    JSValue arr = JS_NewArray(ctx);
+    for (int i = 0; i < n; i++) {
+        struct msghdr *hdr = &msgs[i].msg_hdr;
+        uint8_t *addr = js_malloc(ctx, hdr->msg_namelen);
+        memcpy(addr, hdr->msg_name, hdr->msg_namelen);
+        JSValue item = JS_NewObject(ctx);
+        JS_SetPropertyStr(ctx, item, "size", JS_NewUint32(ctx, msgs[i].msg_len));
+        JS_SetPropertyStr(ctx, item, "addr", TJS_NewUint8Array(ctx, addr, hdr->msg_namelen));
+        JS_SetPropertyStr(ctx, item, "truncated", JS_NewBool(ctx, hdr->msg_flags & MSG_TRUNC));
+        JS_SetPropertyUint32(ctx, arr, i, item);
+    }
+    return arr;
+}
+
+static JSValue tjs_sock_recvmmsg_js(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    // this: PosixSocket
+    // args: Uint8Array[] buffers, int flags
+    tjs_sock_t *s = JS_GetOpaque(this_val, tjs_sock_classid);
+    TJS_CHECK_ARG_RET(ctx, s, -1, TJS_SOCK_CLASS_NAME);
+    if (s->closed) {
+        return JS_ThrowInternalError(ctx, "Socket closed");
+    }
+    int64_t n;
+    TJS_CHECK_ARG_RET(ctx, JS_IsArray(ctx, argv[0]) && !JS_GetLength(ctx, argv[0], &n), 0, "array of Uint8Array");
+    TJS_CHECK_ARG_RET(ctx, n > 0 && n <= UINT16_MAX, 0, "non-empty array of Uint8Array");
+    int flags = 0;
+    if (!JS_IsUndefined(argv[1])) {
+        TJS_CHECK_ARG_RET(ctx, !JS_ToUint32(ctx, (unsigned *) &flags, argv[1]), 1, "positive integer");
+    }
+
+    tjs_mmsghdr_t *msgs = js_malloc(ctx, sizeof(*msgs) * n);
+    struct iovec *iovs = js_malloc(ctx, sizeof(*iovs) * n);
+    struct sockaddr_storage *addrs = js_malloc(ctx, sizeof(*addrs) * n);
+    JSValue ret = JS_EXCEPTION;
+    if (!msgs || !iovs || !addrs || tjs_sock_mmsg_setup(ctx, argv[0], n, msgs, iovs, addrs) != 0) {
+        goto end;
+    }
+
+    int r = tjs_sock_recvmmsg(s->sock, msgs, n, flags);
+    if (r < 0) {
+        // nothing to read on a non-blocking socket is not an error here
+        ret = (errno == EAGAIN || errno == EWOULDBLOCK) ? JS_NewArray(ctx) : THROW_STRERROR();
+    } else {
+        ret = tjs_sock_mmsg_results(ctx, msgs, r);
+    }
+
+end:
+    js_free(ctx, msgs);
+    js_free(ctx, iovs);
+    js_free(ctx, addrs);
+    return ret;
+}
+
+static JSValue tjs_sock_sendmmsg_js(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    // this: PosixSocket
+    // args: {data: Uint8Array|Uint8Array[], addr?: Uint8Array, control?: Uint8Array}[] messages, int flags
+    tjs_sock_t *s = JS_GetOpaque(this_val, tjs_sock_classid);
+    TJS_CHECK_ARG_RET(ctx, s, -1, TJS_SOCK_CLASS_NAME);
+    if (s->closed) {
+        return JS_ThrowInternalError(ctx, "Socket closed");
+    }
+    int64_t n;
+    TJS_CHECK_ARG_RET(ctx, JS_IsArray(ctx, argv[0]) && !JS_GetLength(ctx, argv[0], &n), 0, "array of messages");
+    TJS_CHECK_ARG_RET(ctx, n > 0 && n <= UINT16_MAX, 0, "non-empty array of messages");
+    int flags = 0;
+    if (!JS_IsUndefined(argv[1])) {
+        TJS_CHECK_ARG_RET(ctx, !JS_ToUint32(ctx, (unsigned *) &flags, argv[1]), 1, "positive integer");
+    }
+
+    tjs_mmsghdr_t *msgs = js_mallocz(ctx, sizeof(*msgs) * n);
+    // every message keeps its own iovec array, they are freed with msgs
+    struct iovec **iovs = js_mallocz(ctx, sizeof(*iovs) * n);
+    JSValue ret = JS_EXCEPTION;
+    if (!msgs || !iovs) {
+        goto end;
+    }
+
+    for (int64_t i = 0; i < n; i++) {
+        struct msghdr *hdr = &msgs[i].msg_hdr;
+        JSValue msg = JS_GetPropertyUint32(ctx, argv[0], i);
+        JSValue data = JS_GetPropertyStr(ctx, msg, "data");
+        JSValue addr = JS_GetPropertyStr(ctx, msg, "addr");
+        JSValue control = JS_GetPropertyStr(ctx, msg, "control");
+        JS_FreeValue(ctx, msg);
+
+        bool ok = true;
+        int64_t niov = 1;
+        if (JS_IsArray(ctx, data)) {
+            ok = !JS_GetLength(ctx, data, &niov) && niov <= IOV_MAX;
+        }
+        iovs[i] = ok ? js_malloc(ctx, sizeof(struct iovec) * (niov > 0 ? niov : 1)) : NULL;
+        ok = iovs[i] != NULL;
+        for (int64_t j = 0; ok && j < niov; j++) {
+            size_t sz;
+            JSValue v = JS_IsArray(ctx, data) ? JS_GetPropertyUint32(ctx, data, j) : JS_DupValue(ctx, data);
+            iovs[i][j].iov_base = JS_GetUint8Array(ctx, &sz, v);
+            iovs[i][j].iov_len = sz;
+            ok = iovs[i][j].iov_base != NULL;
+            JS_FreeValue(ctx, v);
+        }
+        hdr->msg_iov = iovs[i];
+        hdr->msg_iovlen = niov;
+
+        if (ok && !JS_IsUndefined(addr)) {
+            size_t sz;
+            hdr->msg_name = JS_GetUint8Array(ctx, &sz, addr);
+            hdr->msg_namelen = sz;
+            ok = hdr->msg_name != NULL;
+        }
+        if (ok && !JS_IsUndefined(control)) {
+            size_t sz;
+            hdr->msg_control = JS_GetUint8Array(ctx, &sz, control);
+            hdr->msg_controllen = sz;
+            ok = hdr->msg_control != NULL;
+        }
+
+        // the pointers stay valid, the messages array keeps the buffers alive
+        JS_FreeValue(ctx, data);
+        JS_FreeValue(ctx, addr);
+        JS_FreeValue(ctx, control);
+        if (!ok) {
+            JS_FreeValue(ctx, JS_GetException(ctx));
+            ret = JS_ThrowTypeError(ctx, "invalid message at index %d", (int) i);
+            goto end;
+        }
+    }
+
+    int r = tjs_sock_sendmmsg(s->sock, msgs, n, flags);
+    if (r < 0) {
+        ret = (errno == EAGAIN || errno == EWOULDBLOCK) ? JS_NewUint32(ctx, 0) : THROW_STRERROR();
+    } else {
+        ret = JS_NewUint32(ctx, r);
+    }
+
+end:
+    if (iovs) {
+        for (int64_t i = 0; i < n; i++) {
+            js_free(ctx, iovs[i]);
+        }
+    }
+    js_free(ctx, iovs);
+    js_free(ctx, msgs);
+    return ret;
+}
 
 static void tjs_sock_uv_poll_cb(uv_poll_t *handle, int status, int events) {
     tjs_sock_t *s = uv_handle_get_data((uv_handle_t *) handle);
@@ -524,6 +781,11 @@ static JSValue tjs_sock_poll(JSContext *ctx, JSValue this_val, int argc, JSValue
         uv_handle_set_data((uv_handle_t *) &s->poll, s);
     }
 
+    if (s->in_cb && s->batch.count > 0) {
+        return JS_ThrowInternalError(ctx, "cannot change poll during callback");
+    }
+    tjs_sock_batch_free(ctx, s);
+    JS_FreeValue(ctx, s->callback);
     s->callback = JS_DupValue(ctx, argv[1]);
     int ret = uv_poll_start(&s->poll, events, tjs_sock_uv_poll_cb);
     if (ret < 0) {
@@ -534,6 +796,114 @@ static JSValue tjs_sock_poll(JSContext *ctx, JSValue this_val, int argc, JSValue
     return JS_UNDEFINED;
 }
 
+static void tjs_sock_call_batch_cb(tjs_sock_t *s, int status, JSValue results) {
+    JSValue args[] = { JS_NewInt32(s->jsctx, status), results };
+    s->in_cb = true;
+    JSValue ret = JS_Call(s->jsctx, s->callback, s->this, countof(args), args);
+    s->in_cb = false;
+    JS_FreeValue(s->jsctx, ret);
+    JS_FreeValue(s->jsctx, results);
+}
+
+// Reads until the socket would block, calling JS once per filled set of buffers and once for the rest.
+// At most TJS_SOCK_BATCH_MAX_READS batches are read per wakeup so a busy socket can't starve the loop, the poll
+// fires again for whatever is left.
+static void tjs_sock_uv_poll_batch_cb(uv_poll_t *handle, int status, int events) {
+    tjs_sock_t *s = uv_handle_get_data((uv_handle_t *) handle);
+    JSContext *ctx = s->jsctx;
+    if (status < 0) {
+        tjs_sock_call_batch_cb(s, status, JS_UNDEFINED);
+        return;
+    }
+
+    for (int i = 0; i < TJS_SOCK_BATCH_MAX_READS; i++) {
+        // the buffers are looked up again every time, JS may have detached them in the meantime
+        if (tjs_sock_mmsg_setup(ctx, s->batch.buffers, s->batch.count, s->batch.msgs, s->batch.iovs, s->batch.addrs)) {
+            JS_FreeValue(ctx, JS_GetException(ctx));
+            uv_poll_stop(&s->poll);
+            tjs_sock_call_batch_cb(s, UV_EINVAL, JS_UNDEFINED);
+            return;
+        }
+
+        int r = tjs_sock_recvmmsg(s->sock, s->batch.msgs, s->batch.count, s->batch.flags | MSG_DONTWAIT);
+        if (r < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                tjs_sock_call_batch_cb(s, -errno, JS_UNDEFINED);
+            }
+            return;
+        }
+
+        tjs_sock_call_batch_cb(s, 0, tjs_sock_mmsg_results(ctx, s->batch.msgs, r));
+
+        // fewer messages than buffers means the socket is drained
+        if ((unsigned) r < s->batch.count) {
+            return;
+        }
+    }
+}
+
+static JSValue tjs_sock_poll_batch(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    // this: PosixSocket
+    // args: Uint8Array[] buffers, function callback(status, results), int flags
+    tjs_sock_t *s = JS_GetOpaque(this_val, tjs_sock_classid);
+    TJS_CHECK_ARG_RET(ctx, s, -1, TJS_SOCK_CLASS_NAME);
+    if (s->closed) {
+        return JS_ThrowInternalError(ctx, "Socket closed");
+    }
+    if (s->in_cb) {
+        return JS_ThrowInternalError(ctx, "cannot change poll during callback");
+    }
+    int64_t n;
+    TJS_CHECK_ARG_RET(ctx, JS_IsArray(ctx, argv[0]) && !JS_GetLength(ctx, argv[0], &n), 0, "array of Uint8Array");
+    TJS_CHECK_ARG_RET(ctx, n > 0 && n <= UINT16_MAX, 0, "non-empty array of Uint8Array");
+    TJS_CHECK_ARG_RET(ctx, JS_IsFunction(ctx, argv[1]), 1, "function");
+    int flags = 0;
+    if (!JS_IsUndefined(argv[2])) {
+        TJS_CHECK_ARG_RET(ctx, !JS_ToUint32(ctx, (unsigned *) &flags, argv[2]), 2, "positive integer");
+    }
+
+    tjs_mmsghdr_t *msgs = js_malloc(ctx, sizeof(*msgs) * n);
+    struct iovec *iovs = js_malloc(ctx, sizeof(*iovs) * n);
+    struct sockaddr_storage *addrs = js_malloc(ctx, sizeof(*addrs) * n);
+    if (!msgs || !iovs || !addrs || tjs_sock_mmsg_setup(ctx, argv[0], n, msgs, iovs, addrs) != 0) {
+        js_free(ctx, msgs);
+        js_free(ctx, iovs);
+        js_free(ctx, addrs);
+        return JS_EXCEPTION;
+    }
+
+    if (!s->poll_init) {
+        int ret = uv_poll_init(tjs_get_loop(ctx), &s->poll, s->sock);
+        if (ret < 0) {
+            js_free(ctx, msgs);
+            js_free(ctx, iovs);
+            js_free(ctx, addrs);
+            return tjs_throw_errno(ctx, ret);
+        }
+        s->poll_init = true;
+        uv_handle_set_data((uv_handle_t *) &s->poll, s);
+    }
+
+    tjs_sock_batch_free(ctx, s);
+    s->batch.buffers = JS_DupValue(ctx, argv[0]);
+    s->batch.count = n;
+    s->batch.flags = flags;
+    s->batch.msgs = msgs;
+    s->batch.iovs = iovs;
+    s->batch.addrs = addrs;
+
+    JS_FreeValue(ctx, s->callback);
+    s->callback = JS_DupValue(ctx, argv[1]);
+    int ret = uv_poll_start(&s->poll, UV_READABLE, tjs_sock_uv_poll_batch_cb);
+    if (ret < 0) {
+        JS_FreeValue(ctx, s->callback);
+        s->callback = JS_UNDEFINED;
+        tjs_sock_batch_free(ctx, s);
+        return tjs_throw_errno(ctx, ret);
+    }
+    return JS_UNDEFINED;
+}
+
 static JSValue tjs_sock_poll_stop(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
     tjs_sock_t *s = JS_GetOpaque(this_val, tjs_sock_classid);
     TJS_CHECK_ARG_RET(ctx, s, -1, TJS_SOCK_CLASS_NAME);
@@ -576,7 +946,10 @@ static const JSCFunctionListEntry tjs_sock_proto_funcs[] = {
     TJS_CFUNC_DEF("recv", 2, tjs_sock_recv),
     TJS_CFUNC_DEF("sendmsg", 4, tjs_sock_sendmsg),
     TJS_CFUNC_DEF("recvmsg", 2, tjs_sock_recvmsg),
+    TJS_CFUNC_DEF("recvmmsg", 2, tjs_sock_recvmmsg_js),
+    TJS_CFUNC_DEF("sendmmsg", 2, tjs_sock_sendmmsg_js),
     TJS_CFUNC_DEF("poll", 2, tjs_sock_poll),
+    TJS_CFUNC_DEF("pollBatch", 3, tjs_sock_poll_batch),
     TJS_CFUNC_DEF("pollStop", 0, tjs_sock_poll_stop),
 
     TJS_CGETSET_DEF("polling", tjs_uv_poll_get_running, NULL),
@@ -27,6 +27,20 @@
 #include "utils.h"
 
 #include <string.h>
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+#include <sys/types.h>
+#include <sys/uio.h>
+#endif
 
 
 /* Forward declarations */
@@ -54,9 +68,55 @@ typedef struct {
         } b;
         TJSPromise result;
     } read;
+    /* Listeners accept connections ahead of JS into a bounded ring, and stop accepting when it's full. */
     struct {
+        JSValue *items;
+        size_t head;
+        size_t len;
+        size_t max;
+        bool stalled;
+        int error;
         TJSPromise result;
     } accept;
+    /* Flowing mode: the handle keeps reading into a queue of chunks until it's full. */
+    struct {
+        bool active;
+        bool paused;
+        bool eof;
+        int error;
+        size_t hwm;
+        size_t queued;
+        uint8_t *buf;
+        struct {
+            JSValue *items;
+            size_t len;
+            size_t cap;
+        } chunks;
+        TJSPromise result;
+    } flow;
+    struct {
+        bool pending;
+        bool close;
+        struct TJSSendFileReq *req;
+    } sendfile;
+    /* Writes made while corked share a promise and go out with a single uv_write. */
+    struct {
+        int depth;
+        bool tcp_cork;
+        struct {
+            JSValue *items;
+            size_t len;
+            size_t cap;
+        } chunks;
+        TJSPromise result;
+    } cork;
+    /* Resolved once the write queue goes down to the given size. */
+    struct {
+        size_t lowat;
+        TJSPromise result;
+    } drain;
+    /* Set while the handle is the source of a native pipe. */
+    struct TJSStreamPipe *pipe;
 } TJSStream;
 
 typedef struct {
@@ -71,12 +131,16 @@ typedef struct {
 
 typedef struct {
     uv_write_t req;
-    JSValue tarray;
+    JSValue tarray; /* A Uint8Array, or an array of them for vectored writes. */
+    size_t size;
     TJSPromise result;
 } TJSWriteReq;
 
 static TJSStream *tjs_tcp_get(JSContext *ctx, JSValue obj);
 static TJSStream *tjs_pipe_get(JSContext *ctx, JSValue obj);
+static void tjs__stream_cork_flush(JSContext *ctx, TJSStream *s);
+static void tjs__stream_pipe_cancel(TJSStream *s);
+static void tjs__sendfile_cancel(struct TJSSendFileReq *sr);
 
 static void uv__stream_close_cb(uv_handle_t *handle) {
     TJSStream *s = handle->data;
@@ -100,6 +164,19 @@ static JSValue tjs_stream_close(JSContext *ctx, JSValue this_val, int argc, JSVa
         return JS_EXCEPTION;
     }
 
+    /* A chunk may still be in flight on the threadpool, close once the transfer is done. */
+    if (s->sendfile.pending) {
+        s->sendfile.close = true;
+        tjs__sendfile_cancel(s->sendfile.req);
+        return JS_UNDEFINED;
+    }
+
+    /* Corked data is queued before closing; libuv cancels it if it can't be written right away. */
+    if (s->cork.depth > 0) {
+        s->cork.depth = 0;
+        tjs__stream_cork_flush(ctx, s);
+    }
+
     JSValue arg = JS_UNDEFINED;
     if (TJS_IsPromisePending(ctx, &s->read.result)) {
         TJS_SettlePromise(ctx, &s->read.result, 0, 1, &arg);
@@ -109,6 +186,25 @@ static JSValue tjs_stream_close(JSContext *ctx, JSValue this_val, int argc, JSVa
         TJS_SettlePromise(ctx, &s->accept.result, 0, 1, &arg);
         TJS_ClearPromise(ctx, &s->accept.result);
     }
+    /* Dropping queued connections closes them. */
+    for (size_t i = 0; i < s->accept.len; i++) {
+        JS_FreeValue(ctx, s->accept.items[(s->accept.head + i) % s->accept.max]);
+    }
+    s->accept.len = 0;
+    s->accept.stalled = false;
+    if (TJS_IsPromisePending(ctx, &s->flow.result)) {
+        arg = JS_NULL;
+        TJS_SettlePromise(ctx, &s->flow.result, 0, 1, &arg);
+        TJS_ClearPromise(ctx, &s->flow.result);
+    }
+    if (TJS_IsPromisePending(ctx, &s->drain.result)) {
+        arg = JS_UNDEFINED;
+        TJS_SettlePromise(ctx, &s->drain.result, 0, 1, &arg);
+        TJS_ClearPromise(ctx, &s->drain.result);
+    }
+    if (s->pipe) {
+        tjs__stream_pipe_cancel(s);
+    }
 
     maybe_close(s);
     return JS_UNDEFINED;
@@ -156,7 +252,7 @@ static JSValue tjs_stream_read(JSContext *ctx, JSValue this_val, int argc, JSVal
     if (!s) {
         return JS_EXCEPTION;
     }
-    if (TJS_IsPromisePending(ctx, &s->read.result)) {
+    if (s->flow.active || s->pipe || TJS_IsPromisePending(ctx, &s->read.result)) {
         return tjs_throw_errno(ctx, UV_EBUSY);
     }
 
@@ -182,6 +278,210 @@ static JSValue tjs_stream_read(JSContext *ctx, JSValue this_val, int argc, JSVal
     return TJS_InitPromise(ctx, &s->read.result);
 }
 
+#define TJS__FLOW_BUF_SIZE (64 * 1024)
+#define TJS__FLOW_DEFAULT_HWM (256 * 1024)
+
+static void uv__stream_flow_alloc_cb(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+    TJSStream *s = handle->data;
+    CHECK_NOT_NULL(s);
+
+    if (!s->flow.buf) {
+        s->flow.buf = js_malloc(s->ctx, TJS__FLOW_BUF_SIZE);
+    }
+
+    buf->base = (char *) s->flow.buf;
+    buf->len = s->flow.buf ? TJS__FLOW_BUF_SIZE : 0;
+}
+
+static void uv__stream_flow_read_cb(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf);
+
+/* Hands all the queued chunks over to JS, resuming reading if it was paused. */
+static JSValue tjs__stream_flow_take(JSContext *ctx, TJSStream *s) {
+    JSValue arr = JS_NewArray(ctx);
+    if (JS_IsException(arr)) {
+        return arr;
+    }
+
+    for (uint32_t i = 0; i < s->flow.chunks.len; i++) {
+        JS_DefinePropertyValueUint32(ctx, arr, i, s->flow.chunks.items[i], JS_PROP_C_W_E);
+    }
+
+    s->flow.chunks.len = 0;
+    s->flow.queued = 0;
+
+    if (s->flow.paused && !s->flow.eof && s->flow.error == 0 && !uv_is_closing(&s->h.handle)) {
+        s->flow.paused = false;
+        int r = uv_read_start(&s->h.stream, uv__stream_flow_alloc_cb, uv__stream_flow_read_cb);
+        if (r != 0) {
+            s->flow.error = r;
+        }
+    }
+
+    return arr;
+}
+
+static void uv__stream_flow_read_cb(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf) {
+    TJSStream *s = handle->data;
+    CHECK_NOT_NULL(s);
+
+    JSContext *ctx = s->ctx;
+
+    if (nread == 0) {
+        return;
+    }
+
+    if (nread < 0) {
+        uv_read_stop(handle);
+        if (nread == UV_EOF) {
+            s->flow.eof = true;
+        } else {
+            s->flow.error = nread;
+        }
+    } else {
+        JSValue chunk;
+
+        /* Big reads take over the buffer, trimmed to what was read so the unused tail isn't kept alive with the
+         * chunk. Small ones are copied so the buffer can be reused. */
+        if (nread >= TJS__FLOW_BUF_SIZE / 2) {
+            uint8_t *data = s->flow.buf;
+            if (nread < TJS__FLOW_BUF_SIZE) {
+                uint8_t *trimmed = js_realloc(ctx, data, nread);
+                data = trimmed ? trimmed : data;
+            }
+            chunk = TJS_NewUint8Array(ctx, data, nread);
+            s->flow.buf = NULL;
+        } else {
+            chunk = JS_NewUint8ArrayCopy(ctx, (const uint8_t *) buf->base, nread);
+        }
+
+        if (s->flow.chunks.len == s->flow.chunks.cap) {
+            size_t cap = s->flow.chunks.cap ? s->flow.chunks.cap * 2 : 16;
+            JSValue *items = js_realloc(ctx, s->flow.chunks.items, cap * sizeof(*items));
+            if (!items) {
+                JS_FreeValue(ctx, chunk);
+                uv_read_stop(handle);
+                s->flow.error = UV_ENOMEM;
+                goto settle;
+            }
+            s->flow.chunks.items = items;
+            s->flow.chunks.cap = cap;
+        }
+
+        s->flow.chunks.items[s->flow.chunks.len++] = chunk;
+        s->flow.queued += nread;
+
+        /* Back-pressure: stop reading until JS takes the queued data. */
+        if (s->flow.queued >= s->flow.hwm) {
+            uv_read_stop(handle);
+            s->flow.paused = true;
+        }
+    }
+
+settle:
+    if (!TJS_IsPromisePending(ctx, &s->flow.result)) {
+        return;
+    }
+
+    JSValue arg;
+    bool is_reject = false;
+
+    if (s->flow.chunks.len > 0) {
+        arg = tjs__stream_flow_take(ctx, s);
+    } else if (s->flow.error != 0) {
+        arg = tjs_new_error(ctx, s->flow.error);
+        is_reject = true;
+    } else {
+        arg = JS_NULL;
+    }
+
+    TJS_SettlePromise(ctx, &s->flow.result, is_reject, 1, &arg);
+    TJS_ClearPromise(ctx, &s->flow.result);
+}
+
+static JSValue tjs_stream_read_start(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    JSClassID class_id;
+    TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
+    if (!s) {
+        return JS_EXCEPTION;
+    }
+
+    if (s->flow.active) {
+        return JS_UNDEFINED;
+    }
+
+    if (s->pipe || TJS_IsPromisePending(ctx, &s->read.result)) {
+        return tjs_throw_errno(ctx, UV_EBUSY);
+    }
+
+    int64_t hwm = TJS__FLOW_DEFAULT_HWM;
+    if (!JS_IsUndefined(argv[0]) && JS_ToInt64(ctx, &hwm, argv[0])) {
+        return JS_EXCEPTION;
+    }
+    if (hwm < 1) {
+        return JS_ThrowRangeError(ctx, "highWaterMark must be positive");
+    }
+
+    int r = uv_read_start(&s->h.stream, uv__stream_flow_alloc_cb, uv__stream_flow_read_cb);
+    if (r != 0) {
+        return tjs_throw_errno(ctx, r);
+    }
+
+    s->flow.active = true;
+    s->flow.hwm = hwm;
+
+    return JS_UNDEFINED;
+}
+
+static JSValue tjs_stream_read_chunks(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    JSClassID class_id;
+    TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
+    if (!s) {
+        return JS_EXCEPTION;
+    }
+
+    if (!s->flow.active) {
+        return JS_ThrowTypeError(ctx, "stream is not in flowing mode");
+    }
+
+    if (TJS_IsPromisePending(ctx, &s->flow.result)) {
+        return tjs_throw_errno(ctx, UV_EBUSY);
+    }
+
+    /* Data is handed out before any error or EOF. */
+    if (s->flow.chunks.len > 0) {
+        JSValue arr = tjs__stream_flow_take(ctx, s);
+        if (JS_IsException(arr)) {
+            return arr;
+        }
+        return TJS_NewResolvedPromise(ctx, 1, &arr);
+    }
+
+    if (s->flow.error != 0) {
+        JSValue err = tjs_new_error(ctx, s->flow.error);
+        return TJS_NewRejectedPromise(ctx, 1, &err);
+    }
+
+    if (s->flow.eof || uv_is_closing(&s->h.handle)) {
+        JSValue arg = JS_NULL;
+        return TJS_NewResolvedPromise(ctx, 1, &arg);
+    }
+
+    return TJS_InitPromise(ctx, &s->flow.result);
+}
+
+static void tjs__stream_maybe_drain(TJSStream *s) {
+    JSContext *ctx = s->ctx;
+    /* Writes can outlive the handle object. */
+    if (s->finalized) {
+        return;
+    }
+    if (TJS_IsPromisePending(ctx, &s->drain.result) && uv_stream_get_write_queue_size(&s->h.stream) <= s->drain.lowat) {
+        JSValue arg = JS_UNDEFINED;
+        TJS_SettlePromise(ctx, &s->drain.result, 0, 1, &arg);
+        TJS_ClearPromise(ctx, &s->drain.result);
+    }
+}
+
 static void uv__stream_write_cb(uv_write_t *req, int status) {
     TJSStream *s = req->handle->data;
     CHECK_NOT_NULL(s);
@@ -195,63 +495,325 @@ static void uv__stream_write_cb(uv_write_t *req, int status) {
         arg = tjs_new_error(ctx, status);
         is_reject = 1;
     } else {
-        arg = JS_UNDEFINED;
+        arg = JS_NewInt64(ctx, wr->size);
     }
 
     TJS_SettlePromise(ctx, &wr->result, is_reject, 1, &arg);
     JS_FreeValue(ctx, wr->tarray);
     js_free(ctx, wr);
+
+    tjs__stream_maybe_drain(s);
 }
 
-static JSValue tjs_stream_write(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+static JSValue tjs_stream_write_queue_size(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
     JSClassID class_id;
     TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
     if (!s) {
         return JS_EXCEPTION;
     }
 
-    size_t size;
-    uint8_t *buf = JS_GetUint8Array(ctx, &size, argv[0]);
-    if (!buf) {
+    return JS_NewInt64(ctx, uv_stream_get_write_queue_size(&s->h.stream));
+}
+
+/* Waits until at most the given amount of data (0 by default) is waiting to be written. */
+static JSValue tjs_stream_drain(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    JSClassID class_id;
+    TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
+    if (!s) {
         return JS_EXCEPTION;
     }
 
+    int64_t lowat = 0;
+    if (!JS_IsUndefined(argv[0]) && JS_ToInt64(ctx, &lowat, argv[0])) {
+        return JS_EXCEPTION;
+    }
+    if (lowat < 0) {
+        return JS_ThrowRangeError(ctx, "the threshold must be a positive integer");
+    }
+
+    if (uv_stream_get_write_queue_size(&s->h.stream) <= (size_t) lowat || uv_is_closing(&s->h.handle)) {
+        JSValue arg = JS_UNDEFINED;
+        return TJS_NewResolvedPromise(ctx, 1, &arg);
+    }
+
+    /* Everybody waits for the lowest threshold asked for. */
+    if (TJS_IsPromisePending(ctx, &s->drain.result)) {
+        if ((size_t) lowat < s->drain.lowat) {
+            s->drain.lowat = lowat;
+        }
+        return JS_DupValue(ctx, s->drain.result.p);
+    }
+
+    s->drain.lowat = lowat;
+    return TJS_InitPromise(ctx, &s->drain.result);
+}
+
+/* Writes the given buffers, inline if possible. The holder keeps them alive otherwise. When p is
+ * given it's settled with the result instead of returning a new promise. */
+static JSValue tjs__stream_write(JSContext *ctx, TJSStream *s, uv_buf_t *bufs, size_t nbufs, JSValue holder,
+                                 TJSPromise *p) {
+    size_t size = 0;
+    for (size_t i = 0; i < nbufs; i++) {
+        size += bufs[i].len;
+    }
+
     /* First try to do the write inline */
-    int r;
-    uv_buf_t b;
-    b = uv_buf_init((char *) buf, size);
-    r = uv_try_write(&s->h.stream, &b, 1);
+    int r = uv_try_write(&s->h.stream, bufs, nbufs);
 
-    if (r == size) {
+    if (r >= 0 && (size_t) r == size) {
         JSValue val = JS_NewInt64(ctx, size);
+        if (p) {
+            TJS_SettlePromise(ctx, p, false, 1, &val);
+            return JS_UNDEFINED;
+        }
         return TJS_NewResolvedPromise(ctx, 1, &val);
     }
 
-    /* Do an async write, copy the data. */
-    if (r >= 0) {
-        buf += r;
-        size -= r;
+    /* Do an async write of whatever is left. */
+    if (r > 0) {
+        size_t skip = r;
+        while (skip >= bufs->len) {
+            skip -= bufs->len;
+            bufs++;
+            nbufs--;
+        }
+        bufs->base += skip;
+        bufs->len -= skip;
     }
 
     TJSWriteReq *wr = js_malloc(ctx, sizeof(*wr));
     if (!wr) {
+        if (p) {
+            JSValue err = JS_GetException(ctx);
+            TJS_SettlePromise(ctx, p, true, 1, &err);
+            return JS_UNDEFINED;
+        }
         return JS_EXCEPTION;
     }
 
     wr->req.data = wr;
-    wr->tarray = JS_DupValue(ctx, argv[0]);
+    wr->tarray = JS_DupValue(ctx, holder);
+    wr->size = size;
 
-    b = uv_buf_init((char *) buf, size);
-    r = uv_write(&wr->req, &s->h.stream, &b, 1, uv__stream_write_cb);
+    r = uv_write(&wr->req, &s->h.stream, bufs, nbufs, uv__stream_write_cb);
     if (r != 0) {
         JS_FreeValue(ctx, wr->tarray);
         js_free(ctx, wr);
+        if (p) {
+            JSValue err = tjs_new_error(ctx, r);
+            TJS_SettlePromise(ctx, p, true, 1, &err);
+            return JS_UNDEFINED;
+        }
         return tjs_throw_errno(ctx, r);
     }
 
+    if (p) {
+        wr->result = *p;
+        return JS_UNDEFINED;
+    }
+
     return TJS_InitPromise(ctx, &wr->result);
 }
 
+static void tjs__stream_set_tcp_cork(TJSStream *s, bool enable) {
+#if defined(TCP_CORK) || defined(TCP_NOPUSH)
+    uv_os_fd_t fd;
+    if (s->h.handle.type != UV_TCP || uv_fileno(&s->h.handle, &fd) != 0) {
+        return;
+    }
+    int on = enable;
+#if defined(TCP_CORK)
+    setsockopt(fd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+#else
+    setsockopt(fd, IPPROTO_TCP, TCP_NOPUSH, &on, sizeof(on));
+#endif
+#endif
+}
+
+/* Sends everything written while corked with a single write. */
+static void tjs__stream_cork_flush(JSContext *ctx, TJSStream *s) {
+    size_t n = s->cork.chunks.len;
+
+    if (n > 0) {
+        TJSPromise p = s->cork.result;
+        TJS_ClearPromise(ctx, &s->cork.result);
+
+        JSValue holder = JS_NewArray(ctx);
+        uv_buf_t *bufs = js_malloc(ctx, n * sizeof(*bufs));
+        if (JS_IsException(holder) || !bufs) {
+            JSValue err = JS_GetException(ctx);
+            TJS_SettlePromise(ctx, &p, true, 1, &err);
+            for (size_t i = 0; i < n; i++) {
+                JS_FreeValue(ctx, s->cork.chunks.items[i]);
+            }
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                size_t size;
+                uint8_t *buf = JS_GetUint8Array(ctx, &size, s->cork.chunks.items[i]);
+                bufs[i] = uv_buf_init((char *) buf, size);
+                JS_DefinePropertyValueUint32(ctx, holder, i, s->cork.chunks.items[i], JS_PROP_C_W_E);
+            }
+            tjs__stream_write(ctx, s, bufs, n, holder, &p);
+        }
+
+        js_free(ctx, bufs);
+        JS_FreeValue(ctx, holder);
+        s->cork.chunks.len = 0;
+    }
+
+    if (s->cork.tcp_cork) {
+        s->cork.tcp_cork = false;
+        tjs__stream_set_tcp_cork(s, false);
+    }
+}
+
+static JSValue tjs_stream_write(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    JSClassID class_id;
+    TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
+    if (!s) {
+        return JS_EXCEPTION;
+    }
+
+    if (s->sendfile.pending) {
+        return tjs_throw_errno(ctx, UV_EBUSY);
+    }
+
+    size_t size;
+    uint8_t *buf = JS_GetUint8Array(ctx, &size, argv[0]);
+    if (!buf) {
+        return JS_EXCEPTION;
+    }
+
+    if (s->cork.depth > 0) {
+        if (s->cork.chunks.len == s->cork.chunks.cap) {
+            size_t cap = s->cork.chunks.cap ? s->cork.chunks.cap * 2 : 16;
+            JSValue *items = js_realloc(ctx, s->cork.chunks.items, cap * sizeof(*items));
+            if (!items) {
+                return JS_EXCEPTION;
+            }
+            s->cork.chunks.items = items;
+            s->cork.chunks.cap = cap;
+        }
+        if (!TJS_IsPromisePending(ctx, &s->cork.result)) {
+            JSValue p = TJS_InitPromise(ctx, &s->cork.result);
+            if (JS_IsException(p)) {
+                return p;
+            }
+            JS_FreeValue(ctx, p);
+        }
+        s->cork.chunks.items[s->cork.chunks.len++] = JS_DupValue(ctx, argv[0]);
+        return JS_DupValue(ctx, s->cork.result.p);
+    }
+
+    uv_buf_t b = uv_buf_init((char *) buf, size);
+    return tjs__stream_write(ctx, s, &b, 1, argv[0], NULL);
+}
+
+static JSValue tjs_stream_writev(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    JSClassID class_id;
+    TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
+    if (!s) {
+        return JS_EXCEPTION;
+    }
+
+    if (s->sendfile.pending) {
+        return tjs_throw_errno(ctx, UV_EBUSY);
+    }
+
+    if (!JS_IsArray(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected an array of Uint8Array");
+    }
+
+    int64_t len;
+    if (JS_GetLength(ctx, argv[0], &len)) {
+        return JS_EXCEPTION;
+    }
+
+    if (len == 0) {
+        JSValue val = JS_NewInt32(ctx, 0);
+        return TJS_NewResolvedPromise(ctx, 1, &val);
+    }
+
+    /* Corked writes are queued like any other write. */
+    if (s->cork.depth > 0) {
+        JSValue ret = JS_UNDEFINED;
+        for (uint32_t i = 0; i < len; i++) {
+            JSValue v = JS_GetPropertyUint32(ctx, argv[0], i);
+            JS_FreeValue(ctx, ret);
+            ret = tjs_stream_write(ctx, this_val, 1, &v);
+            JS_FreeValue(ctx, v);
+            if (JS_IsException(ret)) {
+                return ret;
+            }
+        }
+        return ret;
+    }
+
+    /* Copy the references so changes to the array don't free buffers being written. */
+    JSValue holder = JS_NewArray(ctx);
+    if (JS_IsException(holder)) {
+        return holder;
+    }
+
+    uv_buf_t *bufs = js_malloc(ctx, len * sizeof(*bufs));
+    if (!bufs) {
+        JS_FreeValue(ctx, holder);
+        return JS_EXCEPTION;
+    }
+
+    for (uint32_t i = 0; i < len; i++) {
+        JSValue v = JS_GetPropertyUint32(ctx, argv[0], i);
+        size_t size;
+        uint8_t *buf = JS_GetUint8Array(ctx, &size, v);
+        if (!buf) {
+            JS_FreeValue(ctx, v);
+            JS_FreeValue(ctx, holder);
+            js_free(ctx, bufs);
+            return JS_EXCEPTION;
+        }
+        bufs[i] = uv_buf_init((char *) buf, size);
+        JS_DefinePropertyValueUint32(ctx, holder, i, v, JS_PROP_C_W_E);
+    }
+
+    JSValue ret = tjs__stream_write(ctx, s, bufs, len, holder, NULL);
+
+    js_free(ctx, bufs);
+    JS_FreeValue(ctx, holder);
+
+    return ret;
+}
+
+static JSValue tjs_stream_cork(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    JSClassID class_id;
+    TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
+    if (!s) {
+        return JS_EXCEPTION;
+    }
+
+    if (JS_ToBool(ctx, argv[0]) && !s->cork.tcp_cork) {
+        s->cork.tcp_cork = true;
+        tjs__stream_set_tcp_cork(s, true);
+    }
+
+    s->cork.depth++;
+
+    return JS_UNDEFINED;
+}
+
+static JSValue tjs_stream_uncork(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    JSClassID class_id;
+    TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
+    if (!s) {
+        return JS_EXCEPTION;
+    }
+
+    if (s->cork.depth > 0 && --s->cork.depth == 0) {
+        tjs__stream_cork_flush(ctx, s);
+    }
+
+    return JS_UNDEFINED;
+}
+
 static void uv__stream_shutdown_cb(uv_shutdown_t *req, int status) {
     TJSStream *s = req->handle->data;
     CHECK_NOT_NULL(s);
@@ -334,35 +896,99 @@ static void uv__stream_connect_cb(uv_connect_t *req, int status) {
     js_free(ctx, cr);
 }
 
+#define TJS__ACCEPT_DEFAULT_QUEUE_SIZE 128
+
+/* Takes the connection libuv is holding on to. */
+static int tjs__stream_accept_one(JSContext *ctx, TJSStream *s, JSValue *out) {
+    JSValue obj;
+    TJSStream *t2;
+    switch (s->h.handle.type) {
+        case UV_TCP:
+            obj = tjs_new_tcp(ctx, AF_UNSPEC);
+            t2 = JS_IsException(obj) ? NULL : tjs_tcp_get(ctx, obj);
+            break;
+        case UV_NAMED_PIPE:
+            obj = tjs_new_pipe(ctx);
+            t2 = JS_IsException(obj) ? NULL : tjs_pipe_get(ctx, obj);
+            break;
+        default:
+            abort();
+    }
+
+    if (!t2) {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return UV_ENOMEM;
+    }
+
+    int r = uv_accept(&s->h.stream, &t2->h.stream);
+    if (r != 0) {
+        JS_FreeValue(ctx, obj);
+        return r;
+    }
+
+    *out = obj;
+    return 0;
+}
+
+/* Queues a connection if there is room, otherwise libuv keeps it and stops accepting until we take it. */
+static void tjs__stream_accept_queue(JSContext *ctx, TJSStream *s) {
+    if (s->accept.len >= s->accept.max) {
+        s->accept.stalled = true;
+        return;
+    }
+
+    JSValue conn;
+    int r = tjs__stream_accept_one(ctx, s, &conn);
+    if (r == UV_ENOMEM) {
+        s->accept.stalled = true;
+    }
+    if (r != 0) {
+        s->accept.error = r;
+        return;
+    }
+
+    s->accept.items[(s->accept.head + s->accept.len) % s->accept.max] = conn;
+    s->accept.len++;
+}
+
+static JSValue tjs__stream_accept_shift(JSContext *ctx, TJSStream *s) {
+    JSValue conn = s->accept.items[s->accept.head];
+    s->accept.head = (s->accept.head + 1) % s->accept.max;
+    s->accept.len--;
+    return conn;
+}
+
+static void tjs__stream_accept_resume(JSContext *ctx, TJSStream *s) {
+    if (s->accept.stalled && !uv_is_closing(&s->h.handle)) {
+        s->accept.stalled = false;
+        tjs__stream_accept_queue(ctx, s);
+    }
+}
+
 static void uv__stream_connection_cb(uv_stream_t *handle, int status) {
     TJSStream *s = handle->data;
     CHECK_NOT_NULL(s);
 
-    if (!TJS_IsPromisePending(s->ctx, &s->accept.result)) {
-        // TODO - handle this.
+    JSContext *ctx = s->ctx;
+
+    /* Nobody is waiting, libuv calls us for every connection that is ready so queue them all. */
+    if (!TJS_IsPromisePending(ctx, &s->accept.result)) {
+        if (status < 0) {
+            s->accept.error = status;
+        } else {
+            tjs__stream_accept_queue(ctx, s);
+        }
         return;
     }
-    JSContext *ctx = s->ctx;
+
     JSValue arg;
     int is_reject = 0;
     if (status == 0) {
-        TJSStream *t2;
-        switch (handle->type) {
-            case UV_TCP:
-                arg = tjs_new_tcp(ctx, AF_UNSPEC);
-                t2 = tjs_tcp_get(ctx, arg);
-                break;
-            case UV_NAMED_PIPE:
-                arg = tjs_new_pipe(ctx);
-                t2 = tjs_pipe_get(ctx, arg);
-                break;
-            default:
-                abort();
-        }
-
-        int r = uv_accept(handle, &t2->h.stream);
+        int r = tjs__stream_accept_one(ctx, s, &arg);
+        if (r == UV_ENOMEM) {
+            s->accept.stalled = true;
+        }
         if (r != 0) {
-            JS_FreeValue(ctx, arg);
             arg = tjs_new_error(ctx, r);
             is_reject = 1;
         }
@@ -387,8 +1013,28 @@ static JSValue tjs_stream_listen(JSContext *ctx, JSValue this_val, int argc, JSV
             return JS_EXCEPTION;
         }
     }
+    uint32_t max = TJS__ACCEPT_DEFAULT_QUEUE_SIZE;
+    if (!JS_IsUndefined(argv[1])) {
+        if (JS_ToUint32(ctx, &max, argv[1])) {
+            return JS_EXCEPTION;
+        }
+        if (max < 1) {
+            return JS_ThrowRangeError(ctx, "the accept queue size must be positive");
+        }
+    }
+    if (s->accept.items) {
+        return tjs_throw_errno(ctx, UV_EINVAL);
+    }
+    s->accept.items = js_malloc(ctx, max * sizeof(*s->accept.items));
+    if (!s->accept.items) {
+        return JS_EXCEPTION;
+    }
+    s->accept.max = max;
     int r = uv_listen(&s->h.stream, (int) backlog, uv__stream_connection_cb);
     if (r != 0) {
+        js_free(ctx, s->accept.items);
+        s->accept.items = NULL;
+        s->accept.max = 0;
         return tjs_throw_errno(ctx, r);
     }
     return JS_UNDEFINED;
@@ -403,9 +1049,100 @@ static JSValue tjs_stream_accept(JSContext *ctx, JSValue this_val, int argc, JSV
     if (TJS_IsPromisePending(ctx, &s->accept.result)) {
         return tjs_throw_errno(ctx, UV_EBUSY);
     }
+    if (s->accept.len > 0) {
+        JSValue conn = tjs__stream_accept_shift(ctx, s);
+        tjs__stream_accept_resume(ctx, s);
+        return TJS_NewResolvedPromise(ctx, 1, &conn);
+    }
+    if (s->accept.error != 0) {
+        JSValue err = tjs_new_error(ctx, s->accept.error);
+        s->accept.error = 0;
+        tjs__stream_accept_resume(ctx, s);
+        return TJS_NewRejectedPromise(ctx, 1, &err);
+    }
+    if (uv_is_closing(&s->h.handle)) {
+        JSValue arg = JS_UNDEFINED;
+        return TJS_NewResolvedPromise(ctx, 1, &arg);
+    }
+    tjs__stream_accept_resume(ctx, s);
+    if (s->accept.len > 0) {
+        JSValue conn = tjs__stream_accept_shift(ctx, s);
+        return TJS_NewResolvedPromise(ctx, 1, &conn);
+    }
     return TJS_InitPromise(ctx, &s->accept.result);
 }
 
+/* Takes all the connections accepted so far, without waiting. */
+static JSValue tjs_stream_accept_queued(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    JSClassID class_id;
+    TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
+    if (!s) {
+        return JS_EXCEPTION;
+    }
+
+    JSValue arr = JS_NewArray(ctx);
+    if (JS_IsException(arr)) {
+        return arr;
+    }
+
+    uint32_t i = 0;
+    do {
+        while (s->accept.len > 0) {
+            JSValue conn = tjs__stream_accept_shift(ctx, s);
+            JS_DefinePropertyValueUint32(ctx, arr, i++, conn, JS_PROP_C_W_E);
+        }
+        /* Make room for what libuv is holding on to. */
+        tjs__stream_accept_resume(ctx, s);
+    } while (s->accept.len > 0);
+
+    return arr;
+}
+
+/* Sets the send (magic 0) or receive (magic 1) buffer size, if given, and returns the current one. Linux
+ * doubles the requested value to account for bookkeeping. */
+static JSValue tjs_stream_buffer_size(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
+    JSClassID class_id;
+    TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
+    if (!s) {
+        return JS_EXCEPTION;
+    }
+
+    int value = 0;
+    if (!JS_IsUndefined(argv[0])) {
+        if (JS_ToInt32(ctx, &value, argv[0])) {
+            return JS_EXCEPTION;
+        }
+        if (value < 1) {
+            return JS_ThrowRangeError(ctx, "buffer size must be positive");
+        }
+    }
+
+    int r;
+    if (magic == 0) {
+        r = uv_send_buffer_size(&s->h.handle, &value);
+    } else {
+        r = uv_recv_buffer_size(&s->h.handle, &value);
+    }
+    if (r != 0) {
+        return tjs_throw_errno(ctx, r);
+    }
+
+    /* Read back what the kernel settled on. */
+    if (!JS_IsUndefined(argv[0])) {
+        value = 0;
+        if (magic == 0) {
+            r = uv_send_buffer_size(&s->h.handle, &value);
+        } else {
+            r = uv_recv_buffer_size(&s->h.handle, &value);
+        }
+        if (r != 0) {
+            return tjs_throw_errno(ctx, r);
+        }
+    }
+
+    return JS_NewInt32(ctx, value);
+}
+
 static JSValue tjs_stream_set_blocking(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
     JSClassID class_id;
     TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
@@ -425,6 +1162,345 @@ static JSValue tjs_stream_set_blocking(JSContext *ctx, JSValue this_val, int arg
     return JS_UNDEFINED;
 }
 
+#define TJS__SENDFILE_CHUNK_SIZE (4 * 1024 * 1024)
+/* Chunks sent in one go before yielding to the loop, like libuv does for reads. */
+#define TJS__SENDFILE_MAX_CHUNKS 16
+
+/* The transfer is driven from the loop: sendfile(2) is called on the non-blocking output, and while it's full a
+ * poll handle waits for it to become writable, so no threadpool thread is held while a client is slow. Outputs
+ * the system's sendfile can't handle (files, on some platforms) are written with uv_fs_sendfile instead, one chunk
+ * at a time, since they never block on the reader. */
+typedef struct TJSSendFileReq {
+    JSContext *ctx;
+    JSValue obj;
+    TJSStream *s;
+    uv_os_fd_t out_fd;
+    uv_file in_fd;
+    int64_t offset;
+    int64_t length;
+    int64_t sent;
+    bool seek; /* Move the file position past the sent data when done. */
+    bool cancelled;
+    bool use_fs;
+    bool sending;
+    bool poll_init;
+    int poll_fd;
+    uv_fs_t req;
+    uv_poll_t poll;
+    TJSPromise result;
+} TJSSendFileReq;
+
+static void tjs__sendfile_next(TJSSendFileReq *sr);
+
+static void uv__sendfile_poll_close_cb(uv_handle_t *handle) {
+    TJSSendFileReq *sr = handle->data;
+#if !defined(_WIN32)
+    close(sr->poll_fd);
+#endif
+    js_free(sr->ctx, sr);
+}
+
+static void tjs__sendfile_finish(TJSSendFileReq *sr, int r) {
+    JSContext *ctx = sr->ctx;
+    TJSStream *s = sr->s;
+    JSValue arg;
+    bool is_reject = false;
+
+#if !defined(_WIN32)
+    if (sr->seek) {
+        lseek(sr->in_fd, sr->offset + sr->sent, SEEK_SET);
+    }
+#endif
+
+    if (s) {
+        s->sendfile.pending = false;
+        s->sendfile.req = NULL;
+    }
+
+    if (r < 0) {
+        arg = tjs_new_error(ctx, r);
+        is_reject = true;
+    } else {
+        arg = JS_NewInt64(ctx, sr->sent);
+    }
+
+    TJS_SettlePromise(ctx, &sr->result, is_reject, 1, &arg);
+
+    if (s && s->sendfile.close) {
+        s->sendfile.close = false;
+        JSValue ret = tjs_stream_close(ctx, sr->obj, 0, NULL);
+        JS_FreeValue(ctx, ret);
+    }
+
+    JS_FreeValue(ctx, sr->obj);
+
+    if (sr->poll_init) {
+        uv_close((uv_handle_t *) &sr->poll, uv__sendfile_poll_close_cb);
+    } else {
+        js_free(ctx, sr);
+    }
+}
+
+static void tjs__sendfile_cancel(TJSSendFileReq *sr) {
+    sr->cancelled = true;
+
+    /* The chunk in flight settles the transfer when it's done, or cancelled. */
+    if (sr->sending) {
+        uv_cancel((uv_req_t *) &sr->req);
+        return;
+    }
+
+    if (sr->poll_init) {
+        uv_poll_stop(&sr->poll);
+    }
+    tjs__sendfile_finish(sr, UV_ECANCELED);
+}
+
+static void uv__sendfile_poll_cb(uv_poll_t *handle, int status, int events) {
+    TJSSendFileReq *sr = handle->data;
+    CHECK_NOT_NULL(sr);
+
+    uv_poll_stop(handle);
+
+    if (status < 0) {
+        tjs__sendfile_finish(sr, status);
+        return;
+    }
+
+    tjs__sendfile_next(sr);
+}
+
+/* Continues once the output is writable. The fd is duplicated since libuv doesn't allow a second watcher on the
+ * stream's own fd. */
+static int tjs__sendfile_wait(TJSSendFileReq *sr) {
+#if defined(_WIN32)
+    return UV_ENOTSUP;
+#else
+    if (!sr->poll_init) {
+        int fd = fcntl(sr->out_fd, F_DUPFD_CLOEXEC, 0);
+        if (fd == -1) {
+            return -errno;
+        }
+        int r = uv_poll_init(tjs_get_loop(sr->ctx), &sr->poll, fd);
+        if (r != 0) {
+            close(fd);
+            return r;
+        }
+        sr->poll.data = sr;
+        sr->poll_fd = fd;
+        sr->poll_init = true;
+    }
+
+    return uv_poll_start(&sr->poll, UV_WRITABLE, uv__sendfile_poll_cb);
+#endif
+}
+
+/* One non-blocking sendfile(2) call. Returns the amount sent, 0 on EOF or a negative error. UV_ENOTSUP means the
+ * output can't be used with it. */
+static int64_t tjs__sendfile_direct(TJSSendFileReq *sr, int64_t chunk) {
+    off_t off = sr->offset + sr->sent;
+#if defined(__linux__)
+    ssize_t r;
+    do {
+        r = sendfile(sr->out_fd, sr->in_fd, &off, chunk);
+    } while (r == -1 && errno == EINTR);
+    if (r >= 0) {
+        return r;
+    }
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+    off_t len = chunk;
+    int r;
+    do {
+#if defined(__APPLE__)
+        r = sendfile(sr->in_fd, sr->out_fd, off, &len, NULL, 0);
+#else
+        r = sendfile(sr->in_fd, sr->out_fd, off, chunk, NULL, &len, 0);
+#endif
+    } while (r == -1 && errno == EINTR && len == 0);
+    /* Partial sends report EAGAIN (or EINTR) along with the amount sent. */
+    if (r == 0 || len > 0) {
+        return len;
+    }
+#else
+    return UV_ENOTSUP;
+#endif
+#if defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__)
+    switch (errno) {
+        case EINVAL:
+        case ENOTSOCK:
+        case ENOTSUP:
+#if defined(EOPNOTSUPP) && EOPNOTSUPP != ENOTSUP
+        case EOPNOTSUPP:
+#endif
+        case ENOSYS:
+            return UV_ENOTSUP;
+        default:
+            return -errno;
+    }
+#endif
+}
+
+static void uv__sendfile_fs_cb(uv_fs_t *req) {
+    TJSSendFileReq *sr = req->data;
+    CHECK_NOT_NULL(sr);
+
+    ssize_t r = req->result;
+    uv_fs_req_cleanup(req);
+    sr->sending = false;
+
+    if (r > 0) {
+        sr->sent += r;
+    }
+
+    if (sr->cancelled) {
+        tjs__sendfile_finish(sr, UV_ECANCELED);
+        return;
+    }
+
+    if (r <= 0) {
+        /* An error, or EOF. */
+        tjs__sendfile_finish(sr, r);
+        return;
+    }
+
+    tjs__sendfile_next(sr);
+}
+
+static void tjs__sendfile_next(TJSSendFileReq *sr) {
+#if defined(_WIN32)
+    tjs__sendfile_finish(sr, UV_ENOTSUP);
+    return;
+#endif
+
+    for (int i = 0; i < TJS__SENDFILE_MAX_CHUNKS; i++) {
+        if (sr->length >= 0 && sr->sent >= sr->length) {
+            tjs__sendfile_finish(sr, 0);
+            return;
+        }
+
+        int64_t chunk = TJS__SENDFILE_CHUNK_SIZE;
+        if (sr->length >= 0 && sr->length - sr->sent < chunk) {
+            chunk = sr->length - sr->sent;
+        }
+
+        if (sr->use_fs) {
+            sr->req.data = sr;
+            int r = uv_fs_sendfile(tjs_get_loop(sr->ctx),
+                                   &sr->req,
+                                   (uv_file) sr->out_fd,
+                                   sr->in_fd,
+                                   sr->offset + sr->sent,
+                                   chunk,
+                                   uv__sendfile_fs_cb);
+            if (r != 0) {
+                tjs__sendfile_finish(sr, r);
+            } else {
+                sr->sending = true;
+            }
+            return;
+        }
+
+        int64_t r = tjs__sendfile_direct(sr, chunk);
+        if (r == UV_ENOTSUP) {
+            sr->use_fs = true;
+            continue;
+        }
+        if (r == UV_EAGAIN) {
+            break;
+        }
+        if (r <= 0) {
+            /* An error, or EOF. */
+            tjs__sendfile_finish(sr, r);
+            return;
+        }
+        sr->sent += r;
+    }
+
+    /* The output is full, or other handles get a turn. */
+    int r = tjs__sendfile_wait(sr);
+    if (r != 0) {
+        tjs__sendfile_finish(sr, r);
+    }
+}
+
+/* The stream is optional, the output can also be a file. */
+static JSValue tjs__sendfile_start(JSContext *ctx, JSValue obj, TJSStream *s, uv_os_fd_t out_fd, uv_file in_fd,
+                                   int64_t offset, int64_t length, bool seek) {
+    TJSSendFileReq *sr = js_mallocz(ctx, sizeof(*sr));
+    if (!sr) {
+        return JS_EXCEPTION;
+    }
+
+    sr->ctx = ctx;
+    sr->obj = JS_DupValue(ctx, obj);
+    sr->s = s;
+    sr->out_fd = out_fd;
+    sr->in_fd = in_fd;
+    sr->offset = offset;
+    sr->length = length;
+    sr->seek = seek;
+
+    JSValue promise = TJS_InitPromise(ctx, &sr->result);
+
+    if (s) {
+        s->sendfile.pending = true;
+        s->sendfile.req = sr;
+    }
+
+    tjs__sendfile_next(sr);
+
+    return promise;
+}
+
+static JSValue tjs_stream_sendfile(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    JSClassID class_id;
+    TJSStream *s = JS_GetAnyOpaque(this_val, &class_id);
+    if (!s) {
+        return JS_EXCEPTION;
+    }
+
+    /* arg 0: file descriptor */
+    int32_t in_fd;
+    if (JS_ToInt32(ctx, &in_fd, argv[0])) {
+        return JS_EXCEPTION;
+    }
+
+    /* arg 1: offset */
+    int64_t offset = 0;
+    if (!JS_IsUndefined(argv[1]) && JS_ToInt64(ctx, &offset, argv[1])) {
+        return JS_EXCEPTION;
+    }
+    if (offset < 0) {
+        return JS_ThrowRangeError(ctx, "offset must be a positive integer");
+    }
+
+    /* arg 2: length, until EOF if undefined */
+    int64_t length = -1;
+    if (!JS_IsUndefined(argv[2]) && JS_ToInt64(ctx, &length, argv[2])) {
+        return JS_EXCEPTION;
+    }
+    if (!JS_IsUndefined(argv[2]) && length < 0) {
+        return JS_ThrowRangeError(ctx, "length must be a positive integer");
+    }
+
+    if (s->sendfile.pending) {
+        return tjs_throw_errno(ctx, UV_EBUSY);
+    }
+
+    /* Data queued by previous writes must go out first. */
+    if (uv_stream_get_write_queue_size(&s->h.stream) > 0) {
+        return tjs_throw_errno(ctx, UV_EBUSY);
+    }
+
+    uv_os_fd_t out_fd;
+    int r = uv_fileno(&s->h.handle, &out_fd);
+    if (r != 0) {
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return tjs__sendfile_start(ctx, this_val, s, out_fd, in_fd, offset, length, false);
+}
+
 static JSValue tjs_init_stream(JSContext *ctx, JSValue obj, TJSStream *s) {
     s->ctx = ctx;
     s->h.handle.data = s;
@@ -434,6 +1510,9 @@ static JSValue tjs_init_stream(JSContext *ctx, JSValue obj, TJSStream *s) {
 
     TJS_ClearPromise(ctx, &s->read.result);
     TJS_ClearPromise(ctx, &s->accept.result);
+    TJS_ClearPromise(ctx, &s->flow.result);
+    TJS_ClearPromise(ctx, &s->cork.result);
+    TJS_ClearPromise(ctx, &s->drain.result);
 
     JS_SetOpaque(obj, s);
     return obj;
@@ -442,8 +1521,24 @@ static JSValue tjs_init_stream(JSContext *ctx, JSValue obj, TJSStream *s) {
 static void tjs_stream_finalizer(JSRuntime *rt, TJSStream *s) {
     if (s) {
         TJS_FreePromiseRT(rt, &s->accept.result);
+        for (size_t i = 0; i < s->accept.len; i++) {
+            JS_FreeValueRT(rt, s->accept.items[(s->accept.head + i) % s->accept.max]);
+        }
+        js_free_rt(rt, s->accept.items);
         TJS_FreePromiseRT(rt, &s->read.result);
         JS_FreeValueRT(rt, s->read.b.tarray);
+        TJS_FreePromiseRT(rt, &s->flow.result);
+        for (size_t i = 0; i < s->flow.chunks.len; i++) {
+            JS_FreeValueRT(rt, s->flow.chunks.items[i]);
+        }
+        js_free_rt(rt, s->flow.chunks.items);
+        js_free_rt(rt, s->flow.buf);
+        TJS_FreePromiseRT(rt, &s->cork.result);
+        for (size_t i = 0; i < s->cork.chunks.len; i++) {
+            JS_FreeValueRT(rt, s->cork.chunks.items[i]);
+        }
+        js_free_rt(rt, s->cork.chunks.items);
+        TJS_FreePromiseRT(rt, &s->drain.result);
         s->finalized = 1;
         if (s->closed) {
             js_free_rt(rt, s);
@@ -458,6 +1553,18 @@ static void tjs_stream_mark(JSRuntime *rt, TJSStream *s, JS_MarkFunc *mark_func)
         JS_MarkValue(rt, s->read.b.tarray, mark_func);
         TJS_MarkPromise(rt, &s->read.result, mark_func);
         TJS_MarkPromise(rt, &s->accept.result, mark_func);
+        for (size_t i = 0; i < s->accept.len; i++) {
+            JS_MarkValue(rt, s->accept.items[(s->accept.head + i) % s->accept.max], mark_func);
+        }
+        TJS_MarkPromise(rt, &s->flow.result, mark_func);
+        for (size_t i = 0; i < s->flow.chunks.len; i++) {
+            JS_MarkValue(rt, s->flow.chunks.items[i], mark_func);
+        }
+        TJS_MarkPromise(rt, &s->cork.result, mark_func);
+        for (size_t i = 0; i < s->cork.chunks.len; i++) {
+            JS_MarkValue(rt, s->cork.chunks.items[i], mark_func);
+        }
+        TJS_MarkPromise(rt, &s->drain.result, mark_func);
     }
 }
 
@@ -534,13 +1641,41 @@ static JSValue tjs_tcp_getsockpeername(JSContext *ctx, JSValue this_val, int arg
     } else {
         r = uv_tcp_getpeername(&t->h.tcp, (struct sockaddr *) &addr, &namelen);
     }
-    if (r != 0) {
-        return tjs_throw_errno(ctx, r);
+    if (r != 0) {
+        return tjs_throw_errno(ctx, r);
+    }
+
+    JSValue obj = JS_NewObjectProto(ctx, JS_NULL);
+    tjs_addr2obj(ctx, obj, (struct sockaddr *) &addr, false);
+    return obj;
+}
+
+/* Data given to the first write goes out with the SYN. The socket needs to exist before connecting
+ * for that, libuv would create it lazily otherwise. */
+static int tjs__tcp_set_fastopen_connect(TJSStream *t, int af) {
+#if defined(TCP_FASTOPEN_CONNECT)
+    uv_os_fd_t fd;
+    if (uv_fileno(&t->h.handle, &fd) != 0) {
+        fd = socket(af, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return -errno;
+        }
+        int r = uv_tcp_open(&t->h.tcp, fd);
+        if (r != 0) {
+            close(fd);
+            return r;
+        }
+    }
+
+    int on = 1;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &on, sizeof(on)) != 0) {
+        return -errno;
     }
 
-    JSValue obj = JS_NewObjectProto(ctx, JS_NULL);
-    tjs_addr2obj(ctx, obj, (struct sockaddr *) &addr, false);
-    return obj;
+    return 0;
+#else
+    return UV_ENOTSUP;
+#endif
 }
 
 static JSValue tjs_tcp_connect(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
@@ -556,6 +1691,17 @@ static JSValue tjs_tcp_connect(JSContext *ctx, JSValue this_val, int argc, JSVal
         return JS_EXCEPTION;
     }
 
+    int fast_open = JS_ToBool(ctx, argv[1]);
+    if (fast_open == -1) {
+        return JS_EXCEPTION;
+    }
+    if (fast_open) {
+        r = tjs__tcp_set_fastopen_connect(t, ss.ss_family);
+        if (r != 0) {
+            return tjs_throw_errno(ctx, r);
+        }
+    }
+
     TJSConnectReq *cr = js_malloc(ctx, sizeof(*cr));
     if (!cr) {
         return JS_EXCEPTION;
@@ -597,6 +1743,37 @@ static JSValue tjs_tcp_bind(JSContext *ctx, JSValue this_val, int argc, JSValue
     return JS_UNDEFINED;
 }
 
+/* Opens a duplicate of the given socket, so it can be shared with other threads (e.g. a listener
+ * handed over to workers) and closed independently. */
+static JSValue tjs_tcp_open(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSStream *t = tjs_tcp_get(ctx, this_val);
+    if (!t) {
+        return JS_EXCEPTION;
+    }
+
+    int fd;
+    if (JS_ToInt32(ctx, &fd, argv[0])) {
+        return JS_EXCEPTION;
+    }
+
+#if defined(_WIN32)
+    return tjs_throw_errno(ctx, UV_ENOTSUP);
+#else
+    int dupfd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (dupfd < 0) {
+        return tjs_throw_errno(ctx, -errno);
+    }
+
+    int r = uv_tcp_open(&t->h.tcp, dupfd);
+    if (r != 0) {
+        close(dupfd);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return JS_UNDEFINED;
+#endif
+}
+
 static JSValue tjs_tcp_keepalive(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
     TJSStream *t = tjs_tcp_get(ctx, this_val);
     if (!t) {
@@ -640,6 +1817,130 @@ static JSValue tjs_tcp_nodelay(JSContext *ctx, JSValue this_val, int argc, JSVal
     return JS_UNDEFINED;
 }
 
+enum {
+    TJS_TCP_OPT_FASTOPEN = 0,
+    TJS_TCP_OPT_DEFER_ACCEPT,
+    TJS_TCP_OPT_NOTSENT_LOWAT,
+    TJS_TCP_OPT_QUICKACK,
+    TJS_TCP_OPT_BUSY_POLL,
+};
+
+/* Platform specific tuning knobs, they all take an integer (or a boolean). */
+static JSValue tjs_tcp_setopt(JSContext *ctx, JSValue this_val, int argc, JSValue *argv, int magic) {
+    TJSStream *t = tjs_tcp_get(ctx, this_val);
+    if (!t) {
+        return JS_EXCEPTION;
+    }
+
+    int32_t value;
+    if (JS_IsBool(argv[0])) {
+        value = JS_ToBool(ctx, argv[0]);
+    } else if (JS_ToInt32(ctx, &value, argv[0])) {
+        return JS_EXCEPTION;
+    }
+
+#if defined(_WIN32)
+    return tjs_throw_errno(ctx, UV_ENOTSUP);
+#else
+    int level = -1;
+    int opt = -1;
+    switch (magic) {
+#if defined(TCP_FASTOPEN)
+        case TJS_TCP_OPT_FASTOPEN:
+            level = IPPROTO_TCP;
+            opt = TCP_FASTOPEN;
+            break;
+#endif
+#if defined(TCP_DEFER_ACCEPT)
+        case TJS_TCP_OPT_DEFER_ACCEPT:
+            level = IPPROTO_TCP;
+            opt = TCP_DEFER_ACCEPT;
+            break;
+#endif
+#if defined(TCP_NOTSENT_LOWAT)
+        case TJS_TCP_OPT_NOTSENT_LOWAT:
+            level = IPPROTO_TCP;
+            opt = TCP_NOTSENT_LOWAT;
+            break;
+#endif
+#if defined(TCP_QUICKACK)
+        case TJS_TCP_OPT_QUICKACK:
+            level = IPPROTO_TCP;
+            opt = TCP_QUICKACK;
+            break;
+#endif
+#if defined(SO_BUSY_POLL)
+        case TJS_TCP_OPT_BUSY_POLL:
+            level = SOL_SOCKET;
+            opt = SO_BUSY_POLL;
+            break;
+#endif
+        default:
+            break;
+    }
+
+    if (opt == -1) {
+        return tjs_throw_errno(ctx, UV_ENOTSUP);
+    }
+
+    uv_os_fd_t fd;
+    int r = uv_fileno(&t->h.handle, &fd);
+    if (r != 0) {
+        return tjs_throw_errno(ctx, r);
+    }
+
+    if (setsockopt(fd, level, opt, &value, sizeof(value)) != 0) {
+        return tjs_throw_errno(ctx, -errno);
+    }
+
+    return JS_UNDEFINED;
+#endif
+}
+
+static JSValue tjs_tcp_get_info(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSStream *t = tjs_tcp_get(ctx, this_val);
+    if (!t) {
+        return JS_EXCEPTION;
+    }
+
+#if defined(__linux__)
+    uv_os_fd_t fd;
+    int r = uv_fileno(&t->h.handle, &fd);
+    if (r != 0) {
+        return tjs_throw_errno(ctx, r);
+    }
+
+    struct tcp_info ti;
+    socklen_t len = sizeof(ti);
+    memset(&ti, 0, sizeof(ti));
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &ti, &len) != 0) {
+        return tjs_throw_errno(ctx, -errno);
+    }
+
+    JSValue obj = JS_NewObjectProto(ctx, JS_NULL);
+    if (JS_IsException(obj)) {
+        return obj;
+    }
+
+#define SET_INFO(name, field) JS_DefinePropertyValueStr(ctx, obj, name, JS_NewInt64(ctx, ti.field), JS_PROP_C_W_E)
+    SET_INFO("state", tcpi_state);
+    SET_INFO("rtt", tcpi_rtt);
+    SET_INFO("rttVar", tcpi_rttvar);
+    SET_INFO("cwnd", tcpi_snd_cwnd);
+    SET_INFO("ssthresh", tcpi_snd_ssthresh);
+    SET_INFO("mss", tcpi_snd_mss);
+    SET_INFO("retransmits", tcpi_retransmits);
+    SET_INFO("totalRetransmits", tcpi_total_retrans);
+    SET_INFO("unacked", tcpi_unacked);
+    SET_INFO("lost", tcpi_lost);
+#undef SET_INFO
+
+    return obj;
+#else
+    return tjs_throw_errno(ctx, UV_ENOTSUP);
+#endif
+}
+
 
 /* TTY */
 
@@ -898,26 +2199,498 @@ static JSValue tjs_pipe_open(JSContext *ctx, JSValue this_val, int argc, JSValue
     return JS_UNDEFINED;
 }
 
+
+/* Piping between handles */
+
+#define TJS__STREAM_PIPE_DEFAULT_HWM (256 * 1024)
+#define TJS__STREAM_PIPE_BUF_SIZE (64 * 1024)
+#define TJS__STREAM_PIPE_POOL_SIZE 16
+
+/* Moves data from a stream to another stream or a file inside the event loop. Reading stops while
+ * more than the high water mark is waiting to be written. */
+typedef struct TJSStreamPipe {
+    JSContext *ctx;
+    JSValue src_obj;
+    JSValue dst_obj;
+    TJSStream *src;
+    TJSStream *dst;
+    /* File destinations are written through a duplicate of the handle's descriptor, so closing the
+     * handle can't make the pipe write into a reused descriptor. */
+    uv_file dst_fd;
+    size_t hwm;
+    size_t inflight;
+    uint64_t total;
+    bool eof;
+    bool paused;
+    int error;
+    /* Spare read buffers. */
+    char *pool[TJS__STREAM_PIPE_POOL_SIZE];
+    int npool;
+    /* File destinations: data waiting for the current write, and the write itself. */
+    struct {
+        uv_buf_t *items;
+        size_t len;
+        size_t cap;
+    } queued;
+    struct {
+        uv_buf_t *items;
+        size_t len;
+        size_t cap;
+        size_t done;
+    } batch;
+    uv_fs_t fs_req;
+    bool fs_busy;
+    TJSPromise result;
+} TJSStreamPipe;
+
+typedef struct {
+    uv_write_t req;
+    TJSStreamPipe *p;
+    char *buf;
+    size_t len;
+} TJSStreamPipeWriteReq;
+
+static void tjs__stream_pipe_buf_release(TJSStreamPipe *p, char *buf) {
+    if (p->npool < TJS__STREAM_PIPE_POOL_SIZE) {
+        p->pool[p->npool++] = buf;
+    } else {
+        js_free(p->ctx, buf);
+    }
+}
+
+static void tjs__stream_pipe_close_fd(TJSStreamPipe *p) {
+#if !defined(_WIN32)
+    if (!p->dst) {
+        close(p->dst_fd);
+    }
+#endif
+}
+
+static void tjs__stream_pipe_maybe_settle(TJSStreamPipe *p) {
+    if (!(p->eof || p->error != 0) || p->inflight > 0 || p->fs_busy) {
+        return;
+    }
+
+    JSContext *ctx = p->ctx;
+
+    if (p->src->pipe == p) {
+        p->src->pipe = NULL;
+        if (!uv_is_closing(&p->src->h.handle)) {
+            uv_read_stop(&p->src->h.stream);
+        }
+    }
+
+    JSValue arg;
+    bool is_reject = p->error != 0;
+    if (is_reject) {
+        arg = tjs_new_error(ctx, p->error);
+    } else {
+        arg = JS_NewInt64(ctx, p->total);
+    }
+
+    TJS_SettlePromise(ctx, &p->result, is_reject, 1, &arg);
+
+    for (size_t i = 0; i < p->queued.len; i++) {
+        js_free(ctx, p->queued.items[i].base);
+    }
+    for (int i = 0; i < p->npool; i++) {
+        js_free(ctx, p->pool[i]);
+    }
+    js_free(ctx, p->queued.items);
+    js_free(ctx, p->batch.items);
+    tjs__stream_pipe_close_fd(p);
+    JS_FreeValue(ctx, p->src_obj);
+    JS_FreeValue(ctx, p->dst_obj);
+    js_free(ctx, p);
+}
+
+static void uv__stream_pipe_alloc_cb(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+    TJSStream *s = handle->data;
+    CHECK_NOT_NULL(s);
+    TJSStreamPipe *p = s->pipe;
+    CHECK_NOT_NULL(p);
+
+    char *base = p->npool > 0 ? p->pool[--p->npool] : js_malloc(p->ctx, TJS__STREAM_PIPE_BUF_SIZE);
+    buf->base = base;
+    buf->len = base ? TJS__STREAM_PIPE_BUF_SIZE : 0;
+}
+
+static void uv__stream_pipe_read_cb(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf);
+
+static void tjs__stream_pipe_stop(TJSStreamPipe *p, int error) {
+    if (error != 0 && p->error == 0) {
+        p->error = error;
+    }
+    if (!uv_is_closing(&p->src->h.handle)) {
+        uv_read_stop(&p->src->h.stream);
+    }
+}
+
+static void tjs__stream_pipe_maybe_resume(TJSStreamPipe *p) {
+    if (p->paused && !p->eof && p->error == 0 && p->inflight < p->hwm) {
+        p->paused = false;
+        int r = uv_read_start(&p->src->h.stream, uv__stream_pipe_alloc_cb, uv__stream_pipe_read_cb);
+        if (r != 0) {
+            p->error = r;
+        }
+    }
+}
+
+static void uv__stream_pipe_write_cb(uv_write_t *req, int status) {
+    TJSStreamPipeWriteReq *wr = req->data;
+    CHECK_NOT_NULL(wr);
+    TJSStreamPipe *p = wr->p;
+
+    tjs__stream_maybe_drain(req->handle->data);
+
+    p->inflight -= wr->len;
+    if (status < 0) {
+        tjs__stream_pipe_stop(p, status);
+    } else {
+        p->total += wr->len;
+    }
+
+    tjs__stream_pipe_buf_release(p, wr->buf);
+    js_free(p->ctx, wr);
+
+    tjs__stream_pipe_maybe_resume(p);
+    tjs__stream_pipe_maybe_settle(p);
+}
+
+static void tjs__stream_pipe_fs_submit(TJSStreamPipe *p);
+
+/* Nothing else will be written after an error. */
+static void tjs__stream_pipe_drop_queued(TJSStreamPipe *p) {
+    for (size_t i = 0; i < p->batch.len; i++) {
+        p->inflight -= p->batch.items[i].len;
+        tjs__stream_pipe_buf_release(p, p->batch.items[i].base);
+    }
+    p->batch.len = 0;
+    p->batch.done = 0;
+    for (size_t i = 0; i < p->queued.len; i++) {
+        p->inflight -= p->queued.items[i].len;
+        tjs__stream_pipe_buf_release(p, p->queued.items[i].base);
+    }
+    p->queued.len = 0;
+}
+
+static void uv__stream_pipe_fs_write_cb(uv_fs_t *req) {
+    TJSStreamPipe *p = req->data;
+    CHECK_NOT_NULL(p);
+
+    ssize_t r = req->result;
+    uv_fs_req_cleanup(req);
+    p->fs_busy = false;
+
+    if (r < 0) {
+        tjs__stream_pipe_stop(p, r);
+    } else {
+        p->batch.done += r;
+        p->total += r;
+    }
+
+    /* Release fully written buffers, a short write leaves the rest for the next one. */
+    size_t i = 0;
+    while (i < p->batch.len && p->batch.done >= p->batch.items[i].len) {
+        p->batch.done -= p->batch.items[i].len;
+        p->inflight -= p->batch.items[i].len;
+        tjs__stream_pipe_buf_release(p, p->batch.items[i].base);
+        i++;
+    }
+    memmove(p->batch.items, p->batch.items + i, (p->batch.len - i) * sizeof(*p->batch.items));
+    p->batch.len -= i;
+
+    if (p->error == 0) {
+        tjs__stream_pipe_fs_submit(p);
+        tjs__stream_pipe_maybe_resume(p);
+    } else {
+        tjs__stream_pipe_drop_queued(p);
+    }
+
+    tjs__stream_pipe_maybe_settle(p);
+}
+
+/* Writes the pending batch, or the queued buffers, to the file with a single writev. */
+static void tjs__stream_pipe_fs_submit(TJSStreamPipe *p) {
+    if (p->fs_busy) {
+        return;
+    }
+
+    if (p->batch.len == 0) {
+        if (p->queued.len == 0) {
+            return;
+        }
+        uv_buf_t *items = p->batch.items;
+        size_t cap = p->batch.cap;
+        p->batch.items = p->queued.items;
+        p->batch.cap = p->queued.cap;
+        p->batch.len = p->queued.len;
+        p->batch.done = 0;
+        p->queued.items = items;
+        p->queued.cap = cap;
+        p->queued.len = 0;
+    }
+
+    /* The pipe holds the file handle, but it can still be closed from JS. */
+    uv_file fd = -1;
+    tjs__file_fileno(p->dst_obj, &fd);
+    if (fd == -1) {
+        tjs__stream_pipe_stop(p, UV_EBADF);
+        tjs__stream_pipe_drop_queued(p);
+        return;
+    }
+
+    /* Skip what a short write already took care of. */
+    uv_buf_t first = p->batch.items[0];
+    uv_buf_t tmp = p->batch.items[0];
+    tmp.base += p->batch.done;
+    tmp.len -= p->batch.done;
+    p->batch.items[0] = tmp;
+
+    p->fs_req.data = p;
+    int r = uv_fs_write(tjs_get_loop(p->ctx), &p->fs_req, p->dst_fd, p->batch.items, p->batch.len, -1,
+                        uv__stream_pipe_fs_write_cb);
+    p->batch.items[0] = first;
+
+    if (r != 0) {
+        tjs__stream_pipe_stop(p, r);
+        tjs__stream_pipe_drop_queued(p);
+        return;
+    }
+
+    p->fs_busy = true;
+}
+
+static void uv__stream_pipe_read_cb(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf) {
+    TJSStream *s = handle->data;
+    CHECK_NOT_NULL(s);
+    TJSStreamPipe *p = s->pipe;
+    CHECK_NOT_NULL(p);
+    JSContext *ctx = p->ctx;
+
+    if (nread <= 0) {
+        if (buf->base) {
+            tjs__stream_pipe_buf_release(p, buf->base);
+        }
+        if (nread == UV_EOF) {
+            p->eof = true;
+            tjs__stream_pipe_stop(p, 0);
+        } else if (nread < 0) {
+            tjs__stream_pipe_stop(p, nread);
+        }
+        tjs__stream_pipe_maybe_settle(p);
+        return;
+    }
+
+    p->inflight += nread;
+
+    if (p->dst) {
+        TJSStreamPipeWriteReq *wr = js_malloc(ctx, sizeof(*wr));
+        if (!wr) {
+            p->inflight -= nread;
+            tjs__stream_pipe_buf_release(p, buf->base);
+            tjs__stream_pipe_stop(p, UV_ENOMEM);
+            tjs__stream_pipe_maybe_settle(p);
+            return;
+        }
+        wr->req.data = wr;
+        wr->p = p;
+        wr->buf = buf->base;
+        wr->len = nread;
+
+        uv_buf_t b = uv_buf_init(buf->base, nread);
+        int r = uv_write(&wr->req, &p->dst->h.stream, &b, 1, uv__stream_pipe_write_cb);
+        if (r != 0) {
+            p->inflight -= nread;
+            tjs__stream_pipe_buf_release(p, buf->base);
+            js_free(ctx, wr);
+            tjs__stream_pipe_stop(p, r);
+            tjs__stream_pipe_maybe_settle(p);
+            return;
+        }
+    } else {
+        if (p->queued.len == p->queued.cap) {
+            size_t cap = p->queued.cap ? p->queued.cap * 2 : 16;
+            uv_buf_t *items = js_realloc(ctx, p->queued.items, cap * sizeof(*items));
+            if (!items) {
+                p->inflight -= nread;
+                tjs__stream_pipe_buf_release(p, buf->base);
+                tjs__stream_pipe_stop(p, UV_ENOMEM);
+                tjs__stream_pipe_maybe_settle(p);
+                return;
+            }
+            p->queued.items = items;
+            p->queued.cap = cap;
+        }
+        p->queued.items[p->queued.len++] = uv_buf_init(buf->base, nread);
+        tjs__stream_pipe_fs_submit(p);
+    }
+
+    /* Back-pressure: wait for the destination to catch up. */
+    if (p->inflight >= p->hwm) {
+        uv_read_stop(handle);
+        p->paused = true;
+    }
+
+    tjs__stream_pipe_maybe_settle(p);
+}
+
+/* The source is being closed, libuv won't call the read callback anymore. */
+static void tjs__stream_pipe_cancel(TJSStream *s) {
+    TJSStreamPipe *p = s->pipe;
+    CHECK_NOT_NULL(p);
+
+    tjs__stream_pipe_stop(p, UV_ECANCELED);
+    tjs__stream_pipe_maybe_settle(p);
+}
+
+static TJSStream *tjs__stream_pipe_get_stream(JSValue obj) {
+    TJSStream *s = JS_GetOpaque(obj, tjs_tcp_class_id);
+    if (!s) {
+        s = JS_GetOpaque(obj, tjs_pipe_class_id);
+    }
+    if (!s) {
+        s = JS_GetOpaque(obj, tjs_tty_class_id);
+    }
+    return s;
+}
+
+/* Both ends can be a stream or a file handle. Streams are read from the event loop and
+ * written to with back-pressure, files are read from their current position and sent from the
+ * threadpool. A file destination fails the pipe once it's closed. */
+static JSValue tjs_stream_pipe(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSStream *src = NULL, *dst = NULL;
+    uv_file src_fd = -1, dst_fd = -1;
+
+    if (!(src = tjs__stream_pipe_get_stream(argv[0])) && !tjs__file_fileno(argv[0], &src_fd)) {
+        return JS_ThrowTypeError(ctx, "source must be a stream or a file handle");
+    }
+
+    if (!(dst = tjs__stream_pipe_get_stream(argv[1])) && !tjs__file_fileno(argv[1], &dst_fd)) {
+        return JS_ThrowTypeError(ctx, "destination must be a stream or a file handle");
+    }
+
+    if ((!src && src_fd == -1) || (!dst && dst_fd == -1)) {
+        return tjs_throw_errno(ctx, UV_EBADF);
+    }
+
+    int64_t hwm = TJS__STREAM_PIPE_DEFAULT_HWM;
+    if (!JS_IsUndefined(argv[2]) && JS_ToInt64(ctx, &hwm, argv[2])) {
+        return JS_EXCEPTION;
+    }
+    if (hwm < 1) {
+        return JS_ThrowRangeError(ctx, "highWaterMark must be positive");
+    }
+
+    if (!src) {
+#if defined(_WIN32)
+        return tjs_throw_errno(ctx, UV_ENOTSUP);
+#else
+        off_t offset = lseek(src_fd, 0, SEEK_CUR);
+        if (offset < 0) {
+            return tjs_throw_errno(ctx, -errno);
+        }
+
+        uv_os_fd_t out_fd = dst_fd;
+        if (dst) {
+            if (dst->sendfile.pending || uv_stream_get_write_queue_size(&dst->h.stream) > 0) {
+                return tjs_throw_errno(ctx, UV_EBUSY);
+            }
+            int r = uv_fileno(&dst->h.handle, &out_fd);
+            if (r != 0) {
+                return tjs_throw_errno(ctx, r);
+            }
+        }
+
+        return tjs__sendfile_start(ctx, dst ? argv[1] : JS_UNDEFINED, dst, out_fd, src_fd, offset, -1, true);
+#endif
+    }
+
+    if (src->flow.active || src->pipe || TJS_IsPromisePending(ctx, &src->read.result)) {
+        return tjs_throw_errno(ctx, UV_EBUSY);
+    }
+
+#if !defined(_WIN32)
+    if (!dst) {
+        dst_fd = fcntl(dst_fd, F_DUPFD_CLOEXEC, 0);
+        if (dst_fd < 0) {
+            return tjs_throw_errno(ctx, -errno);
+        }
+    }
+#endif
+
+    TJSStreamPipe *p = js_mallocz(ctx, sizeof(*p));
+    if (!p) {
+#if !defined(_WIN32)
+        if (!dst) {
+            close(dst_fd);
+        }
+#endif
+        return JS_EXCEPTION;
+    }
+
+    p->ctx = ctx;
+    p->src_obj = JS_DupValue(ctx, argv[0]);
+    p->dst_obj = JS_DupValue(ctx, argv[1]);
+    p->src = src;
+    p->dst = dst;
+    p->dst_fd = dst_fd;
+    p->hwm = hwm;
+    TJS_ClearPromise(ctx, &p->result);
+
+    src->pipe = p;
+
+    int r = uv_read_start(&src->h.stream, uv__stream_pipe_alloc_cb, uv__stream_pipe_read_cb);
+    if (r != 0) {
+        src->pipe = NULL;
+        tjs__stream_pipe_close_fd(p);
+        JS_FreeValue(ctx, p->src_obj);
+        JS_FreeValue(ctx, p->dst_obj);
+        js_free(ctx, p);
+        return tjs_throw_errno(ctx, r);
+    }
+
+    return TJS_InitPromise(ctx, &p->result);
+}
+
 /* clang-format off */
 static const JSCFunctionListEntry tjs_stream_proto_funcs[] = {
-    TJS_CFUNC_DEF("listen", 1, tjs_stream_listen),
+    TJS_CFUNC_DEF("listen", 2, tjs_stream_listen),
     TJS_CFUNC_DEF("accept", 0, tjs_stream_accept),
+    TJS_CFUNC_DEF("acceptQueued", 0, tjs_stream_accept_queued),
     TJS_CFUNC_DEF("shutdown", 0, tjs_stream_shutdown),
     TJS_CFUNC_DEF("setBlocking", 1, tjs_stream_set_blocking),
+    JS_CFUNC_MAGIC_DEF("sendBufferSize", 1, tjs_stream_buffer_size, 0),
+    JS_CFUNC_MAGIC_DEF("recvBufferSize", 1, tjs_stream_buffer_size, 1),
     TJS_CFUNC_DEF("close", 0, tjs_stream_close),
     TJS_CFUNC_DEF("read", 1, tjs_stream_read),
+    TJS_CFUNC_DEF("readStart", 1, tjs_stream_read_start),
+    TJS_CFUNC_DEF("readChunks", 0, tjs_stream_read_chunks),
     TJS_CFUNC_DEF("write", 1, tjs_stream_write),
+    TJS_CFUNC_DEF("writev", 1, tjs_stream_writev),
+    TJS_CFUNC_DEF("cork", 1, tjs_stream_cork),
+    TJS_CFUNC_DEF("uncork", 0, tjs_stream_uncork),
+    TJS_CFUNC_DEF("writeQueueSize", 0, tjs_stream_write_queue_size),
+    TJS_CFUNC_DEF("drain", 1, tjs_stream_drain),
     TJS_CFUNC_DEF("fileno", 0, tjs_stream_fileno),
+    TJS_CFUNC_DEF("sendFile", 3, tjs_stream_sendfile),
 };
 /* clang-format on */
 
 static const JSCFunctionListEntry tjs_tcp_proto_funcs[] = {
     JS_CFUNC_MAGIC_DEF("getsockname", 0, tjs_tcp_getsockpeername, 0),
     JS_CFUNC_MAGIC_DEF("getpeername", 0, tjs_tcp_getsockpeername, 1),
-    TJS_CFUNC_DEF("connect", 1, tjs_tcp_connect),
+    TJS_CFUNC_DEF("connect", 2, tjs_tcp_connect),
     TJS_CFUNC_DEF("bind", 2, tjs_tcp_bind),
+    TJS_CFUNC_DEF("open", 1, tjs_tcp_open),
     TJS_CFUNC_DEF("setKeepAlive", 2, tjs_tcp_keepalive),
     TJS_CFUNC_DEF("setNoDelay", 1, tjs_tcp_nodelay),
+    JS_CFUNC_MAGIC_DEF("setFastOpen", 1, tjs_tcp_setopt, TJS_TCP_OPT_FASTOPEN),
+    JS_CFUNC_MAGIC_DEF("setDeferAccept", 1, tjs_tcp_setopt, TJS_TCP_OPT_DEFER_ACCEPT),
+    JS_CFUNC_MAGIC_DEF("setNotSentLowat", 1, tjs_tcp_setopt, TJS_TCP_OPT_NOTSENT_LOWAT),
+    JS_CFUNC_MAGIC_DEF("setQuickAck", 1, tjs_tcp_setopt, TJS_TCP_OPT_QUICKACK),
+    JS_CFUNC_MAGIC_DEF("setBusyPoll", 1, tjs_tcp_setopt, TJS_TCP_OPT_BUSY_POLL),
+    TJS_CFUNC_DEF("getInfo", 0, tjs_tcp_get_info),
 };
 
 static const JSCFunctionListEntry tjs_tty_proto_funcs[] = {
@@ -934,7 +2707,9 @@ static const JSCFunctionListEntry tjs_pipe_proto_funcs[] = {
 };
 
 static const JSCFunctionListEntry tjs_streams_funcs[] = {
+    TJS_CFUNC_DEF("pipe", 3, tjs_stream_pipe),
     TJS_UVCONST(TCP_IPV6ONLY),
+    TJS_UVCONST(TCP_REUSEPORT),
     TJS_UVCONST(TTY_MODE_NORMAL),
     TJS_UVCONST(TTY_MODE_RAW),
 };
@@ -22,26 +22,73 @@
  * THE SOFTWARE.
  */
 
+/* For sendmmsg. */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "mem.h"
 #include "private.h"
 #include "utils.h"
 
 #include <string.h>
+#if defined(__linux__) || defined(__FreeBSD__)
+#include <errno.h>
+#include <sys/socket.h>
+#endif
+#if defined(__linux__)
+#include <fcntl.h>
+#include <netinet/udp.h>
+#include <unistd.h>
+#endif
 
+/* libuv hands every datagram read with recvmmsg its own chunk of this size, and reads at most this many at once. */
+#define TJS__UDP_DGRAM_MAXSIZE (64 * 1024)
+#define TJS__UDP_MMSG_MAXWIDTH 20
+
+/* Kernel limits for a single GSO send: segments per datagram, and the largest IPv4 UDP payload. */
+#define TJS__UDP_GSO_MAXSEGS 64
+#define TJS__UDP_GSO_MAXSIZE 65507
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} TJSUdpRecvBuf;
 
 typedef struct {
     JSContext *ctx;
     int closed;
     int finalized;
+    int pending_close;
     uv_udp_t udp;
+    uint32_t gso_size;
+    /* Datagrams go straight into the caller's buffers, or are copied there from the slab when libuv uses recvmmsg. */
     struct {
-        struct {
-            JSValue tarray;
-            uint8_t *data;
-            size_t len;
-        } b;
+        JSValue buffers;
+        TJSUdpRecvBuf *bufs;
+        uint32_t nbufs;
+        uint32_t count;
+        bool single;
+        JSValue results;
         TJSPromise result;
     } read;
+    struct {
+        char *data;
+        size_t len;
+    } slab;
+    /* libuv can't tell us the segment size of coalesced datagrams, so with GRO on they're read with recvmsg on a
+     * duplicate of the socket, which libuv doesn't otherwise watch. Segments that didn't fit in the caller's buffers
+     * stay in the slab, between off and end, until the next read. */
+    struct {
+        bool enabled;
+        bool started;
+        int fd;
+        uv_poll_t poll;
+        struct sockaddr_storage addr;
+        size_t off;
+        size_t end;
+        size_t seg;
+    } gro;
 } TJSUdp;
 
 typedef struct {
@@ -50,11 +97,31 @@ typedef struct {
     JSValue tarray;
 } TJSSendReq;
 
+/* Messages that couldn't be sent with sendmmsg right away are queued individually. */
+typedef struct {
+    JSContext *ctx;
+    JSValue holder;
+    JSValue sizes;
+    uint32_t pending;
+    uint32_t sent;
+    int error;
+    uv_udp_send_t *reqs;
+    TJSPromise result;
+} TJSSendBatch;
+
 static JSClassID tjs_udp_class_id;
 
 static void uv__udp_close_cb(uv_handle_t *handle) {
     TJSUdp *u = handle->data;
     CHECK_NOT_NULL(u);
+    if (--u->pending_close > 0) {
+        return;
+    }
+#if defined(__linux__)
+    if (u->gro.fd != -1) {
+        close(u->gro.fd);
+    }
+#endif
     u->closed = 1;
     if (u->finalized) {
         tjs__free(u);
@@ -63,6 +130,10 @@ static void uv__udp_close_cb(uv_handle_t *handle) {
 
 static void maybe_close(TJSUdp *u) {
     if (!uv_is_closing((uv_handle_t *) &u->udp)) {
+        u->pending_close = u->gro.started ? 2 : 1;
+        if (u->gro.started) {
+            uv_close((uv_handle_t *) &u->gro.poll, uv__udp_close_cb);
+        }
         uv_close((uv_handle_t *) &u->udp, uv__udp_close_cb);
     }
 }
@@ -71,7 +142,10 @@ static void tjs_udp_finalizer(JSRuntime *rt, JSValue val) {
     TJSUdp *u = JS_GetOpaque(val, tjs_udp_class_id);
     if (u) {
         TJS_FreePromiseRT(rt, &u->read.result);
-        JS_FreeValueRT(rt, u->read.b.tarray);
+        JS_FreeValueRT(rt, u->read.buffers);
+        JS_FreeValueRT(rt, u->read.results);
+        js_free_rt(rt, u->read.bufs);
+        js_free_rt(rt, u->slab.data);
         u->finalized = 1;
         if (u->closed) {
             tjs__free(u);
@@ -85,7 +159,8 @@ static void tjs_udp_mark(JSRuntime *rt, JSValue val, JS_MarkFunc *mark_func) {
     TJSUdp *u = JS_GetOpaque(val, tjs_udp_class_id);
     if (u) {
         TJS_MarkPromise(rt, &u->read.result, mark_func);
-        JS_MarkValue(rt, u->read.b.tarray, mark_func);
+        JS_MarkValue(rt, u->read.buffers, mark_func);
+        JS_MarkValue(rt, u->read.results, mark_func);
     }
 }
 
@@ -99,26 +174,216 @@ static TJSUdp *tjs_udp_get(JSContext *ctx, JSValue obj) {
     return JS_GetOpaque2(ctx, obj, tjs_udp_class_id);
 }
 
+static void tjs__udp_read_reset(TJSUdp *u) {
+    JSContext *ctx = u->ctx;
+    JS_FreeValue(ctx, u->read.buffers);
+    JS_FreeValue(ctx, u->read.results);
+    js_free(ctx, u->read.bufs);
+    u->read.buffers = JS_UNDEFINED;
+    u->read.results = JS_UNDEFINED;
+    u->read.bufs = NULL;
+    u->read.nbufs = 0;
+    u->read.count = 0;
+    u->read.single = false;
+}
+
+/* Settles with what has been received so far, errors are only reported when nothing was. */
+static void tjs__udp_read_settle(TJSUdp *u, int error) {
+    JSContext *ctx = u->ctx;
+
+    uv_udp_recv_stop(&u->udp);
+    if (u->gro.started) {
+        uv_poll_stop(&u->gro.poll);
+    }
+
+    JSValue arg;
+    bool is_reject = false;
+    if (u->read.count == 0 && error < 0) {
+        arg = tjs_new_error(ctx, error);
+        is_reject = true;
+    } else if (u->read.single) {
+        arg = JS_GetPropertyUint32(ctx, u->read.results, 0);
+    } else {
+        arg = JS_DupValue(ctx, u->read.results);
+    }
+
+    TJS_SettlePromise(ctx, &u->read.result, is_reject, 1, &arg);
+    TJS_ClearPromise(ctx, &u->read.result);
+    tjs__udp_read_reset(u);
+}
+
 static JSValue tjs_udp_close(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
     TJSUdp *u = tjs_udp_get(ctx, this_val);
     if (!u) {
         return JS_EXCEPTION;
     }
     if (TJS_IsPromisePending(ctx, &u->read.result)) {
-        JSValue arg = JS_NewObjectProto(ctx, JS_NULL);
-        JS_DefinePropertyValueStr(ctx, arg, "nread", JS_NULL, JS_PROP_C_W_E);
+        JSValue arg;
+        if (u->read.single) {
+            arg = JS_NewObjectProto(ctx, JS_NULL);
+            JS_DefinePropertyValueStr(ctx, arg, "nread", JS_NULL, JS_PROP_C_W_E);
+        } else {
+            arg = JS_NULL;
+        }
         TJS_SettlePromise(ctx, &u->read.result, false, 1, &arg);
         TJS_ClearPromise(ctx, &u->read.result);
+        tjs__udp_read_reset(u);
     }
     maybe_close(u);
     return JS_UNDEFINED;
 }
 
+static int tjs__udp_slab_reserve(TJSUdp *u, size_t len) {
+    if (u->slab.len < len) {
+        char *data = js_realloc(u->ctx, u->slab.data, len);
+        if (!data) {
+            return UV_ENOMEM;
+        }
+        u->slab.data = data;
+        u->slab.len = len;
+    }
+
+    return 0;
+}
+
+/* Adds the entry for a datagram that is already in the next buffer, returns true if that settled the read. */
+static bool tjs__udp_read_push(TJSUdp *u, ssize_t nread, bool partial, const struct sockaddr *addr) {
+    JSContext *ctx = u->ctx;
+
+    JSValue obj = JS_NewObjectProto(ctx, JS_NULL);
+    JS_DefinePropertyValueStr(ctx, obj, "nread", JS_NewInt32(ctx, nread), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "partial", JS_NewBool(ctx, partial), JS_PROP_C_W_E);
+    JSValue addrobj = JS_NewObjectProto(ctx, JS_NULL);
+    tjs_addr2obj(ctx, addrobj, addr, false);
+    JS_DefinePropertyValueStr(ctx, obj, "addr", addrobj, JS_PROP_C_W_E);
+    JS_DefinePropertyValueUint32(ctx, u->read.results, u->read.count, obj, JS_PROP_C_W_E);
+
+    if (++u->read.count == u->read.nbufs) {
+        tjs__udp_read_settle(u, 0);
+        return true;
+    }
+
+    return false;
+}
+
+/* Hands out the segments left from a coalesced datagram, returns true if that settled the read. */
+static bool tjs__udp_gro_deliver(TJSUdp *u) {
+    while (u->gro.off < u->gro.end) {
+        TJSUdpRecvBuf *b = &u->read.bufs[u->read.count];
+        size_t len = u->gro.end - u->gro.off;
+        if (len > u->gro.seg) {
+            len = u->gro.seg;
+        }
+        size_t n = len > b->len ? b->len : len;
+        memcpy(b->data, u->slab.data + u->gro.off, n);
+        u->gro.off += len;
+        if (tjs__udp_read_push(u, n, n < len, (struct sockaddr *) &u->gro.addr)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#if defined(UDP_GRO)
+static void uv__udp_gro_poll_cb(uv_poll_t *handle, int status, int events) {
+    TJSUdp *u = handle->data;
+    CHECK_NOT_NULL(u);
+
+    if (status < 0) {
+        tjs__udp_read_settle(u, status);
+        return;
+    }
+
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    /* Drain the socket until the buffers are full or it would block. */
+    for (;;) {
+        struct iovec iov = {
+            .iov_base = u->slab.data,
+            .iov_len = TJS__UDP_DGRAM_MAXSIZE,
+        };
+        struct msghdr h = {
+            .msg_name = &u->gro.addr,
+            .msg_namelen = sizeof(u->gro.addr),
+            .msg_iov = &iov,
+            .msg_iovlen = 1,
+            .msg_control = control.buf,
+            .msg_controllen = sizeof(control.buf),
+        };
+
+        ssize_t n;
+        do {
+            n = recvmsg(u->gro.fd, &h, 0);
+        } while (n == -1 && errno == EINTR);
+
+        if (n == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (u->read.count > 0) {
+                    tjs__udp_read_settle(u, 0);
+                }
+            } else {
+                tjs__udp_read_settle(u, -errno);
+            }
+            return;
+        }
+
+        if (n == 0) {
+            if (tjs__udp_read_push(u, 0, false, (struct sockaddr *) &u->gro.addr)) {
+                return;
+            }
+            continue;
+        }
+
+        /* Without the control message this is a single datagram. */
+        int seg = 0;
+        for (struct cmsghdr *c = CMSG_FIRSTHDR(&h); c != NULL; c = CMSG_NXTHDR(&h, c)) {
+            if (c->cmsg_level == IPPROTO_UDP && c->cmsg_type == UDP_GRO) {
+                memcpy(&seg, CMSG_DATA(c), sizeof(seg));
+            }
+        }
+
+        u->gro.off = 0;
+        u->gro.end = n;
+        u->gro.seg = seg > 0 ? (size_t) seg : (size_t) n;
+
+        if (tjs__udp_gro_deliver(u)) {
+            return;
+        }
+    }
+}
+#endif
+
 static void uv__udp_alloc_cb(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
     TJSUdp *u = handle->data;
     CHECK_NOT_NULL(u);
-    buf->base = (char *) u->read.b.data;
-    buf->len = u->read.b.len;
+    CHECK(u->read.count < u->read.nbufs);
+
+    if (!uv_udp_using_recvmmsg(&u->udp)) {
+        TJSUdpRecvBuf *b = &u->read.bufs[u->read.count];
+        buf->base = (char *) b->data;
+        buf->len = b->len;
+        return;
+    }
+
+    /* Datagrams that don't fit in the caller's buffers would be lost, so only ask for as many as there is room for. */
+    size_t chunks = u->read.nbufs - u->read.count;
+    if (chunks > TJS__UDP_MMSG_MAXWIDTH) {
+        chunks = TJS__UDP_MMSG_MAXWIDTH;
+    }
+    size_t len = chunks * TJS__UDP_DGRAM_MAXSIZE;
+
+    if (tjs__udp_slab_reserve(u, len) != 0) {
+        buf->base = NULL;
+        buf->len = 0;
+        return;
+    }
+
+    buf->base = u->slab.data;
+    buf->len = len;
 }
 
 static void uv__udp_recv_cb(uv_udp_t *handle,
@@ -129,62 +394,123 @@ static void uv__udp_recv_cb(uv_udp_t *handle,
     TJSUdp *u = handle->data;
     CHECK_NOT_NULL(u);
 
-    uv_udp_recv_stop(handle);
+    /* The slab is kept for the next time. */
+    if (flags & UV_UDP_MMSG_FREE) {
+        return;
+    }
 
-    JSContext *ctx = u->ctx;
-    JSValue arg;
-    int is_reject = 0;
     if (nread < 0) {
-        arg = tjs_new_error(ctx, nread);
-        is_reject = 1;
-    } else {
-        arg = JS_NewObjectProto(ctx, JS_NULL);
-        JS_DefinePropertyValueStr(ctx, arg, "nread", JS_NewInt32(ctx, nread), JS_PROP_C_W_E);
-        JS_DefinePropertyValueStr(ctx, arg, "partial", JS_NewBool(ctx, flags & UV_UDP_PARTIAL), JS_PROP_C_W_E);
-        JSValue addrobj = JS_NewObjectProto(ctx, JS_NULL);
-        tjs_addr2obj(ctx, addrobj, addr, false);
-        JS_DefinePropertyValueStr(ctx, arg, "addr", addrobj, JS_PROP_C_W_E);
+        tjs__udp_read_settle(u, nread);
+        return;
     }
 
-    TJS_SettlePromise(ctx, &u->read.result, is_reject, 1, &arg);
-    TJS_ClearPromise(ctx, &u->read.result);
+    /* Nothing else to read for now. */
+    if (nread == 0 && addr == NULL) {
+        if (u->read.count > 0) {
+            tjs__udp_read_settle(u, 0);
+        }
+        return;
+    }
+
+    TJSUdpRecvBuf *b = &u->read.bufs[u->read.count];
+    bool partial = flags & UV_UDP_PARTIAL;
+    if (flags & UV_UDP_MMSG_CHUNK) {
+        if ((size_t) nread > b->len) {
+            nread = b->len;
+            partial = true;
+        }
+        memcpy(b->data, buf->base, nread);
+    }
 
-    JS_FreeValue(ctx, u->read.b.tarray);
-    u->read.b.tarray = JS_UNDEFINED;
-    u->read.b.data = NULL;
-    u->read.b.len = 0;
+    tjs__udp_read_push(u, nread, partial, addr);
 }
 
-static JSValue tjs_udp_recv(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
-    TJSUdp *u = tjs_udp_get(ctx, this_val);
-    if (!u) {
-        return JS_EXCEPTION;
+static int tjs__udp_read_start(TJSUdp *u) {
+#if defined(UDP_GRO)
+    if (u->gro.enabled) {
+        return uv_poll_start(&u->gro.poll, UV_READABLE, uv__udp_gro_poll_cb);
     }
+#endif
+
+    return uv_udp_recv_start(&u->udp, uv__udp_alloc_cb, uv__udp_recv_cb);
+}
 
+static JSValue tjs__udp_recv_start(JSContext *ctx, TJSUdp *u, JSValue buffers, bool single) {
     if (TJS_IsPromisePending(ctx, &u->read.result)) {
         return tjs_throw_errno(ctx, UV_EBUSY);
     }
 
-    size_t size;
-    uint8_t *buf = JS_GetUint8Array(ctx, &size, argv[0]);
-    if (!buf) {
+    uint32_t nbufs = 1;
+    if (!single) {
+        int64_t len;
+        if (!JS_IsArray(ctx, buffers) || JS_GetLength(ctx, buffers, &len)) {
+            return JS_ThrowTypeError(ctx, "expected an array of Uint8Arrays");
+        }
+        if (len < 1 || len > UINT32_MAX) {
+            return JS_ThrowRangeError(ctx, "at least one buffer is needed");
+        }
+        nbufs = len;
+    }
+
+    TJSUdpRecvBuf *bufs = js_malloc(ctx, nbufs * sizeof(*bufs));
+    if (!bufs) {
         return JS_EXCEPTION;
     }
-    u->read.b.tarray = JS_DupValue(ctx, argv[0]);
-    u->read.b.data = buf;
-    u->read.b.len = size;
 
-    int r = uv_udp_recv_start(&u->udp, uv__udp_alloc_cb, uv__udp_recv_cb);
-    if (r != 0) {
-        JS_FreeValue(ctx, u->read.b.tarray);
-        u->read.b.tarray = JS_UNDEFINED;
-        u->read.b.data = NULL;
-        u->read.b.len = 0;
+    for (uint32_t i = 0; i < nbufs; i++) {
+        JSValue v = single ? JS_DupValue(ctx, buffers) : JS_GetPropertyUint32(ctx, buffers, i);
+        bufs[i].data = JS_GetUint8Array(ctx, &bufs[i].len, v);
+        JS_FreeValue(ctx, v);
+        if (!bufs[i].data) {
+            js_free(ctx, bufs);
+            return JS_EXCEPTION;
+        }
+    }
 
+    JSValue results = JS_NewArray(ctx);
+    if (JS_IsException(results)) {
+        js_free(ctx, bufs);
+        return results;
+    }
+
+    u->read.buffers = JS_DupValue(ctx, buffers);
+    u->read.bufs = bufs;
+    u->read.nbufs = nbufs;
+    u->read.count = 0;
+    u->read.single = single;
+    u->read.results = results;
+
+    int r = tjs__udp_read_start(u);
+    if (r != 0) {
+        tjs__udp_read_reset(u);
         return tjs_throw_errno(ctx, r);
     }
 
-    return TJS_InitPromise(ctx, &u->read.result);
+    JSValue promise = TJS_InitPromise(ctx, &u->read.result);
+
+    /* Segments left over from the last read go first, reading stops again if they fill the buffers. */
+    tjs__udp_gro_deliver(u);
+
+    return promise;
+}
+
+static JSValue tjs_udp_recv(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSUdp *u = tjs_udp_get(ctx, this_val);
+    if (!u) {
+        return JS_EXCEPTION;
+    }
+
+    return tjs__udp_recv_start(ctx, u, argv[0], true);
+}
+
+/* Fills as many of the given buffers as there are datagrams ready, resolving with an entry for each one. */
+static JSValue tjs_udp_recv_batch(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSUdp *u = tjs_udp_get(ctx, this_val);
+    if (!u) {
+        return JS_EXCEPTION;
+    }
+
+    return tjs__udp_recv_start(ctx, u, argv[0], false);
 }
 
 static void uv__udp_send_cb(uv_udp_send_t *req, int status) {
@@ -267,6 +593,240 @@ static JSValue tjs_udp_send(JSContext *ctx, JSValue this_val, int argc, JSValue
     return TJS_InitPromise(ctx, &sr->result);
 }
 
+/* Failed batches reject with the amount of messages which did get sent, as `sent`. */
+static JSValue tjs__udp_send_batch_error(JSContext *ctx, int err, uint32_t sent) {
+    JSValue error = tjs_new_error(ctx, err);
+    JS_DefinePropertyValueStr(ctx, error, "sent", JS_NewUint32(ctx, sent), JS_PROP_C_W_E);
+    return error;
+}
+
+static void tjs__udp_send_batch_settle(TJSSendBatch *sb) {
+    JSContext *ctx = sb->ctx;
+    JSValue arg;
+    bool is_reject = sb->error != 0;
+    if (is_reject) {
+        arg = tjs__udp_send_batch_error(ctx, sb->error, sb->sent);
+    } else {
+        arg = JS_DupValue(ctx, sb->sizes);
+    }
+
+    TJS_SettlePromise(ctx, &sb->result, is_reject, 1, &arg);
+    JS_FreeValue(ctx, sb->holder);
+    JS_FreeValue(ctx, sb->sizes);
+    js_free(ctx, sb->reqs);
+    js_free(ctx, sb);
+}
+
+static void uv__udp_send_batch_cb(uv_udp_send_t *req, int status) {
+    TJSSendBatch *sb = req->data;
+    CHECK_NOT_NULL(sb);
+
+    if (status < 0) {
+        if (sb->error == 0) {
+            sb->error = status;
+        }
+    } else {
+        sb->sent++;
+    }
+
+    if (--sb->pending == 0) {
+        tjs__udp_send_batch_settle(sb);
+    }
+}
+
+static socklen_t tjs__udp_addrlen(const struct sockaddr_storage *ss) {
+    return ss->ss_family == AF_INET6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+}
+
+/* With a segment size set, consecutive messages of exactly that size to the same address go out as one datagram which
+ * the kernel splits up again, the last one may be shorter. Returns how many messages start at i. */
+static uint32_t tjs__udp_gso_span(TJSUdp *u,
+                                  const uv_buf_t *bufs,
+                                  const struct sockaddr_storage *addrs,
+                                  const bool *has_addr,
+                                  uint32_t i,
+                                  uint32_t n) {
+    if (u->gso_size == 0 || bufs[i].len != u->gso_size) {
+        return 1;
+    }
+
+    size_t total = bufs[i].len;
+    uint32_t span = 1;
+    for (uint32_t j = i + 1; j < n && span < TJS__UDP_GSO_MAXSEGS; j++) {
+        size_t len = bufs[j].len;
+        if (len == 0 || len > u->gso_size || total + len > TJS__UDP_GSO_MAXSIZE) {
+            break;
+        }
+        if (has_addr[j] != has_addr[i] ||
+            (has_addr[i] && memcmp(&addrs[i], &addrs[j], tjs__udp_addrlen(&addrs[i])) != 0)) {
+            break;
+        }
+        total += len;
+        span++;
+        if (len < u->gso_size) {
+            break;
+        }
+    }
+
+    return span;
+}
+
+/* Sends [{ data, addr }, ...] with as few syscalls as possible: sendmmsg where available, falling back to libuv's
+ * send queue for whatever doesn't go out right away. Resolves with the size of each message. */
+static JSValue tjs_udp_send_batch(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSUdp *u = tjs_udp_get(ctx, this_val);
+    if (!u) {
+        return JS_EXCEPTION;
+    }
+
+    int64_t len;
+    if (!JS_IsArray(ctx, argv[0]) || JS_GetLength(ctx, argv[0], &len)) {
+        return JS_ThrowTypeError(ctx, "expected an array of messages");
+    }
+    if (len > UINT32_MAX) {
+        return JS_ThrowRangeError(ctx, "too many messages");
+    }
+
+    uint32_t n = len;
+    uv_buf_t *bufs = js_malloc(ctx, (n ? n : 1) * sizeof(*bufs));
+    struct sockaddr_storage *addrs = js_malloc(ctx, (n ? n : 1) * sizeof(*addrs));
+    bool *has_addr = js_mallocz(ctx, (n ? n : 1) * sizeof(*has_addr));
+    JSValue holder = JS_NewArray(ctx);
+    JSValue sizes = JS_NewArray(ctx);
+    JSValue ret = JS_EXCEPTION;
+    if (!bufs || !addrs || !has_addr || JS_IsException(holder) || JS_IsException(sizes)) {
+        goto end;
+    }
+
+    /* Addresses are checked before anything is sent, so these can't fail halfway through. */
+    struct sockaddr_storage peer;
+    int peer_len = sizeof(peer);
+    bool connected = uv_udp_getpeername(&u->udp, (struct sockaddr *) &peer, &peer_len) == 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        JSValue msg = JS_GetPropertyUint32(ctx, argv[0], i);
+        JSValue data = JS_GetPropertyStr(ctx, msg, "data");
+        JSValue addr = JS_GetPropertyStr(ctx, msg, "addr");
+        JS_FreeValue(ctx, msg);
+
+        size_t size;
+        uint8_t *buf = JS_GetUint8Array(ctx, &size, data);
+        if (!buf) {
+            JS_FreeValue(ctx, data);
+            JS_FreeValue(ctx, addr);
+            goto end;
+        }
+        bufs[i] = uv_buf_init((char *) buf, size);
+        JS_DefinePropertyValueUint32(ctx, holder, i, data, JS_PROP_C_W_E);
+        JS_DefinePropertyValueUint32(ctx, sizes, i, JS_NewInt64(ctx, size), JS_PROP_C_W_E);
+
+        if (JS_IsUndefined(addr) == !connected) {
+            JS_FreeValue(ctx, addr);
+            ret = tjs_throw_errno(ctx, connected ? UV_EISCONN : UV_EDESTADDRREQ);
+            goto end;
+        }
+        if (!JS_IsUndefined(addr)) {
+            int r = tjs_obj2addr(ctx, addr, &addrs[i]);
+            JS_FreeValue(ctx, addr);
+            if (r != 0) {
+                goto end;
+            }
+            has_addr[i] = true;
+        }
+    }
+
+    uint32_t sent = 0;
+
+#if defined(__linux__) || defined(__FreeBSD__)
+    /* Going around libuv is only safe when nothing is queued there, or the order would change. */
+    uv_os_fd_t fd;
+    if (n > 0 && uv_udp_get_send_queue_count(&u->udp) == 0 && uv_fileno((uv_handle_t *) &u->udp, &fd) == 0) {
+        struct mmsghdr msgs[TJS__UDP_MMSG_MAXWIDTH];
+        uint32_t spans[TJS__UDP_MMSG_MAXWIDTH];
+        while (sent < n) {
+            uint32_t count = 0;
+            memset(msgs, 0, sizeof(msgs));
+            for (uint32_t i = sent; i < n && count < TJS__UDP_MMSG_MAXWIDTH; i += spans[count++]) {
+                struct msghdr *h = &msgs[count].msg_hdr;
+                spans[count] = tjs__udp_gso_span(u, bufs, addrs, has_addr, i, n);
+                h->msg_iov = (struct iovec *) &bufs[i];
+                h->msg_iovlen = spans[count];
+                if (has_addr[i]) {
+                    h->msg_name = &addrs[i];
+                    h->msg_namelen = tjs__udp_addrlen(&addrs[i]);
+                }
+            }
+
+            int r;
+            do {
+                r = sendmmsg(fd, msgs, count, 0);
+            } while (r == -1 && errno == EINTR);
+
+            if (r == -1) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                    break;
+                }
+                /* Part of the batch may be out already, so this is reported like a failed queued send. */
+                JSValue error = tjs__udp_send_batch_error(ctx, -errno, sent);
+                ret = TJS_NewRejectedPromise(ctx, 1, &error);
+                goto end;
+            }
+            for (int i = 0; i < r; i++) {
+                sent += spans[i];
+            }
+        }
+    }
+#endif
+
+    if (sent == n) {
+        ret = TJS_NewResolvedPromise(ctx, 1, &sizes);
+        sizes = JS_UNDEFINED;
+        goto end;
+    }
+
+    TJSSendBatch *sb = js_mallocz(ctx, sizeof(*sb));
+    if (!sb) {
+        goto end;
+    }
+    sb->reqs = js_malloc(ctx, (n - sent) * sizeof(*sb->reqs));
+    if (!sb->reqs) {
+        js_free(ctx, sb);
+        goto end;
+    }
+    sb->ctx = ctx;
+    sb->holder = holder;
+    sb->sizes = sizes;
+    sb->sent = sent;
+    holder = JS_UNDEFINED;
+    sizes = JS_UNDEFINED;
+    ret = TJS_InitPromise(ctx, &sb->result);
+
+    for (uint32_t i = sent; i < n; i++) {
+        uv_udp_send_t *req = &sb->reqs[i - sent];
+        req->data = sb;
+        const struct sockaddr *sa = has_addr[i] ? (struct sockaddr *) &addrs[i] : NULL;
+        int r = uv_udp_send(req, &u->udp, &bufs[i], 1, sa, uv__udp_send_batch_cb);
+        if (r != 0) {
+            sb->error = r;
+            break;
+        }
+        sb->pending++;
+    }
+
+    /* Nothing got queued. */
+    if (sb->pending == 0) {
+        tjs__udp_send_batch_settle(sb);
+    }
+
+end:
+    js_free(ctx, bufs);
+    js_free(ctx, addrs);
+    js_free(ctx, has_addr);
+    JS_FreeValue(ctx, holder);
+    JS_FreeValue(ctx, sizes);
+    return ret;
+}
+
 static JSValue tjs_udp_fileno(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
     TJSUdp *u = tjs_udp_get(ctx, this_val);
     if (!u) {
@@ -287,6 +847,95 @@ static JSValue tjs_udp_fileno(JSContext *ctx, JSValue this_val, int argc, JSValu
     return JS_NewInt32(ctx, rfd);
 }
 
+static JSValue tjs_udp_set_segment_size(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSUdp *u = tjs_udp_get(ctx, this_val);
+    if (!u) {
+        return JS_EXCEPTION;
+    }
+
+    uint32_t size;
+    if (JS_ToUint32(ctx, &size, argv[0])) {
+        return JS_EXCEPTION;
+    }
+    if (size > TJS__UDP_GSO_MAXSIZE) {
+        return JS_ThrowRangeError(ctx, "segment size too large");
+    }
+
+#if defined(UDP_SEGMENT)
+    uv_os_fd_t fd;
+    int r = uv_fileno((uv_handle_t *) &u->udp, &fd);
+    if (r != 0) {
+        return tjs_throw_errno(ctx, r);
+    }
+
+    int value = size;
+    if (setsockopt(fd, IPPROTO_UDP, UDP_SEGMENT, &value, sizeof(value)) != 0) {
+        return tjs_throw_errno(ctx, -errno);
+    }
+
+    u->gso_size = size;
+
+    return JS_UNDEFINED;
+#else
+    return tjs_throw_errno(ctx, UV_ENOTSUP);
+#endif
+}
+
+static JSValue tjs_udp_set_gro(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSUdp *u = tjs_udp_get(ctx, this_val);
+    if (!u) {
+        return JS_EXCEPTION;
+    }
+
+    bool enable = JS_ToBool(ctx, argv[0]);
+
+#if defined(UDP_GRO)
+    /* A pending read is tied to the way it was started. */
+    if (TJS_IsPromisePending(ctx, &u->read.result)) {
+        return tjs_throw_errno(ctx, UV_EBUSY);
+    }
+
+    uv_os_fd_t fd;
+    int r = uv_fileno((uv_handle_t *) &u->udp, &fd);
+    if (r != 0) {
+        return tjs_throw_errno(ctx, r);
+    }
+
+    if (enable && !u->gro.started) {
+        r = tjs__udp_slab_reserve(u, TJS__UDP_DGRAM_MAXSIZE);
+        if (r != 0) {
+            return tjs_throw_errno(ctx, r);
+        }
+
+        int dupfd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (dupfd == -1) {
+            return tjs_throw_errno(ctx, -errno);
+        }
+
+        r = uv_poll_init(tjs_get_loop(ctx), &u->gro.poll, dupfd);
+        if (r != 0) {
+            close(dupfd);
+            return tjs_throw_errno(ctx, r);
+        }
+
+        u->gro.poll.data = u;
+        u->gro.fd = dupfd;
+        u->gro.started = true;
+    }
+
+    int value = enable;
+    if (setsockopt(fd, IPPROTO_UDP, UDP_GRO, &value, sizeof(value)) != 0) {
+        return tjs_throw_errno(ctx, -errno);
+    }
+
+    u->gro.enabled = enable;
+
+    return JS_UNDEFINED;
+#else
+    return enable ? tjs_throw_errno(ctx, UV_ENOTSUP) : JS_UNDEFINED;
+#endif
+}
+
 static JSValue tjs_new_udp(JSContext *ctx, int af) {
     TJSUdp *u;
     JSValue obj;
@@ -303,7 +952,7 @@ static JSValue tjs_new_udp(JSContext *ctx, int af) {
         return JS_ThrowOutOfMemory(ctx);
     }
 
-    r = uv_udp_init_ex(tjs_get_loop(ctx), &u->udp, af);
+    r = uv_udp_init_ex(tjs_get_loop(ctx), &u->udp, af | UV_UDP_RECVMMSG);
     if (r != 0) {
         JS_FreeValue(ctx, obj);
         tjs__free(u);
@@ -312,9 +961,9 @@ static JSValue tjs_new_udp(JSContext *ctx, int af) {
 
     u->ctx = ctx;
     u->udp.data = u;
-    u->read.b.tarray = JS_UNDEFINED;
-    u->read.b.data = NULL;
-    u->read.b.len = 0;
+    u->read.buffers = JS_UNDEFINED;
+    u->read.results = JS_UNDEFINED;
+    u->gro.fd = -1;
 
     TJS_ClearPromise(ctx, &u->read.result);
 
@@ -405,6 +1054,10 @@ static const JSCFunctionListEntry tjs_udp_proto_funcs[] = {
     TJS_CFUNC_DEF("close", 0, tjs_udp_close),
     TJS_CFUNC_DEF("recv", 1, tjs_udp_recv),
     TJS_CFUNC_DEF("send", 2, tjs_udp_send),
+    TJS_CFUNC_DEF("recvBatch", 1, tjs_udp_recv_batch),
+    TJS_CFUNC_DEF("sendBatch", 1, tjs_udp_send_batch),
+    TJS_CFUNC_DEF("setSegmentSize", 1, tjs_udp_set_segment_size),
+    TJS_CFUNC_DEF("setGro", 1, tjs_udp_set_gro),
     TJS_CFUNC_DEF("fileno", 0, tjs_udp_fileno),
     JS_CFUNC_MAGIC_DEF("getsockname", 0, tjs_udp_getsockpeername, 0),
     JS_CFUNC_MAGIC_DEF("getpeername", 0, tjs_udp_getsockpeername, 1),
@@ -416,6 +1069,7 @@ static const JSCFunctionListEntry tjs_udp_proto_funcs[] = {
 static const JSCFunctionListEntry tjs_udp_funcs[] = {
     TJS_UVCONST(UDP_IPV6ONLY),
     TJS_UVCONST(UDP_REUSEADDR),
+    TJS_UVCONST(UDP_REUSEPORT),
 };
 
 void tjs__mod_udp_init(JSContext *ctx, JSValue ns) {
@@ -0,0 +1,1160 @@
+/*
+ * txiki.js
+ *
+ * Copyright (c) 2022-present Saúl Ibarra Corretgé <s@saghul.net>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "mem.h"
+#include "private.h"
+#include "utils.h"
+
+#include <string.h>
+
+#define TJS__WALK_BATCH_SIZE  1024
+#define TJS__WALK_CONCURRENCY 4
+
+#if defined(_WIN32)
+#define TJS__PATHSEP '\\'
+#else
+#define TJS__PATHSEP '/'
+#endif
+
+typedef struct {
+    char *path;
+    uint32_t name_offset;
+    uint32_t depth;
+    uv_dirent_type_t type;
+    bool has_stat;
+    uv_stat_t st;
+} TJSWalkEntry;
+
+typedef struct {
+    char *path;
+    uint32_t depth;
+    uint64_t dev;
+    uint64_t ino;
+} TJSWalkDir;
+
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+} TJSWalkFileId;
+
+/* A glob pattern split in path segments. */
+typedef struct {
+    char **segs;
+    uint32_t nsegs;
+    bool has_globstar;
+} TJSGlobPattern;
+
+typedef struct {
+    struct {
+        TJSGlobPattern *items;
+        size_t len;
+        size_t cap;
+    } include, ignore;
+    bool dot;
+    /* Offset of the path relative to the root in every entry path. */
+    uint32_t rel_offset;
+} TJSGlob;
+
+typedef struct {
+    const char *s;
+    size_t len;
+} TJSGlobSeg;
+
+typedef struct {
+    JSContext *ctx;
+    JSValue obj; /* Keeps the walker alive while a read is in progress. */
+    uv_mutex_t lock;
+    struct {
+        bool follow_symlinks;
+        bool stat;
+        uint32_t max_depth;
+        uint32_t batch_size;
+        uint32_t concurrency;
+    } opts;
+    /* Directories yet to be scanned. */
+    struct {
+        TJSWalkDir *items;
+        size_t len;
+        size_t cap;
+    } pending;
+    /* Entries found by the current read. */
+    struct {
+        TJSWalkEntry *items;
+        size_t len;
+        size_t cap;
+    } results;
+    /* Directories already visited, only tracked when following symlinks, to break cycles. */
+    struct {
+        TJSWalkFileId *items;
+        size_t len;
+        size_t cap;
+    } visited;
+    /* Only set when walking for tjs.glob. */
+    TJSGlob *glob;
+    int error;
+    uv_work_t *reqs;
+    uint32_t active;
+    bool reading;
+    TJSPromise result;
+} TJSWalker;
+
+static JSClassID tjs_walker_class_id;
+
+static bool tjs__vec_reserve(void **items, size_t *cap, size_t len, size_t item_size) {
+    if (len < *cap) {
+        return true;
+    }
+    size_t new_cap = *cap ? *cap * 2 : 64;
+    void *new_items = tjs__realloc(*items, new_cap * item_size);
+    if (!new_items) {
+        return false;
+    }
+    *items = new_items;
+    *cap = new_cap;
+    return true;
+}
+
+static void tjs__walk_free_entries(TJSWalkEntry *entries, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        tjs__free(entries[i].path);
+    }
+}
+
+static void tjs__walk_free_dirs(TJSWalkDir *dirs, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        tjs__free(dirs[i].path);
+    }
+}
+
+/* Open addressing set of (dev, ino) pairs. Must be called with the lock held.
+ * Returns true if the id was not in the set.
+ */
+static bool tjs__walk_visit(TJSWalker *w, uint64_t dev, uint64_t ino) {
+    if ((w->visited.len + 1) * 2 > w->visited.cap) {
+        size_t new_cap = w->visited.cap ? w->visited.cap * 2 : 256;
+        TJSWalkFileId *new_items = tjs__calloc(new_cap, sizeof(*new_items));
+        if (!new_items) {
+            return true;
+        }
+        for (size_t i = 0; i < w->visited.cap; i++) {
+            TJSWalkFileId *id = &w->visited.items[i];
+            if (id->dev == 0 && id->ino == 0) {
+                continue;
+            }
+            size_t j = (id->dev * 31 + id->ino) & (new_cap - 1);
+            while (new_items[j].dev != 0 || new_items[j].ino != 0) {
+                j = (j + 1) & (new_cap - 1);
+            }
+            new_items[j] = *id;
+        }
+        tjs__free(w->visited.items);
+        w->visited.items = new_items;
+        w->visited.cap = new_cap;
+    }
+
+    size_t mask = w->visited.cap - 1;
+    size_t i = (dev * 31 + ino) & mask;
+    for (;;) {
+        TJSWalkFileId *id = &w->visited.items[i];
+        if (id->dev == 0 && id->ino == 0) {
+            id->dev = dev;
+            id->ino = ino;
+            w->visited.len++;
+            return true;
+        }
+        if (id->dev == dev && id->ino == ino) {
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+static uv_dirent_type_t tjs__walk_mode_to_type(uint64_t mode) {
+    switch (mode & S_IFMT) {
+        case S_IFREG:
+            return UV_DIRENT_FILE;
+        case S_IFDIR:
+            return UV_DIRENT_DIR;
+        case S_IFLNK:
+            return UV_DIRENT_LINK;
+        case S_IFCHR:
+            return UV_DIRENT_CHAR;
+#if defined(S_IFIFO)
+        case S_IFIFO:
+            return UV_DIRENT_FIFO;
+#endif
+#if defined(S_IFSOCK)
+        case S_IFSOCK:
+            return UV_DIRENT_SOCKET;
+#endif
+#if defined(S_IFBLK)
+        case S_IFBLK:
+            return UV_DIRENT_BLOCK;
+#endif
+        default:
+            return UV_DIRENT_UNKNOWN;
+    }
+}
+
+static bool tjs__walk_is_skippable_error(int err) {
+    /* Entries may vanish or be unreadable while walking, that doesn't abort the walk. */
+    return err == UV_EACCES || err == UV_EPERM || err == UV_ENOENT || err == UV_ENOTDIR || err == UV_ELOOP;
+}
+
+static char *tjs__walk_join(const char *dir, const char *name, uint32_t *name_offset) {
+    size_t dir_len = strlen(dir);
+    size_t name_len = strlen(name);
+    bool add_sep = dir_len > 0 && dir[dir_len - 1] != TJS__PATHSEP && dir[dir_len - 1] != '/';
+    char *path = tjs__malloc(dir_len + add_sep + name_len + 1);
+    if (!path) {
+        return NULL;
+    }
+    memcpy(path, dir, dir_len);
+    if (add_sep) {
+        path[dir_len] = TJS__PATHSEP;
+    }
+    memcpy(path + dir_len + add_sep, name, name_len + 1);
+    *name_offset = dir_len + add_sep;
+    return path;
+}
+
+/* Glob matching */
+
+/* Matches a character class starting at p ('['). Returns 1 on match, 0 on mismatch and -1 if the class
+ * is not terminated, in which case the '[' is taken literally. */
+static int tjs__glob_match_class(const char *p, char c, const char **next) {
+    const char *q = p + 1;
+    bool negate = false;
+    bool matched = false;
+
+    if (*q == '!' || *q == '^') {
+        negate = true;
+        q++;
+    }
+
+    bool first = true;
+    while (*q != '\0' && (*q != ']' || first)) {
+        first = false;
+        char lo = *q;
+#if !defined(_WIN32)
+        if (lo == '\\' && q[1] != '\0') {
+            lo = *++q;
+        }
+#endif
+        char hi = lo;
+        if (q[1] == '-' && q[2] != '\0' && q[2] != ']') {
+            hi = q[2];
+            q += 2;
+        }
+        if (c >= lo && c <= hi) {
+            matched = true;
+        }
+        q++;
+    }
+
+    if (*q != ']') {
+        return -1;
+    }
+
+    *next = q + 1;
+    return matched != negate;
+}
+
+static bool tjs__glob_match_seg(const char *p, TJSGlobSeg seg, bool dot) {
+    /* Hidden entries are only matched by patterns starting with a literal dot, unless dot is set. */
+    if (!dot && seg.len > 0 && seg.s[0] == '.' && p[0] != '.') {
+        return false;
+    }
+
+    const char *star_p = NULL;
+    size_t star_i = 0;
+    size_t i = 0;
+
+    while (i < seg.len) {
+        char c = seg.s[i];
+        const char *next = NULL;
+
+        if (*p == '*') {
+            star_p = ++p;
+            star_i = i;
+            continue;
+        }
+
+        if (*p == '?') {
+            next = p + 1;
+        } else if (*p == '[') {
+            int m = tjs__glob_match_class(p, c, &next);
+            if (m == 0) {
+                next = NULL;
+            } else if (m < 0) {
+                next = c == '[' ? p + 1 : NULL;
+            }
+#if !defined(_WIN32)
+        } else if (*p == '\\' && p[1] != '\0') {
+            next = p[1] == c ? p + 2 : NULL;
+#endif
+        } else if (*p != '\0' && *p == c) {
+            next = p + 1;
+        }
+
+        if (next) {
+            p = next;
+            i++;
+        } else if (star_p) {
+            p = star_p;
+            i = ++star_i;
+        } else {
+            return false;
+        }
+    }
+
+    while (*p == '*') {
+        p++;
+    }
+
+    return *p == '\0';
+}
+
+/* Matches path segments against a pattern. When partial is set, checks whether some descendant
+ * of the path could match instead, which is what decides if a directory is worth scanning. */
+static bool tjs__glob_match_segs(const TJSGlobPattern *pat,
+                                 uint32_t pi,
+                                 const TJSGlobSeg *segs,
+                                 uint32_t nsegs,
+                                 uint32_t si,
+                                 bool dot,
+                                 bool partial) {
+    while (pi < pat->nsegs) {
+        const char *p = pat->segs[pi];
+
+        if (p[0] == '*' && p[1] == '*' && p[2] == '\0') {
+            if (tjs__glob_match_segs(pat, pi + 1, segs, nsegs, si, dot, partial)) {
+                return true;
+            }
+            if (si == nsegs) {
+                return partial;
+            }
+            if (!dot && segs[si].len > 0 && segs[si].s[0] == '.') {
+                return false;
+            }
+            si++;
+            continue;
+        }
+
+        if (si == nsegs) {
+            return partial;
+        }
+
+        if (!tjs__glob_match_seg(p, segs[si], dot)) {
+            return false;
+        }
+
+        pi++;
+        si++;
+    }
+
+    return !partial && si == nsegs;
+}
+
+static inline bool tjs__glob_is_sep(char c) {
+    return c == '/' || c == TJS__PATHSEP;
+}
+
+/* Splits a relative path in segments. The result must be freed if it's not the given stack buffer. */
+static TJSGlobSeg *tjs__glob_split(const char *path, TJSGlobSeg *buf, uint32_t buf_len, uint32_t *nsegs) {
+    uint32_t n = 1;
+    for (const char *c = path; *c; c++) {
+        n += tjs__glob_is_sep(*c);
+    }
+
+    TJSGlobSeg *segs = n <= buf_len ? buf : tjs__malloc(n * sizeof(*segs));
+    if (!segs) {
+        return NULL;
+    }
+
+    n = 0;
+    const char *start = path;
+    for (const char *c = path;; c++) {
+        if (*c == '\0' || tjs__glob_is_sep(*c)) {
+            segs[n].s = start;
+            segs[n].len = c - start;
+            n++;
+            if (*c == '\0') {
+                break;
+            }
+            start = c + 1;
+        }
+    }
+
+    *nsegs = n;
+    return segs;
+}
+
+static bool tjs__glob_any(const TJSGlobPattern *pats,
+                          size_t npats,
+                          const TJSGlobSeg *segs,
+                          uint32_t nsegs,
+                          bool dot,
+                          bool partial) {
+    for (size_t i = 0; i < npats; i++) {
+        if (tjs__glob_match_segs(&pats[i], 0, segs, nsegs, 0, dot, partial)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Decides whether an entry is a result and whether its subtree must be scanned (for directories). */
+static void tjs__glob_check(const TJSGlob *g, const char *rel, bool is_dir, bool *match, bool *descend) {
+    TJSGlobSeg buf[64];
+    uint32_t nsegs;
+    TJSGlobSeg *segs = tjs__glob_split(rel, buf, countof(buf), &nsegs);
+    if (!segs) {
+        *match = false;
+        *descend = false;
+        return;
+    }
+
+    /* Ignored entries are dropped together with their whole subtree. Ignore patterns apply to hidden entries too. */
+    if (tjs__glob_any(g->ignore.items, g->ignore.len, segs, nsegs, true, false)) {
+        *match = false;
+        *descend = false;
+    } else {
+        *match = tjs__glob_any(g->include.items, g->include.len, segs, nsegs, g->dot, false);
+        *descend = is_dir && tjs__glob_any(g->include.items, g->include.len, segs, nsegs, g->dot, true);
+    }
+
+    if (segs != buf) {
+        tjs__free(segs);
+    }
+}
+
+static void tjs__glob_free_patterns(TJSGlobPattern *pats, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        for (uint32_t j = 0; j < pats[i].nsegs; j++) {
+            tjs__free(pats[i].segs[j]);
+        }
+        tjs__free(pats[i].segs);
+    }
+    tjs__free(pats);
+}
+
+static void tjs__glob_free(TJSGlob *g) {
+    if (g) {
+        tjs__glob_free_patterns(g->include.items, g->include.len);
+        tjs__glob_free_patterns(g->ignore.items, g->ignore.len);
+        tjs__free(g);
+    }
+}
+
+/* Compiles a single pattern without braces: splits it in segments, dropping empty and "." ones. */
+static int tjs__glob_add_pattern(void **items, size_t *len, size_t *cap, const char *pattern) {
+    if (!tjs__vec_reserve(items, cap, *len, sizeof(TJSGlobPattern))) {
+        return -1;
+    }
+
+    TJSGlobPattern *pat = &((TJSGlobPattern *) *items)[*len];
+    memset(pat, 0, sizeof(*pat));
+
+    uint32_t n = 1;
+    for (const char *c = pattern; *c; c++) {
+        n += *c == '/';
+    }
+    pat->segs = tjs__calloc(n, sizeof(*pat->segs));
+    if (!pat->segs) {
+        return -1;
+    }
+    (*len)++;
+
+    const char *start = pattern;
+    for (const char *c = pattern;; c++) {
+        if (*c == '\0' || *c == '/') {
+            size_t seg_len = c - start;
+            bool skip = seg_len == 0 || (seg_len == 1 && start[0] == '.');
+            /* Consecutive globstars are equivalent to a single one. */
+            bool globstar = seg_len == 2 && start[0] == '*' && start[1] == '*';
+            if (globstar && pat->nsegs > 0 && strcmp(pat->segs[pat->nsegs - 1], "**") == 0) {
+                skip = true;
+            }
+            if (!skip) {
+                char *seg = tjs__malloc(seg_len + 1);
+                if (!seg) {
+                    return -1;
+                }
+                memcpy(seg, start, seg_len);
+                seg[seg_len] = '\0';
+                pat->segs[pat->nsegs++] = seg;
+                pat->has_globstar |= globstar;
+            }
+            if (*c == '\0') {
+                break;
+            }
+            start = c + 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Expands the first brace group ({a,b}) and recurses on each alternative. */
+static int tjs__glob_expand(void **items, size_t *len, size_t *cap, const char *pattern) {
+    const char *open = NULL;
+    const char *close = NULL;
+    int depth = 0;
+    bool has_comma = false;
+
+    for (const char *c = pattern; *c; c++) {
+#if !defined(_WIN32)
+        if (*c == '\\' && c[1] != '\0') {
+            c++;
+            continue;
+        }
+#endif
+        if (*c == '{') {
+            if (depth++ == 0) {
+                open = c;
+                has_comma = false;
+            }
+        } else if (*c == '}' && depth > 0) {
+            if (--depth == 0) {
+                if (has_comma) {
+                    close = c;
+                    break;
+                }
+                open = NULL;
+            }
+        } else if (*c == ',' && depth == 1) {
+            has_comma = true;
+        }
+    }
+
+    if (!close) {
+        return tjs__glob_add_pattern(items, len, cap, pattern);
+    }
+
+    size_t prefix_len = open - pattern;
+    size_t suffix_len = strlen(close + 1);
+    char *buf = tjs__malloc(strlen(pattern) + 1);
+    if (!buf) {
+        return -1;
+    }
+
+    const char *alt = open + 1;
+    depth = 0;
+    for (const char *c = alt; c <= close; c++) {
+#if !defined(_WIN32)
+        if (*c == '\\' && c[1] != '\0') {
+            c++;
+            continue;
+        }
+#endif
+        if (*c == '{') {
+            depth++;
+        } else if (*c == '}' && depth > 0) {
+            depth--;
+        } else if ((*c == ',' && depth == 0) || c == close) {
+            size_t alt_len = c - alt;
+            memcpy(buf, pattern, prefix_len);
+            memcpy(buf + prefix_len, alt, alt_len);
+            memcpy(buf + prefix_len + alt_len, close + 1, suffix_len + 1);
+            if (tjs__glob_expand(items, len, cap, buf) != 0) {
+                tjs__free(buf);
+                return -1;
+            }
+            alt = c + 1;
+        }
+    }
+
+    tjs__free(buf);
+    return 0;
+}
+
+/* Runs on the threadpool. */
+static void tjs__walk_scan(TJSWalker *w, TJSWalkDir *dir) {
+    bool follow = w->opts.follow_symlinks;
+    uv_fs_t req;
+    int r;
+
+    if (dir->depth == 0 && follow) {
+        r = uv_fs_stat(NULL, &req, dir->path, NULL);
+        if (r == 0) {
+            uv_mutex_lock(&w->lock);
+            tjs__walk_visit(w, req.statbuf.st_dev, req.statbuf.st_ino);
+            uv_mutex_unlock(&w->lock);
+        }
+        uv_fs_req_cleanup(&req);
+    }
+
+    r = uv_fs_scandir(NULL, &req, dir->path, 0, NULL);
+    if (r < 0) {
+        uv_fs_req_cleanup(&req);
+        if (dir->depth == 0 || !tjs__walk_is_skippable_error(r)) {
+            uv_mutex_lock(&w->lock);
+            if (w->error == 0) {
+                w->error = r;
+            }
+            uv_mutex_unlock(&w->lock);
+        }
+        return;
+    }
+
+    struct {
+        TJSWalkEntry *items;
+        size_t len;
+        size_t cap;
+    } entries = { 0 };
+    struct {
+        TJSWalkDir *items;
+        size_t len;
+        size_t cap;
+    } dirs = { 0 };
+
+    uv_dirent_t dent;
+    while (uv_fs_scandir_next(&req, &dent) != UV_EOF) {
+        TJSWalkEntry e = { .depth = dir->depth + 1, .type = dent.type, .has_stat = false };
+        e.path = tjs__walk_join(dir->path, dent.name, &e.name_offset);
+        if (!e.path) {
+            break;
+        }
+
+        bool need_stat = w->opts.stat || e.type == UV_DIRENT_UNKNOWN ||
+                         (follow && (e.type == UV_DIRENT_LINK || e.type == UV_DIRENT_DIR));
+        if (need_stat) {
+            uv_fs_t sreq;
+            int sr = follow ? uv_fs_stat(NULL, &sreq, e.path, NULL) : uv_fs_lstat(NULL, &sreq, e.path, NULL);
+            if (sr == 0) {
+                e.st = sreq.statbuf;
+                e.has_stat = true;
+                if (e.type == UV_DIRENT_UNKNOWN) {
+                    e.type = tjs__walk_mode_to_type(e.st.st_mode);
+                }
+            }
+            uv_fs_req_cleanup(&sreq);
+        }
+
+        bool is_dir = follow && e.has_stat ? (e.st.st_mode & S_IFMT) == S_IFDIR : e.type == UV_DIRENT_DIR;
+        bool is_result = true;
+        if (w->glob) {
+            tjs__glob_check(w->glob, e.path + w->glob->rel_offset, is_dir, &is_result, &is_dir);
+        }
+        if (is_dir && e.depth < w->opts.max_depth) {
+            if (!tjs__vec_reserve((void **) &dirs.items, &dirs.cap, dirs.len, sizeof(*dirs.items))) {
+                tjs__free(e.path);
+                break;
+            }
+            TJSWalkDir *d = &dirs.items[dirs.len];
+            d->path = tjs__malloc(strlen(e.path) + 1);
+            if (!d->path) {
+                tjs__free(e.path);
+                break;
+            }
+            dirs.len++;
+            strcpy(d->path, e.path);
+            d->depth = e.depth;
+            d->dev = e.has_stat ? e.st.st_dev : 0;
+            d->ino = e.has_stat ? e.st.st_ino : 0;
+        }
+
+        if (!is_result) {
+            tjs__free(e.path);
+            continue;
+        }
+
+        if (!tjs__vec_reserve((void **) &entries.items, &entries.cap, entries.len, sizeof(*entries.items))) {
+            tjs__free(e.path);
+            break;
+        }
+        entries.items[entries.len++] = e;
+    }
+
+    uv_fs_req_cleanup(&req);
+
+    /* Publish the results of this directory in one go. */
+    uv_mutex_lock(&w->lock);
+
+    for (size_t i = 0; i < dirs.len; i++) {
+        TJSWalkDir *d = &dirs.items[i];
+        bool keep = !follow || tjs__walk_visit(w, d->dev, d->ino);
+        if (keep && tjs__vec_reserve((void **) &w->pending.items, &w->pending.cap, w->pending.len, sizeof(*d))) {
+            w->pending.items[w->pending.len++] = *d;
+        } else {
+            tjs__free(d->path);
+        }
+    }
+
+    for (size_t i = 0; i < entries.len; i++) {
+        TJSWalkEntry *e = &entries.items[i];
+        if (tjs__vec_reserve((void **) &w->results.items, &w->results.cap, w->results.len, sizeof(*e))) {
+            w->results.items[w->results.len++] = *e;
+        } else {
+            tjs__free(e->path);
+        }
+    }
+
+    uv_mutex_unlock(&w->lock);
+
+    tjs__free(dirs.items);
+    tjs__free(entries.items);
+}
+
+static void tjs__walk_work_cb(uv_work_t *req) {
+    TJSWalker *w = req->data;
+    CHECK_NOT_NULL(w);
+
+    for (;;) {
+        uv_mutex_lock(&w->lock);
+        if (w->error != 0 || w->pending.len == 0 || w->results.len >= w->opts.batch_size) {
+            uv_mutex_unlock(&w->lock);
+            return;
+        }
+        TJSWalkDir dir = w->pending.items[--w->pending.len];
+        uv_mutex_unlock(&w->lock);
+
+        tjs__walk_scan(w, &dir);
+        tjs__free(dir.path);
+    }
+}
+
+static JSValue tjs__walk_new_entry(JSContext *ctx, TJSWalkEntry *e, bool with_stat) {
+    JSValue obj = JS_NewObject(ctx);
+    if (JS_IsException(obj)) {
+        return obj;
+    }
+
+    JS_DefinePropertyValueStr(ctx, obj, "name", JS_NewString(ctx, e->path + e->name_offset), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "path", JS_NewString(ctx, e->path), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "depth", JS_NewUint32(ctx, e->depth), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "isFile", JS_NewBool(ctx, e->type == UV_DIRENT_FILE), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "isDirectory", JS_NewBool(ctx, e->type == UV_DIRENT_DIR), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "isSymbolicLink", JS_NewBool(ctx, e->type == UV_DIRENT_LINK), JS_PROP_C_W_E);
+    if (with_stat && e->has_stat) {
+        JS_DefinePropertyValueStr(ctx, obj, "stat", tjs_new_stat(ctx, &e->st), JS_PROP_C_W_E);
+    }
+
+    return obj;
+}
+
+static void tjs__walk_after_work_cb(uv_work_t *req, int status) {
+    TJSWalker *w = req->data;
+    CHECK_NOT_NULL(w);
+
+    CHECK_GT(w->active, 0);
+    if (--w->active > 0) {
+        return;
+    }
+
+    JSContext *ctx = w->ctx;
+    JSValue arg;
+    bool is_reject = false;
+
+    w->reading = false;
+
+    if (w->error != 0) {
+        arg = tjs_new_error(ctx, w->error);
+        is_reject = true;
+    } else {
+        arg = JS_NewArray(ctx);
+        for (size_t i = 0; i < w->results.len; i++) {
+            TJSWalkEntry *e = &w->results.items[i];
+            JSValue item = w->glob ? JS_NewString(ctx, e->path + w->glob->rel_offset) :
+                                     tjs__walk_new_entry(ctx, e, w->opts.stat);
+            JS_DefinePropertyValueUint32(ctx, arg, i, item, JS_PROP_C_W_E);
+        }
+    }
+
+    tjs__walk_free_entries(w->results.items, w->results.len);
+    w->results.len = 0;
+
+    TJS_SettlePromise(ctx, &w->result, is_reject, 1, &arg);
+    TJS_ClearPromise(ctx, &w->result);
+
+    /* This may finalize the walker, so it must go last. */
+    JSValue obj = w->obj;
+    w->obj = JS_UNDEFINED;
+    JS_FreeValue(ctx, obj);
+}
+
+static void tjs_walker_finalizer(JSRuntime *rt, JSValue val) {
+    TJSWalker *w = JS_GetOpaque(val, tjs_walker_class_id);
+    if (w) {
+        CHECK_EQ(w->active, 0);
+        TJS_FreePromiseRT(rt, &w->result);
+        tjs__walk_free_dirs(w->pending.items, w->pending.len);
+        tjs__walk_free_entries(w->results.items, w->results.len);
+        tjs__free(w->pending.items);
+        tjs__free(w->results.items);
+        tjs__free(w->visited.items);
+        tjs__free(w->reqs);
+        tjs__glob_free(w->glob);
+        uv_mutex_destroy(&w->lock);
+        tjs__free(w);
+    }
+}
+
+static void tjs_walker_mark(JSRuntime *rt, JSValue val, JS_MarkFunc *mark_func) {
+    TJSWalker *w = JS_GetOpaque(val, tjs_walker_class_id);
+    if (w) {
+        TJS_MarkPromise(rt, &w->result, mark_func);
+    }
+}
+
+static JSClassDef tjs_walker_class = {
+    "Walker",
+    .finalizer = tjs_walker_finalizer,
+    .gc_mark = tjs_walker_mark,
+};
+
+static TJSWalker *tjs_walker_get(JSContext *ctx, JSValue obj) {
+    return JS_GetOpaque2(ctx, obj, tjs_walker_class_id);
+}
+
+static JSValue tjs_walker_read(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSWalker *w = tjs_walker_get(ctx, this_val);
+    if (!w) {
+        return JS_EXCEPTION;
+    }
+
+    if (w->reading) {
+        return JS_ThrowTypeError(ctx, "a read is already in progress");
+    }
+
+    if (w->error != 0) {
+        JSValue error = tjs_new_error(ctx, w->error);
+        return TJS_NewRejectedPromise(ctx, 1, &error);
+    }
+
+    if (w->pending.len == 0) {
+        JSValue arr = JS_NewArray(ctx);
+        return TJS_NewResolvedPromise(ctx, 1, &arr);
+    }
+
+    /* Scan up to `concurrency` directories in parallel. */
+    uint32_t n = w->pending.len < w->opts.concurrency ? w->pending.len : w->opts.concurrency;
+    for (uint32_t i = 0; i < n; i++) {
+        w->reqs[i].data = w;
+        int r = uv_queue_work(tjs_get_loop(ctx), &w->reqs[i], tjs__walk_work_cb, tjs__walk_after_work_cb);
+        if (r != 0) {
+            if (i == 0) {
+                return tjs_throw_errno(ctx, r);
+            }
+            break;
+        }
+        w->active++;
+    }
+
+    w->reading = true;
+    w->obj = JS_DupValue(ctx, this_val);
+
+    return TJS_InitPromise(ctx, &w->result);
+}
+
+static JSValue tjs_walker_close(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSWalker *w = tjs_walker_get(ctx, this_val);
+    if (!w) {
+        return JS_EXCEPTION;
+    }
+
+    /* In-flight scans finish their current directory and stop. */
+    uv_mutex_lock(&w->lock);
+    tjs__walk_free_dirs(w->pending.items, w->pending.len);
+    w->pending.len = 0;
+    uv_mutex_unlock(&w->lock);
+
+    return JS_UNDEFINED;
+}
+
+static int tjs__walk_get_uint32(JSContext *ctx, JSValue opts, const char *name, uint32_t *value) {
+    JSValue js_value = JS_GetPropertyStr(ctx, opts, name);
+    if (JS_IsUndefined(js_value)) {
+        return 0;
+    }
+
+    double d;
+    int r = JS_ToFloat64(ctx, &d, js_value);
+    JS_FreeValue(ctx, js_value);
+    if (r != 0) {
+        return -1;
+    }
+    if (d < 0) {
+        JS_ThrowRangeError(ctx, "%s must be a positive number", name);
+        return -1;
+    }
+
+    *value = d >= UINT32_MAX ? UINT32_MAX : (uint32_t) d;
+    return 0;
+}
+
+/* Creates a walker rooted at path. Takes ownership of glob. */
+static JSValue tjs__walker_new(JSContext *ctx, const char *path, JSValue opts, TJSGlob *glob) {
+    bool follow_symlinks = false;
+    bool stat = false;
+    uint32_t max_depth = UINT32_MAX;
+    uint32_t batch_size = TJS__WALK_BATCH_SIZE;
+    uint32_t concurrency = TJS__WALK_CONCURRENCY;
+
+    if (JS_IsObject(opts)) {
+        JSValue js_follow = JS_GetPropertyStr(ctx, opts, "followSymlinks");
+        follow_symlinks = JS_ToBool(ctx, js_follow);
+        JS_FreeValue(ctx, js_follow);
+
+        JSValue js_stat = JS_GetPropertyStr(ctx, opts, "stat");
+        stat = JS_ToBool(ctx, js_stat);
+        JS_FreeValue(ctx, js_stat);
+
+        if (tjs__walk_get_uint32(ctx, opts, "maxDepth", &max_depth) != 0 ||
+            tjs__walk_get_uint32(ctx, opts, "batchSize", &batch_size) != 0 ||
+            tjs__walk_get_uint32(ctx, opts, "concurrency", &concurrency) != 0) {
+            tjs__glob_free(glob);
+            return JS_EXCEPTION;
+        }
+    }
+
+    if (batch_size == 0) {
+        batch_size = 1;
+    }
+    if (concurrency == 0) {
+        concurrency = 1;
+    }
+
+    if (glob) {
+        /* Without globstars nothing deeper than the longest pattern can match. */
+        uint32_t glob_depth = 0;
+        for (size_t i = 0; i < glob->include.len; i++) {
+            TJSGlobPattern *pat = &glob->include.items[i];
+            if (pat->has_globstar) {
+                glob_depth = UINT32_MAX;
+                break;
+            }
+            if (pat->nsegs > glob_depth) {
+                glob_depth = pat->nsegs;
+            }
+        }
+        if (glob_depth < max_depth) {
+            max_depth = glob_depth;
+        }
+
+        size_t path_len = strlen(path);
+        bool has_sep = path_len > 0 && (path[path_len - 1] == TJS__PATHSEP || path[path_len - 1] == '/');
+        glob->rel_offset = path_len + !has_sep;
+    }
+
+    JSValue obj = JS_NewObjectClass(ctx, tjs_walker_class_id);
+    if (JS_IsException(obj)) {
+        tjs__glob_free(glob);
+        return obj;
+    }
+
+    TJSWalker *w = tjs__mallocz(sizeof(*w));
+    if (!w) {
+        tjs__glob_free(glob);
+        JS_FreeValue(ctx, obj);
+        return JS_ThrowOutOfMemory(ctx);
+    }
+
+    w->ctx = ctx;
+    w->obj = JS_UNDEFINED;
+    w->glob = glob;
+    TJS_ClearPromise(ctx, &w->result);
+    w->opts.follow_symlinks = follow_symlinks;
+    w->opts.stat = stat;
+    w->opts.max_depth = max_depth;
+    w->opts.batch_size = batch_size;
+    w->opts.concurrency = concurrency;
+    CHECK_EQ(uv_mutex_init(&w->lock), 0);
+    JS_SetOpaque(obj, w);
+
+    w->reqs = tjs__calloc(concurrency, sizeof(*w->reqs));
+    w->pending.items = tjs__malloc(sizeof(*w->pending.items));
+    if (!w->reqs || !w->pending.items) {
+        JS_FreeValue(ctx, obj);
+        return JS_ThrowOutOfMemory(ctx);
+    }
+    w->pending.cap = 1;
+
+    /* The root directory is the first one to be scanned. */
+    size_t path_len = strlen(path);
+    TJSWalkDir *root = &w->pending.items[0];
+    root->path = tjs__malloc(path_len + 1);
+    if (!root->path) {
+        JS_FreeValue(ctx, obj);
+        return JS_ThrowOutOfMemory(ctx);
+    }
+    memcpy(root->path, path, path_len + 1);
+    root->depth = 0;
+    w->pending.len = 1;
+
+    return obj;
+}
+
+static JSValue tjs_walk(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    if (!JS_IsString(argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected a string for path parameter");
+    }
+
+    const char *path = JS_ToCString(ctx, argv[0]);
+    if (!path) {
+        return JS_EXCEPTION;
+    }
+
+    JSValue obj = tjs__walker_new(ctx, path, argv[1], NULL);
+    JS_FreeCString(ctx, path);
+
+    return obj;
+}
+
+static int tjs__glob_compile(JSContext *ctx, JSValue arr, void **items, size_t *len, size_t *cap) {
+    int64_t n;
+    if (JS_GetLength(ctx, arr, &n)) {
+        return -1;
+    }
+
+    for (int64_t i = 0; i < n; i++) {
+        JSValue v = JS_GetPropertyUint32(ctx, arr, i);
+        if (!JS_IsString(v)) {
+            JS_FreeValue(ctx, v);
+            JS_ThrowTypeError(ctx, "expected a string pattern");
+            return -1;
+        }
+        const char *str = JS_ToCString(ctx, v);
+        JS_FreeValue(ctx, v);
+        if (!str) {
+            return -1;
+        }
+        if (str[0] == '/') {
+            JS_ThrowTypeError(ctx, "patterns must be relative: %s", str);
+            JS_FreeCString(ctx, str);
+            return -1;
+        }
+#if defined(_WIN32)
+        /* Backslashes are path separators rather than escapes on Windows. */
+        char *pattern = tjs__malloc(strlen(str) + 1);
+        if (pattern) {
+            strcpy(pattern, str);
+            for (char *c = pattern; *c; c++) {
+                if (*c == '\\') {
+                    *c = '/';
+                }
+            }
+        }
+        int r = pattern ? tjs__glob_expand(items, len, cap, pattern) : -1;
+        tjs__free(pattern);
+#else
+        int r = tjs__glob_expand(items, len, cap, str);
+#endif
+        JS_FreeCString(ctx, str);
+        if (r != 0) {
+            JS_ThrowOutOfMemory(ctx);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static JSValue tjs_glob(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    if (!JS_IsArray(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "expected an array of patterns");
+    }
+
+    TJSGlob *glob = tjs__mallocz(sizeof(*glob));
+    if (!glob) {
+        return JS_ThrowOutOfMemory(ctx);
+    }
+
+    if (tjs__glob_compile(ctx,
+                          argv[0],
+                          (void **) &glob->include.items,
+                          &glob->include.len,
+                          &glob->include.cap) != 0) {
+        tjs__glob_free(glob);
+        return JS_EXCEPTION;
+    }
+
+    const char *cwd = NULL;
+    JSValue opts = argv[1];
+    if (JS_IsObject(opts)) {
+        JSValue js_dot = JS_GetPropertyStr(ctx, opts, "dot");
+        glob->dot = JS_ToBool(ctx, js_dot);
+        JS_FreeValue(ctx, js_dot);
+
+        JSValue js_ignore = JS_GetPropertyStr(ctx, opts, "ignore");
+        if (!JS_IsUndefined(js_ignore)) {
+            int r = -1;
+            if (!JS_IsArray(ctx, js_ignore)) {
+                JS_ThrowTypeError(ctx, "expected an array of patterns for ignore");
+            } else {
+                r = tjs__glob_compile(ctx,
+                                      js_ignore,
+                                      (void **) &glob->ignore.items,
+                                      &glob->ignore.len,
+                                      &glob->ignore.cap);
+            }
+            JS_FreeValue(ctx, js_ignore);
+            if (r != 0) {
+                tjs__glob_free(glob);
+                return JS_EXCEPTION;
+            }
+        }
+
+        JSValue js_cwd = JS_GetPropertyStr(ctx, opts, "cwd");
+        if (!JS_IsUndefined(js_cwd)) {
+            cwd = JS_ToCString(ctx, js_cwd);
+            JS_FreeValue(ctx, js_cwd);
+            if (!cwd) {
+                tjs__glob_free(glob);
+                return JS_EXCEPTION;
+            }
+        }
+    }
+
+    JSValue obj = tjs__walker_new(ctx, cwd ? cwd : ".", opts, glob);
+    if (cwd) {
+        JS_FreeCString(ctx, cwd);
+    }
+
+    return obj;
+}
+
+static const JSCFunctionListEntry tjs_walker_proto_funcs[] = {
+    TJS_CFUNC_DEF("read", 0, tjs_walker_read),
+    TJS_CFUNC_DEF("close", 0, tjs_walker_close),
+};
+
+static const JSCFunctionListEntry tjs_walk_funcs[] = {
+    TJS_CFUNC_DEF("walk", 2, tjs_walk),
+    TJS_CFUNC_DEF("glob", 2, tjs_glob),
+};
+
+void tjs__mod_walk_init(JSContext *ctx, JSValue ns) {
+    JSRuntime *rt = JS_GetRuntime(ctx);
+
+    JS_NewClassID(rt, &tjs_walker_class_id);
+    JS_NewClass(rt, tjs_walker_class_id, &tjs_walker_class);
+    JSValue proto = JS_NewObject(ctx);
+    JS_SetPropertyFunctionList(ctx, proto, tjs_walker_proto_funcs, countof(tjs_walker_proto_funcs));
+    JS_SetClassProto(ctx, tjs_walker_class_id, proto);
+
+    JS_SetPropertyFunctionList(ctx, ns, tjs_walk_funcs, countof(tjs_walk_funcs));
+}
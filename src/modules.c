@@ -23,6 +23,7 @@
  */
 
 // #include "curl-utils.h"
+#include "mem.h"
 #include "private.h"
 #include "tjs.h"
 #include "utils.h"
@@ -30,6 +31,212 @@
 #include <string.h>
 
 
+/* Process-wide cache of compiled module bytecode, shared by all runtimes (i.e. workers).
+ * Entries are keyed by path and validated against the file's size, mtime and inode, so
+ * a modified file is recompiled. Bytecode is immutable once cached; readers hold a
+ * reference while deserializing so a stale entry can be replaced concurrently.
+ *
+ * Only used while workers exist, since a single runtime never loads a module twice. It's
+ * emptied when the last worker exits, and the least recently used entries are evicted to
+ * stay under the size cap.
+ */
+#define TJS__MODULE_CACHE_BUCKETS  256
+#define TJS__MODULE_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
+typedef struct tjs__module_cache_entry {
+    struct tjs__module_cache_entry *next;
+    int refs;
+    uint64_t last_used;
+    uint64_t size;
+    uint64_t ino;
+    uv_timespec_t mtime;
+    uint8_t *data;
+    size_t data_len;
+    char path[];
+} tjs__module_cache_entry_t;
+
+static struct {
+    uv_once_t once;
+    uv_mutex_t lock;
+    int workers;
+    uint64_t clock;
+    size_t total_size;
+    tjs__module_cache_entry_t *buckets[TJS__MODULE_CACHE_BUCKETS];
+} tjs__module_cache = { .once = UV_ONCE_INIT };
+
+static void tjs__module_cache_init_once(void) {
+    CHECK_EQ(uv_mutex_init(&tjs__module_cache.lock), 0);
+}
+
+static uint32_t tjs__module_cache_hash(const char *path) {
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    for (const char *p = path; *p; p++) {
+        h ^= (uint8_t) *p;
+        h *= 16777619u;
+    }
+    return h % TJS__MODULE_CACHE_BUCKETS;
+}
+
+/* Must be called with the lock held. */
+static void tjs__module_cache_entry_unref(tjs__module_cache_entry_t *e) {
+    if (--e->refs == 0) {
+        tjs__module_cache.total_size -= e->data_len;
+        tjs__free(e->data);
+        tjs__free(e);
+    }
+}
+
+static bool tjs__module_cache_entry_valid(tjs__module_cache_entry_t *e, const uv_stat_t *st) {
+    return e->size == st->st_size && e->ino == st->st_ino && e->mtime.tv_sec == st->st_mtim.tv_sec &&
+           e->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+static tjs__module_cache_entry_t *tjs__module_cache_get(const char *path, const uv_stat_t *st) {
+    uint32_t h = tjs__module_cache_hash(path);
+    tjs__module_cache_entry_t *found = NULL;
+
+    uv_mutex_lock(&tjs__module_cache.lock);
+    for (tjs__module_cache_entry_t *e = tjs__module_cache.buckets[h]; e; e = e->next) {
+        if (strcmp(e->path, path) == 0) {
+            if (tjs__module_cache_entry_valid(e, st)) {
+                e->refs++;
+                e->last_used = ++tjs__module_cache.clock;
+                found = e;
+            }
+            break;
+        }
+    }
+    uv_mutex_unlock(&tjs__module_cache.lock);
+
+    return found;
+}
+
+static void tjs__module_cache_release(tjs__module_cache_entry_t *e) {
+    uv_mutex_lock(&tjs__module_cache.lock);
+    tjs__module_cache_entry_unref(e);
+    uv_mutex_unlock(&tjs__module_cache.lock);
+}
+
+/* Must be called with the lock held. Returns false if the cache is empty. */
+static bool tjs__module_cache_evict_lru(void) {
+    tjs__module_cache_entry_t **lru = NULL;
+
+    for (int i = 0; i < TJS__MODULE_CACHE_BUCKETS; i++) {
+        for (tjs__module_cache_entry_t **pe = &tjs__module_cache.buckets[i]; *pe; pe = &(*pe)->next) {
+            if (!lru || (*pe)->last_used < (*lru)->last_used) {
+                lru = pe;
+            }
+        }
+    }
+
+    if (!lru) {
+        return false;
+    }
+
+    tjs__module_cache_entry_t *e = *lru;
+    *lru = e->next;
+    tjs__module_cache_entry_unref(e);
+
+    return true;
+}
+
+/* Must be called with the lock held. Entries still being read are freed by their last reader. */
+static void tjs__module_cache_clear(void) {
+    for (int i = 0; i < TJS__MODULE_CACHE_BUCKETS; i++) {
+        tjs__module_cache_entry_t *e = tjs__module_cache.buckets[i];
+        tjs__module_cache.buckets[i] = NULL;
+        while (e) {
+            tjs__module_cache_entry_t *next = e->next;
+            tjs__module_cache_entry_unref(e);
+            e = next;
+        }
+    }
+}
+
+void tjs__module_cache_worker_ref(void) {
+    uv_once(&tjs__module_cache.once, tjs__module_cache_init_once);
+    uv_mutex_lock(&tjs__module_cache.lock);
+    tjs__module_cache.workers++;
+    uv_mutex_unlock(&tjs__module_cache.lock);
+}
+
+void tjs__module_cache_worker_unref(void) {
+    uv_mutex_lock(&tjs__module_cache.lock);
+    if (--tjs__module_cache.workers == 0) {
+        tjs__module_cache_clear();
+    }
+    uv_mutex_unlock(&tjs__module_cache.lock);
+}
+
+static bool tjs__module_cache_enabled(void) {
+    uv_once(&tjs__module_cache.once, tjs__module_cache_init_once);
+    uv_mutex_lock(&tjs__module_cache.lock);
+    bool enabled = tjs__module_cache.workers > 0;
+    uv_mutex_unlock(&tjs__module_cache.lock);
+    return enabled;
+}
+
+static void tjs__module_cache_put(const char *path, const uv_stat_t *st, const uint8_t *data, size_t data_len) {
+    if (data_len > TJS__MODULE_CACHE_MAX_SIZE) {
+        return;
+    }
+
+    size_t path_len = strlen(path);
+    tjs__module_cache_entry_t *e = tjs__malloc(sizeof(*e) + path_len + 1);
+    if (!e) {
+        return;
+    }
+    e->data = tjs__malloc(data_len);
+    if (!e->data) {
+        tjs__free(e);
+        return;
+    }
+    memcpy(e->data, data, data_len);
+    memcpy(e->path, path, path_len + 1);
+    e->data_len = data_len;
+    e->refs = 1;
+    e->size = st->st_size;
+    e->ino = st->st_ino;
+    e->mtime = st->st_mtim;
+
+    uint32_t h = tjs__module_cache_hash(path);
+
+    uv_mutex_lock(&tjs__module_cache.lock);
+
+    /* Drop any stale entry for the same path. */
+    tjs__module_cache_entry_t **pe = &tjs__module_cache.buckets[h];
+    while (*pe) {
+        tjs__module_cache_entry_t *old = *pe;
+        if (strcmp(old->path, path) == 0) {
+            *pe = old->next;
+            tjs__module_cache_entry_unref(old);
+            break;
+        }
+        pe = &old->next;
+    }
+
+    /* The last worker may have exited while this was being compiled. */
+    if (tjs__module_cache.workers == 0) {
+        uv_mutex_unlock(&tjs__module_cache.lock);
+        tjs__free(e->data);
+        tjs__free(e);
+        return;
+    }
+
+    /* Entries still being read only give their space back once the last reader is done. */
+    while (tjs__module_cache.total_size + data_len > TJS__MODULE_CACHE_MAX_SIZE && tjs__module_cache_evict_lru()) {
+    }
+
+    e->last_used = ++tjs__module_cache.clock;
+    tjs__module_cache.total_size += data_len;
+    e->next = tjs__module_cache.buckets[h];
+    tjs__module_cache.buckets[h] = e;
+
+    uv_mutex_unlock(&tjs__module_cache.lock);
+}
+
+
 // JSModuleDef *tjs__load_http(JSContext *ctx, const char *url) {
 //     JSModuleDef *m;
 //     DynBuf dbuf;
@@ -93,6 +300,33 @@ JSModuleDef *tjs_module_loader(JSContext *ctx, const char *module_name, void *op
         return NULL;
     }
 
+    uv_once(&tjs__module_cache.once, tjs__module_cache_init_once);
+
+    /* Try the bytecode cache first, another runtime may have compiled this module already. */
+    uv_fs_t stat_req;
+    uv_stat_t st;
+    bool cacheable = tjs__module_cache_enabled();
+    if (cacheable) {
+        cacheable = uv_fs_stat(NULL, &stat_req, module_name, NULL) == 0;
+        if (cacheable) {
+            st = stat_req.statbuf;
+        }
+        uv_fs_req_cleanup(&stat_req);
+    }
+
+    if (cacheable) {
+        tjs__module_cache_entry_t *e = tjs__module_cache_get(module_name, &st);
+        if (e) {
+            func_val = JS_ReadObject(ctx, e->data, e->data_len, JS_READ_OBJ_BYTECODE);
+            tjs__module_cache_release(e);
+            if (JS_IsException(func_val)) {
+                return NULL;
+            }
+            CHECK_EQ(JS_VALUE_GET_TAG(func_val), JS_TAG_MODULE);
+            goto done;
+        }
+    }
+
     tjs_dbuf_init(ctx, &dbuf);
 
     is_json = js__has_suffix(module_name, ".json");
@@ -125,6 +359,19 @@ JSModuleDef *tjs_module_loader(JSContext *ctx, const char *module_name, void *op
         return NULL;
     }
 
+    if (cacheable) {
+        size_t len;
+        uint8_t *buf = JS_WriteObject(ctx, &len, func_val, JS_WRITE_OBJ_BYTECODE);
+        if (buf) {
+            tjs__module_cache_put(module_name, &st, buf, len);
+            js_free(ctx, buf);
+        } else {
+            /* Not fatal, the module just won't be cached. */
+            JS_FreeValue(ctx, JS_GetException(ctx));
+        }
+    }
+
+done:
     /* XXX: could propagate the exception */
     js_module_set_import_meta(ctx, func_val, TRUE, FALSE);
     /* the module is already referenced, so we must free it */
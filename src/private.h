@@ -92,6 +92,7 @@ void tjs__mod_udp_init(JSContext *ctx, JSValue ns);
 #ifdef TJS__HAS_WASM
 void tjs__mod_wasm_init(JSContext *ctx, JSValue ns);
 #endif
+void tjs__mod_walk_init(JSContext *ctx, JSValue ns);
 void tjs__mod_worker_init(JSContext *ctx, JSValue ns);
 void tjs__mod_ws_init(JSContext *ctx, JSValue ns);
 void tjs__mod_xhr_init(JSContext *ctx, JSValue ns);
@@ -103,6 +104,8 @@ void tjs__mod_posix_socket_init(JSContext *ctx, JSValue ns);
 JSValue tjs_new_error(JSContext *ctx, int err);
 JSValue tjs_throw_errno(JSContext *ctx, int err);
 
+JSValue tjs_new_stat(JSContext *ctx, uv_stat_t *st);
+
 JSValue tjs_new_pipe(JSContext *ctx);
 uv_stream_t *tjs_pipe_get_stream(JSContext *ctx, JSValue obj);
 
@@ -111,6 +114,8 @@ JSModuleDef *tjs__load_builtin(JSContext *ctx, const char *name);
 int tjs__load_file(JSContext *ctx, DynBuf *dbuf, const char *filename);
 JSModuleDef *tjs_module_loader(JSContext *ctx, const char *module_name, void *opaque);
 char *tjs_module_normalizer(JSContext *ctx, const char *base_name, const char *name, void *opaque);
+void tjs__module_cache_worker_ref(void);
+void tjs__module_cache_worker_unref(void);
 
 int js_module_set_import_meta(JSContext *ctx, JSValue func_val, JS_BOOL use_realpath, JS_BOOL is_main);
 
@@ -120,11 +125,24 @@ int tjs__eval_bytecode(JSContext *ctx, const uint8_t *buf, size_t buf_len, bool
 
 void tjs__destroy_timers(TJSRuntime *qrt);
 
+/* Returns false if obj is not a file handle. The descriptor is -1 once the file is closed. */
+bool tjs__file_fileno(JSValue obj, uv_file *fd);
+
+/* Precedes the data of every SharedArrayBuffer. Buffers not allocated by the
+ * runtime (e.g. memory mapped files) set a release function.
+ */
+typedef struct TJSSABHeader {
+    int ref_count;
+    void (*release)(struct TJSSABHeader *sab);
+    uint8_t buf[0];
+} TJSSABHeader;
+
+void *tjs__sab_alloc(void *opaque, size_t size);
 void tjs__sab_free(void *opaque, void *ptr);
 void tjs__sab_dup(void *opaque, void *ptr);
 
 uv_loop_t *TJS_GetLoop(TJSRuntime *qrt);
-TJSRuntime *TJS_NewRuntimeWorker(void);
+TJSRuntime *TJS_NewRuntimeWorker(TJSRunOptions *options);
 TJSRuntime *TJS_NewRuntimeInternal(bool is_worker, TJSRunOptions *options);
 JSValue TJS_EvalScript(JSContext *ctx, const char *filename);
 JSValue TJS_EvalModule(JSContext *ctx, const char *filename, bool is_main);
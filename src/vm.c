@@ -67,21 +67,17 @@ static const JSMallocFunctions tjs_mf = {
 
 /* SharedArrayBuffer functions */
 
-typedef struct {
-    int ref_count;
-    uint8_t buf[0];
-} TJSSABHeader;
-
 static int atomic_add_int(int *ptr, int v) {
     return atomic_fetch_add((_Atomic(uint32_t) *) ptr, v) + v;
 }
 
-static void *tjs__sab_alloc(void *opaque, size_t size) {
+void *tjs__sab_alloc(void *opaque, size_t size) {
     TJSSABHeader *sab = tjs__malloc(sizeof(*sab) + size);
     if (!sab) {
         return NULL;
     }
     sab->ref_count = 1;
+    sab->release = NULL;
     return sab->buf;
 }
 
@@ -90,7 +86,11 @@ void tjs__sab_free(void *opaque, void *ptr) {
     int ref_count = atomic_add_int(&sab->ref_count, -1);
     assert(ref_count >= 0);
     if (ref_count == 0) {
-        tjs__free(sab);
+        if (sab->release) {
+            sab->release(sab);
+        } else {
+            tjs__free(sab);
+        }
     }
 }
 
@@ -139,6 +139,7 @@ static void tjs__bootstrap_core(JSContext *ctx, JSValue ns) {
 #ifdef TJS__HAS_WASM
     tjs__mod_wasm_init(ctx, ns);
 #endif
+    tjs__mod_walk_init(ctx, ns);
     tjs__mod_worker_init(ctx, ns);
     // tjs__mod_ws_init(ctx, ns);
     // tjs__mod_xhr_init(ctx, ns);
@@ -239,10 +240,8 @@ TJSRuntime *TJS_NewRuntimeOptions(TJSRunOptions *options) {
     return TJS_NewRuntimeInternal(false, options);
 }
 
-TJSRuntime *TJS_NewRuntimeWorker(void) {
-    TJSRunOptions options;
-    TJS_DefaultOptions(&options);
-    return TJS_NewRuntimeInternal(true, &options);
+TJSRuntime *TJS_NewRuntimeWorker(TJSRunOptions *options) {
+    return TJS_NewRuntimeInternal(true, options);
 }
 
 TJSRuntime *TJS_NewRuntimeInternal(bool is_worker, TJSRunOptions *options) {
@@ -520,23 +519,38 @@ int tjs__load_file(JSContext *ctx, DynBuf *dbuf, const char *filename) {
     }
 
     fd = r;
-    char buf[64 * 1024];
-    uv_buf_t b = uv_buf_init(buf, sizeof(buf));
-    size_t offset = 0;
+
+    /* Presize the buffer so regular files are read straight into it with a single allocation.
+     * The extra byte lets the final EOF read (and the callers' NUL terminator) fit without growing.
+     * Files which don't report their size (procfs, pipes) grow the buffer as they are read. */
+    r = uv_fs_fstat(NULL, &req, fd, NULL);
+    size_t size_hint = r == 0 ? req.statbuf.st_size : 0;
+    uv_fs_req_cleanup(&req);
+
+    if (dbuf_realloc(dbuf, dbuf->size + size_hint + 1)) {
+        r = UV_ENOMEM;
+        goto end;
+    }
+
+    int64_t offset = 0;
 
     do {
+        if (dbuf->size == dbuf->allocated_size && dbuf_realloc(dbuf, dbuf->allocated_size + 64 * 1024)) {
+            r = UV_ENOMEM;
+            break;
+        }
+        size_t avail = dbuf->allocated_size - dbuf->size;
+        uv_buf_t b = uv_buf_init((char *) dbuf->buf + dbuf->size, avail > INT32_MAX ? INT32_MAX : avail);
         r = uv_fs_read(NULL, &req, fd, &b, 1, offset, NULL);
         uv_fs_req_cleanup(&req);
         if (r <= 0) {
             break;
         }
         offset += r;
-        r = dbuf_put(dbuf, (const uint8_t *) b.base, r);
-        if (r != 0) {
-            break;
-        }
+        dbuf->size += r;
     } while (1);
 
+end:
     uv_fs_close(NULL, &req, fd, NULL);
     uv_fs_req_cleanup(&req);
 
@@ -33,6 +33,22 @@
 #else
 #include <unistd.h>
 #endif
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+#if !defined(_WIN32)
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <time.h>
+#endif
+
+/* How often (in ms) a worker samples its own heap usage. */
+#define TJS__WORKER_STATS_INTERVAL 1000
+
+/* Native stack reserved for a worker thread on top of its JS stack limit. */
+#define TJS__WORKER_STACK_HEADROOM (1024 * 1024)
 
 extern const uint8_t tjs__worker_bootstrap[];
 extern const uint32_t tjs__worker_bootstrap_size;
@@ -45,8 +61,16 @@ enum {
 
 static JSClassID tjs_msgpipe_class_id;
 
+/* A complete, still serialized, message. */
+typedef struct TJSMessagePipeMsg {
+    struct TJSMessagePipeMsg *next;
+    uint8_t *data;
+    uint64_t len;
+} TJSMessagePipeMsg;
+
 typedef struct {
     JSContext *ctx;
+    JSValue obj; /* Weak reference, the handle is closed when the object is finalized. */
     union {
         uv_handle_t handle;
         uv_stream_t stream;
@@ -61,6 +85,17 @@ typedef struct {
         uint64_t nread;
     } reading;
     JSValue events[MSGPIPE_EVENT_MAX];
+    /* Messages read by the loop but not dispatched yet, so they can also be received synchronously. */
+    struct {
+        TJSMessagePipeMsg *head;
+        TJSMessagePipeMsg *tail;
+    } queue;
+    struct {
+        uint64_t messages_in;
+        uint64_t messages_out;
+        uint64_t bytes_in;
+        uint64_t bytes_out;
+    } stats;
 } TJSMessagePipe;
 
 typedef struct {
@@ -84,6 +119,15 @@ static void tjs_msgpipe_finalizer(JSRuntime *rt, JSValue val) {
         for (int i = 0; i < MSGPIPE_EVENT_MAX; i++) {
             JS_FreeValueRT(rt, p->events[i]);
         }
+        while (p->queue.head) {
+            TJSMessagePipeMsg *msg = p->queue.head;
+            p->queue.head = msg->next;
+            js_free_rt(rt, msg->data);
+            js_free_rt(rt, msg);
+        }
+        if (p->reading.data) {
+            js_free_rt(rt, p->reading.data);
+        }
         uv_close(&p->h.handle, uv__close_cb);
     }
 }
@@ -148,39 +192,25 @@ static void uv__alloc_cb(uv_handle_t *handle, size_t suggested_size, uv_buf_t *b
     }
 }
 
-static void uv__read_cb(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf) {
-    TJSMessagePipe *p = handle->data;
-    CHECK_NOT_NULL(p);
-
+/* Account for nread bytes read into the buffer given by uv__alloc_cb. Returns true when a complete
+ * message is available, in which case ownership of its data is passed to the caller.
+ */
+static bool msgpipe_consume(TJSMessagePipe *p, ssize_t nread, uint8_t **data, uint64_t *len) {
     JSContext *ctx = p->ctx;
 
-    if (nread < 0) {
-        uv_read_stop(&p->h.stream);
-        if (p->reading.data) {
-            js_free(ctx, p->reading.data);
-        }
-        memset(&p->reading, 0, sizeof(p->reading));
-        if (nread != UV_EOF) {
-            JSValue error = tjs_new_error(ctx, nread);
-            emit_msgpipe_event(p, MSGPIPE_EVENT_MESSAGE_ERROR, error);
-            JS_FreeValue(ctx, error);
-        }
-        return;
-    }
-
     if (!p->reading.data) {
         size_t len_size = sizeof(p->reading.total_size.u8);
 
         /* This is a bogus read, likely a zero-read. Just return the buffer. */
         if (nread != len_size) {
-            return;
+            return false;
         }
 
         uint64_t total_size = p->reading.total_size.u64;
         CHECK_GE(total_size, 0);
         p->reading.data = js_malloc(ctx, total_size);
 
-        return;
+        return false;
     }
 
     /* We are continuing a partial read. */
@@ -190,29 +220,186 @@ static void uv__read_cb(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf)
     if (p->reading.nread < total_size) {
         /* We still need to read more. */
 
-        return;
+        return false;
     }
 
     CHECK_EQ(p->reading.nread, total_size);
 
     /* We have a complete buffer now. */
+    p->stats.messages_in++;
+    p->stats.bytes_in += total_size;
+
+    *data = p->reading.data;
+    *len = total_size;
+    memset(&p->reading, 0, sizeof(p->reading));
+
+    return true;
+}
+
+/* Deserializes a message, taking ownership of its data. */
+static JSValue msgpipe_decode(JSContext *ctx, uint8_t *data, uint64_t len) {
     JSSABTab sab_tab;
     int flags = JS_READ_OBJ_SAB | JS_READ_OBJ_REFERENCE;
-    JSValue obj = JS_ReadObject2(ctx, (const uint8_t *) p->reading.data, total_size, flags, &sab_tab);
+    JSValue obj = JS_ReadObject2(ctx, (const uint8_t *) data, len, flags, &sab_tab);
+
+    if (!JS_IsException(obj)) {
+        /* Decrement the SAB reference counts. */
+        for (int i = 0; i < sab_tab.len; i++) {
+            tjs__sab_free(NULL, sab_tab.tab[i]);
+        }
+    }
+
+    js_free(ctx, data);
+
+    return obj;
+}
+
+static JSValue dispatch_msgpipe_message(JSContext *ctx, int argc, JSValue *argv) {
+    CHECK_EQ(argc, 1);
+
+    TJSMessagePipe *p = JS_GetOpaque(argv[0], tjs_msgpipe_class_id);
+    TJSMessagePipeMsg *msg = p ? p->queue.head : NULL;
+
+    /* The message might have been received synchronously already. Without a handler, keep it queued. */
+    if (!msg || !JS_IsFunction(ctx, p->events[MSGPIPE_EVENT_MESSAGE])) {
+        return JS_UNDEFINED;
+    }
+
+    p->queue.head = msg->next;
+    if (!p->queue.head) {
+        p->queue.tail = NULL;
+    }
+
+    JSValue obj = msgpipe_decode(ctx, msg->data, msg->len);
+    js_free(ctx, msg);
+
     if (JS_IsException(obj)) {
-        emit_msgpipe_event(p, MSGPIPE_EVENT_MESSAGE_ERROR, JS_GetException(ctx));
+        JSValue error = JS_GetException(ctx);
+        emit_msgpipe_event(p, MSGPIPE_EVENT_MESSAGE_ERROR, error);
+        JS_FreeValue(ctx, error);
     } else {
-        emit_msgpipe_event(p, MSGPIPE_EVENT_MESSAGE, obj);
+        JSValue func = JS_DupValue(ctx, p->events[MSGPIPE_EVENT_MESSAGE]);
+        tjs_call_handler(ctx, func, 1, &obj);
+        JS_FreeValue(ctx, func);
+        JS_FreeValue(ctx, obj);
     }
-    JS_FreeValue(ctx, obj);
 
-    /* Decrement the SAB reference counts. */
-    for (int i = 0; i < sab_tab.len; i++) {
-        tjs__sab_free(NULL, sab_tab.tab[i]);
+    return JS_UNDEFINED;
+}
+
+static void uv__read_cb(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf) {
+    TJSMessagePipe *p = handle->data;
+    CHECK_NOT_NULL(p);
+
+    JSContext *ctx = p->ctx;
+
+    if (nread < 0) {
+        uv_read_stop(&p->h.stream);
+        if (p->reading.data) {
+            js_free(ctx, p->reading.data);
+        }
+        memset(&p->reading, 0, sizeof(p->reading));
+        if (nread != UV_EOF) {
+            JSValue error = tjs_new_error(ctx, nread);
+            emit_msgpipe_event(p, MSGPIPE_EVENT_MESSAGE_ERROR, error);
+            JS_FreeValue(ctx, error);
+        }
+        return;
     }
 
-    js_free(ctx, p->reading.data);
-    memset(&p->reading, 0, sizeof(p->reading));
+    uint8_t *data;
+    uint64_t len;
+    if (!msgpipe_consume(p, nread, &data, &len)) {
+        return;
+    }
+
+    TJSMessagePipeMsg *msg = js_malloc(ctx, sizeof(*msg));
+    if (!msg) {
+        js_free(ctx, data);
+        return;
+    }
+
+    msg->next = NULL;
+    msg->data = data;
+    msg->len = len;
+    if (p->queue.tail) {
+        p->queue.tail->next = msg;
+    } else {
+        p->queue.head = msg;
+    }
+    p->queue.tail = msg;
+
+    JSValue arg = JS_DupValue(ctx, p->obj);
+    CHECK_EQ(JS_EnqueueJob(ctx, dispatch_msgpipe_message, 1, &arg), 0);
+    JS_FreeValue(ctx, arg);
+}
+
+#if defined(_WIN32)
+#define msgpipe_sock_errno()     uv_translate_sys_error(WSAGetLastError())
+#define msgpipe_sock_poll(fds, timeout) WSAPoll(fds, 1, timeout)
+#else
+#define msgpipe_sock_errno()     (-errno)
+#define msgpipe_sock_poll(fds, timeout) poll(fds, 1, timeout)
+#endif
+
+/* Read a message straight from the socket, bypassing the loop. A negative timeout blocks forever.
+ * Returns 1 if a message was read, 0 if none arrived in time, or a negative error code.
+ */
+static int msgpipe_read_sync(TJSMessagePipe *p, int64_t timeout, uint8_t **data, uint64_t *len) {
+    uv_os_fd_t fd;
+    int r = uv_fileno(&p->h.handle, &fd);
+    if (r != 0) {
+        return r;
+    }
+
+    uint64_t deadline = timeout > 0 ? uv_hrtime() + (uint64_t) timeout * 1000000 : 0;
+
+    for (;;) {
+        uv_buf_t buf;
+        uv__alloc_cb(&p->h.handle, 65536, &buf);
+
+        ssize_t nread = recv((uv_os_sock_t) fd, buf.base, buf.len, 0);
+        if (nread > 0) {
+            if (msgpipe_consume(p, nread, data, len)) {
+                return 1;
+            }
+            continue;
+        }
+
+        if (nread == 0) {
+            return UV_EOF;
+        }
+
+        r = msgpipe_sock_errno();
+        if (r == UV_EINTR) {
+            continue;
+        }
+        if (r != UV_EAGAIN) {
+            return r;
+        }
+
+        if (timeout == 0) {
+            return 0;
+        }
+
+        int poll_timeout = -1;
+        if (timeout > 0) {
+            uint64_t now = uv_hrtime();
+            if (now >= deadline) {
+                return 0;
+            }
+            poll_timeout = (int) ((deadline - now + 999999) / 1000000);
+        }
+
+        struct pollfd pfd = { .fd = (uv_os_sock_t) fd, .events = POLLIN };
+        r = msgpipe_sock_poll(&pfd, poll_timeout);
+        if (r < 0) {
+            r = msgpipe_sock_errno();
+            if (r != UV_EINTR) {
+                return r;
+            }
+        }
+    }
 }
 
 static JSValue tjs_new_msgpipe(JSContext *ctx, uv_os_sock_t fd) {
@@ -228,6 +415,7 @@ static JSValue tjs_new_msgpipe(JSContext *ctx, uv_os_sock_t fd) {
     }
 
     p->ctx = ctx;
+    p->obj = obj;
     p->h.handle.data = p;
     p->events[0] = JS_UNDEFINED;
     p->events[1] = JS_UNDEFINED;
@@ -299,9 +487,61 @@ static JSValue tjs_msgpipe_postmessage(JSContext *ctx, JSValue this_val, int arg
         tjs__sab_dup(NULL, sab_tab.tab[i]);
     }
 
+    p->stats.messages_out++;
+    p->stats.bytes_out += len;
+
     return JS_UNDEFINED;
 }
 
+static JSValue tjs_msgpipe_receive(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSMessagePipe *p = tjs_msgpipe_get(ctx, this_val);
+    if (!p) {
+        return JS_EXCEPTION;
+    }
+
+    int64_t timeout = 0;
+    if (!JS_IsUndefined(argv[0]) && JS_ToInt64(ctx, &timeout, argv[0])) {
+        return JS_EXCEPTION;
+    }
+
+    if (timeout != 0 && !TJS_GetRuntime(ctx)->is_worker) {
+        return JS_ThrowTypeError(ctx, "blocking receive is only allowed in workers");
+    }
+
+    uint8_t *data;
+    uint64_t len;
+
+    /* Messages already read by the loop go first, to preserve ordering. */
+    TJSMessagePipeMsg *msg = p->queue.head;
+    if (msg) {
+        p->queue.head = msg->next;
+        if (!p->queue.head) {
+            p->queue.tail = NULL;
+        }
+        data = msg->data;
+        len = msg->len;
+        js_free(ctx, msg);
+    } else {
+        int r = msgpipe_read_sync(p, timeout, &data, &len);
+        if (r == 0 || r == UV_EOF) {
+            return JS_UNDEFINED;
+        }
+        if (r < 0) {
+            return tjs_throw_errno(ctx, r);
+        }
+    }
+
+    JSValue message = msgpipe_decode(ctx, data, len);
+    if (JS_IsException(message)) {
+        return JS_EXCEPTION;
+    }
+
+    JSValue obj = JS_NewObject(ctx);
+    JS_DefinePropertyValueStr(ctx, obj, "message", message, JS_PROP_C_W_E);
+
+    return obj;
+}
+
 static JSValue tjs_msgpipe_event_get(JSContext *ctx, JSValue this_val, int magic) {
     TJSMessagePipe *p = tjs_msgpipe_get(ctx, this_val);
     if (!p) {
@@ -324,6 +564,7 @@ static JSValue tjs_msgpipe_event_set(JSContext *ctx, JSValue this_val, JSValue v
 
 static const JSCFunctionListEntry tjs_msgpipe_proto_funcs[] = {
     TJS_CFUNC_DEF("postMessage", 1, tjs_msgpipe_postmessage),
+    TJS_CFUNC_DEF("receive", 1, tjs_msgpipe_receive),
     JS_CGETSET_MAGIC_DEF("onmessage", tjs_msgpipe_event_get, tjs_msgpipe_event_set, MSGPIPE_EVENT_MESSAGE),
     JS_CGETSET_MAGIC_DEF("onmessageerror", tjs_msgpipe_event_get, tjs_msgpipe_event_set, MSGPIPE_EVENT_MESSAGE_ERROR),
 };
@@ -332,12 +573,30 @@ static JSValue tjs_new_worker(JSContext *ctx, uv_os_sock_t channel_fd);
 
 static JSClassID tjs_worker_class_id;
 
+/* Stats shared between a worker thread and its parent. Once the parent first asks for them, the worker
+ * samples its heap periodically and the parent reads them. Both sides hold a reference.
+ */
+typedef struct {
+    uv_mutex_t lock;
+    int refs;
+    bool exited;
+    bool sampling;
+    uv_async_t *wakeup; /* Starts the sampling on the worker's loop, NULL once it's gone. */
+    uint64_t cpu_time;
+    int64_t heap_size;
+    int64_t heap_used;
+    int64_t heap_limit;
+} TJSWorkerStats;
+
 typedef struct {
     const char *specifier;
     const char *source;
+    const char *name;
+    TJSRunOptions options;
     uv_os_sock_t channel_fd;
     uv_sem_t *sem;
     TJSRuntime *wrt;
+    TJSWorkerStats *stats;
 } worker_data_t;
 
 typedef struct {
@@ -345,8 +604,101 @@ typedef struct {
     uv_thread_t tid;
     JSValue message_pipe;
     TJSRuntime *wrt;
+    TJSWorkerStats *stats;
 } TJSWorker;
 
+typedef struct {
+    uv_timer_t timer;
+    uv_async_t async;
+    TJSRuntime *wrt;
+    TJSWorkerStats *stats;
+} TJSWorkerSampler;
+
+static TJSWorkerStats *tjs__worker_stats_new(void) {
+    TJSWorkerStats *s = tjs__mallocz(sizeof(*s));
+    CHECK_NOT_NULL(s);
+    CHECK_EQ(uv_mutex_init(&s->lock), 0);
+    s->refs = 2;
+
+    return s;
+}
+
+static void tjs__worker_stats_unref(TJSWorkerStats *s) {
+    uv_mutex_lock(&s->lock);
+    int refs = --s->refs;
+    uv_mutex_unlock(&s->lock);
+
+    if (refs == 0) {
+        uv_mutex_destroy(&s->lock);
+        tjs__free(s);
+    }
+}
+
+/* CPU time consumed by the given thread, in microseconds. Returns a negative error code on failure. */
+static int tjs__thread_cpu_time(uv_thread_t *tid, uint64_t *usec) {
+#if defined(_WIN32)
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (!GetThreadTimes(*tid, &creation_time, &exit_time, &kernel_time, &user_time)) {
+        return uv_translate_sys_error(GetLastError());
+    }
+    uint64_t k = ((uint64_t) kernel_time.dwHighDateTime << 32) | kernel_time.dwLowDateTime;
+    uint64_t u = ((uint64_t) user_time.dwHighDateTime << 32) | user_time.dwLowDateTime;
+    /* FILETIME is expressed in 100ns units. */
+    *usec = (k + u) / 10;
+    return 0;
+#elif defined(__APPLE__)
+    mach_port_t port = pthread_mach_thread_np(*tid);
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    if (thread_info(port, THREAD_BASIC_INFO, (thread_info_t) &info, &count) != KERN_SUCCESS) {
+        return UV_EINVAL;
+    }
+    *usec = (uint64_t) info.user_time.seconds * 1000000 + info.user_time.microseconds +
+            (uint64_t) info.system_time.seconds * 1000000 + info.system_time.microseconds;
+    return 0;
+#else
+    clockid_t cid;
+    struct timespec ts;
+    int r = pthread_getcpuclockid(*tid, &cid);
+    if (r != 0) {
+        return -r;
+    }
+    if (clock_gettime(cid, &ts) != 0) {
+        return -errno;
+    }
+    *usec = (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    return 0;
+#endif
+}
+
+static void tjs__worker_sample(TJSRuntime *wrt, TJSWorkerStats *stats) {
+    JSMemoryUsage mu;
+    JS_ComputeMemoryUsage(JS_GetRuntime(TJS_GetJSContext(wrt)), &mu);
+
+    uv_mutex_lock(&stats->lock);
+    stats->heap_size = mu.malloc_size;
+    stats->heap_used = mu.memory_used_size;
+    stats->heap_limit = mu.malloc_limit;
+    uv_mutex_unlock(&stats->lock);
+}
+
+static void uv__sampler_timer_cb(uv_timer_t *handle) {
+    TJSWorkerSampler *sampler = handle->data;
+    CHECK_NOT_NULL(sampler);
+
+    tjs__worker_sample(sampler->wrt, sampler->stats);
+}
+
+/* Walking the heap isn't free, so it only starts once the parent asks for stats. */
+static void uv__sampler_async_cb(uv_async_t *handle) {
+    TJSWorkerSampler *sampler = handle->data;
+    CHECK_NOT_NULL(sampler);
+
+    if (!uv_is_active((uv_handle_t *) &sampler->timer)) {
+        CHECK_EQ(uv_timer_start(&sampler->timer, uv__sampler_timer_cb, 0, TJS__WORKER_STATS_INTERVAL), 0);
+    }
+}
+
 static JSValue worker_eval(JSContext *ctx, int argc, JSValue *argv) {
     const char *specifier;
     JSValue ret;
@@ -386,12 +738,17 @@ error:;
 static void worker_entry(void *arg) {
     worker_data_t *wd = arg;
 
-    TJSRuntime *wrt = TJS_NewRuntimeWorker();
+    TJSRuntime *wrt = TJS_NewRuntimeWorker(&wd->options);
     CHECK_NOT_NULL(wrt);
     JSContext *ctx = TJS_GetJSContext(wrt);
 
     /* Bootstrap the worker scope. */
     JSValue global_obj = JS_GetGlobalObject(ctx);
+    JS_DefinePropertyValueStr(ctx,
+                              global_obj,
+                              "name",
+                              JS_NewString(ctx, wd->name ? wd->name : ""),
+                              JS_PROP_CONFIGURABLE | JS_PROP_ENUMERABLE);
     JSValue message_pipe = tjs_new_msgpipe(ctx, wd->channel_fd);
     JSValue sym = JS_NewSymbol(ctx, "tjs.internal.worker.messagePipe", TRUE);
     JSAtom atom = JS_ValueToAtom(ctx, sym);
@@ -412,6 +769,18 @@ static void worker_entry(void *arg) {
     JS_FreeValue(ctx, source);
     JS_FreeValue(ctx, specifier);
 
+    /* Periodically sample the heap once the parent queries it. */
+    TJSWorkerSampler sampler = { .wrt = wrt, .stats = wd->stats };
+    CHECK_EQ(uv_timer_init(tjs_get_loop(ctx), &sampler.timer), 0);
+    sampler.timer.data = &sampler;
+    uv_unref((uv_handle_t *) &sampler.timer);
+    CHECK_EQ(uv_async_init(tjs_get_loop(ctx), &sampler.async, uv__sampler_async_cb), 0);
+    sampler.async.data = &sampler;
+    uv_unref((uv_handle_t *) &sampler.async);
+    uv_mutex_lock(&sampler.stats->lock);
+    sampler.stats->wakeup = &sampler.async;
+    uv_mutex_unlock(&sampler.stats->lock);
+
     /* Notify the caller we are setup.  */
     wd->wrt = wrt;
     uv_sem_post(wd->sem);
@@ -419,13 +788,36 @@ static void worker_entry(void *arg) {
 
     TJS_Run(wrt);
 
+    uv_mutex_lock(&sampler.stats->lock);
+    sampler.stats->wakeup = NULL;
+    uv_mutex_unlock(&sampler.stats->lock);
+    uv_close((uv_handle_t *) &sampler.async, NULL);
+    uv_close((uv_handle_t *) &sampler.timer, NULL);
+
+    /* Record the final figures, the thread will be gone once joined. */
+    tjs__worker_sample(wrt, sampler.stats);
+    uv_thread_t self = uv_thread_self();
+    uint64_t cpu_time = 0;
+    tjs__thread_cpu_time(&self, &cpu_time);
+    uv_mutex_lock(&sampler.stats->lock);
+    sampler.stats->cpu_time = cpu_time;
+    sampler.stats->exited = true;
+    uv_mutex_unlock(&sampler.stats->lock);
+    tjs__worker_stats_unref(sampler.stats);
+
     TJS_FreeRuntime(wrt);
+
+    /* Taken by the constructor. */
+    tjs__module_cache_worker_unref();
 }
 
 static void tjs_worker_finalizer(JSRuntime *rt, JSValue val) {
     TJSWorker *w = JS_GetOpaque(val, tjs_worker_class_id);
     if (w) {
         JS_FreeValueRT(rt, w->message_pipe);
+        if (w->stats) {
+            tjs__worker_stats_unref(w->stats);
+        }
     }
 }
 
@@ -471,9 +863,66 @@ static JSValue tjs_new_worker(JSContext *ctx, uv_os_sock_t channel_fd) {
     return obj;
 }
 
+static int tjs__worker_get_options(JSContext *ctx, JSValue opts, TJSRunOptions *options, const char **name) {
+    TJS_DefaultOptions(options);
+    *name = NULL;
+
+    if (!JS_IsObject(opts)) {
+        return 0;
+    }
+
+    JSValue js_mem_limit = JS_GetPropertyStr(ctx, opts, "memoryLimit");
+    if (!JS_IsUndefined(js_mem_limit)) {
+        uint64_t mem_limit;
+        int r = JS_ToIndex(ctx, &mem_limit, js_mem_limit);
+        JS_FreeValue(ctx, js_mem_limit);
+        if (r != 0) {
+            return -1;
+        }
+        if (mem_limit > INT_MAX) {
+            JS_ThrowRangeError(ctx, "memoryLimit is too large");
+            return -1;
+        }
+        options->mem_limit = (int) mem_limit;
+    }
+
+    JSValue js_stack_size = JS_GetPropertyStr(ctx, opts, "stackSize");
+    if (!JS_IsUndefined(js_stack_size)) {
+        uint64_t stack_size;
+        int r = JS_ToIndex(ctx, &stack_size, js_stack_size);
+        JS_FreeValue(ctx, js_stack_size);
+        if (r != 0) {
+            return -1;
+        }
+        if (stack_size > SIZE_MAX - TJS__WORKER_STACK_HEADROOM) {
+            JS_ThrowRangeError(ctx, "stackSize is too large");
+            return -1;
+        }
+        options->stack_size = stack_size;
+    }
+
+    JSValue js_name = JS_GetPropertyStr(ctx, opts, "name");
+    if (!JS_IsUndefined(js_name)) {
+        *name = JS_ToCString(ctx, js_name);
+        JS_FreeValue(ctx, js_name);
+        if (!*name) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 static JSValue tjs_worker_constructor(JSContext *ctx, JSValue new_target, int argc, JSValue *argv) {
+    TJSRunOptions options;
+    const char *name;
+    if (tjs__worker_get_options(ctx, argv[2], &options, &name) != 0) {
+        return JS_EXCEPTION;
+    }
+
     const char *specifier = JS_ToCString(ctx, argv[0]);
     if (!specifier) {
+        JS_FreeCString(ctx, name);
         return JS_EXCEPTION;
     }
 
@@ -481,6 +930,7 @@ static JSValue tjs_worker_constructor(JSContext *ctx, JSValue new_target, int ar
     int r = uv_socketpair(SOCK_STREAM, 0, fds, UV_NONBLOCK_PIPE, UV_NONBLOCK_PIPE);
     if (r != 0) {
         JS_FreeCString(ctx, specifier);
+        JS_FreeCString(ctx, name);
         return tjs_throw_errno(ctx, r);
     }
 
@@ -489,6 +939,7 @@ static JSValue tjs_worker_constructor(JSContext *ctx, JSValue new_target, int ar
         close(fds[0]);
         close(fds[1]);
         JS_FreeCString(ctx, specifier);
+        JS_FreeCString(ctx, name);
         return JS_EXCEPTION;
     }
 
@@ -500,13 +951,41 @@ static JSValue tjs_worker_constructor(JSContext *ctx, JSValue new_target, int ar
 
     const char *source = JS_IsUndefined(argv[1]) ? NULL : JS_ToCString(ctx, argv[1]);
 
+    w->stats = tjs__worker_stats_new();
+
     worker_data_t worker_data = { .channel_fd = fds[1],
                                   .specifier = specifier,
                                   .source = source,
+                                  .name = name,
+                                  .options = options,
                                   .sem = &sem,
-                                  .wrt = NULL };
+                                  .wrt = NULL,
+                                  .stats = w->stats };
+
+    /* The thread gets a real stack matching the JS limit, plus room for the native frames QuickJS doesn't
+     * account for. A limit of 0 disables the JS check, so the default thread stack is used then. */
+    uv_thread_options_t thread_opts = { .flags = UV_THREAD_NO_FLAGS };
+    if (options.stack_size > 0) {
+        thread_opts.flags |= UV_THREAD_HAS_STACK_SIZE;
+        thread_opts.stack_size = options.stack_size + TJS__WORKER_STACK_HEADROOM;
+    }
 
-    CHECK_EQ(uv_thread_create(&w->tid, worker_entry, (void *) &worker_data), 0);
+    /* Modules are shared through the bytecode cache while the worker lives. */
+    tjs__module_cache_worker_ref();
+
+    r = uv_thread_create_ex(&w->tid, &thread_opts, worker_entry, (void *) &worker_data);
+    if (r != 0) {
+        tjs__module_cache_worker_unref();
+        uv_sem_destroy(&sem);
+        close(fds[1]);
+        /* The worker's reference to the stats is never taken. */
+        tjs__worker_stats_unref(w->stats);
+        JS_FreeCString(ctx, specifier);
+        JS_FreeCString(ctx, source);
+        JS_FreeCString(ctx, name);
+        JS_FreeValue(ctx, obj);
+        return tjs_throw_errno(ctx, r);
+    }
 
     /* Wait for the worker to initialize. */
     uv_sem_wait(&sem);
@@ -514,6 +993,7 @@ static JSValue tjs_worker_constructor(JSContext *ctx, JSValue new_target, int ar
 
     JS_FreeCString(ctx, specifier);
     JS_FreeCString(ctx, source);
+    JS_FreeCString(ctx, name);
 
     uv_update_time(tjs_get_loop(ctx));
 
@@ -546,8 +1026,53 @@ static JSValue tjs_worker_get_msgpipe(JSContext *ctx, JSValue this_val) {
     return JS_DupValue(ctx, w->message_pipe);
 }
 
+static JSValue tjs_worker_stats(JSContext *ctx, JSValue this_val, int argc, JSValue *argv) {
+    TJSWorker *w = tjs_worker_get(ctx, this_val);
+    if (!w) {
+        return JS_EXCEPTION;
+    }
+
+    TJSWorkerStats *s = w->stats;
+    CHECK_NOT_NULL(s);
+
+    uv_mutex_lock(&s->lock);
+    if (!s->sampling && s->wakeup) {
+        s->sampling = true;
+        uv_async_send(s->wakeup);
+    }
+    uint64_t cpu_time = s->cpu_time;
+    int64_t heap_size = s->heap_size;
+    int64_t heap_used = s->heap_used;
+    int64_t heap_limit = s->heap_limit;
+    bool exited = s->exited;
+    uv_mutex_unlock(&s->lock);
+
+    /* While the thread is alive, read its CPU time directly so busy workers can be spotted. */
+    if (w->wrt && !exited) {
+        tjs__thread_cpu_time(&w->tid, &cpu_time);
+    }
+
+    TJSMessagePipe *p = tjs_msgpipe_get(ctx, w->message_pipe);
+    CHECK_NOT_NULL(p);
+
+    JSValue obj = JS_NewObjectProto(ctx, JS_NULL);
+    JS_DefinePropertyValueStr(ctx, obj, "cpuTime", JS_NewInt64(ctx, cpu_time), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "heapSize", JS_NewInt64(ctx, heap_size), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "heapUsed", JS_NewInt64(ctx, heap_used), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "heapLimit", JS_NewInt64(ctx, heap_limit), JS_PROP_C_W_E);
+    /* Seen from the worker: what the parent sends is what the worker receives. */
+    JS_DefinePropertyValueStr(ctx, obj, "messagesIn", JS_NewInt64(ctx, p->stats.messages_out), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "messagesOut", JS_NewInt64(ctx, p->stats.messages_in), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "bytesIn", JS_NewInt64(ctx, p->stats.bytes_out), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "bytesOut", JS_NewInt64(ctx, p->stats.bytes_in), JS_PROP_C_W_E);
+    JS_DefinePropertyValueStr(ctx, obj, "running", JS_NewBool(ctx, w->wrt && !exited), JS_PROP_C_W_E);
+
+    return obj;
+}
+
 static const JSCFunctionListEntry tjs_worker_proto_funcs[] = {
     TJS_CFUNC_DEF("terminate", 0, tjs_worker_terminate),
+    TJS_CFUNC_DEF("stats", 0, tjs_worker_stats),
     TJS_CGETSET_DEF("messagePipe", tjs_worker_get_msgpipe, NULL),
 };
 
@@ -563,7 +1088,7 @@ void tjs__mod_worker_init(JSContext *ctx, JSValue ns) {
     JS_SetClassProto(ctx, tjs_worker_class_id, proto);
 
     /* Worker object */
-    obj = JS_NewCFunction2(ctx, tjs_worker_constructor, "Worker", 2, JS_CFUNC_constructor, 0);
+    obj = JS_NewCFunction2(ctx, tjs_worker_constructor, "Worker", 3, JS_CFUNC_constructor, 0);
     JS_DefinePropertyValueStr(ctx, ns, "Worker", obj, JS_PROP_C_W_E);
 
     /* MessagePipe class */
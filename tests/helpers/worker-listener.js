@@ -0,0 +1,13 @@
+const encoder = new TextEncoder();
+
+addEventListener('message', async e => {
+    const listener = await tjs.listen('tcp', undefined, undefined, { fd: e.data });
+
+    postMessage('ready');
+
+    const conn = await listener.accept();
+
+    await conn.write(encoder.encode('hello from worker'));
+    conn.close();
+    listener.close();
+});
@@ -0,0 +1 @@
+postMessage(self.name);
@@ -0,0 +1,14 @@
+// Spin without yielding to the loop, polling for a control message.
+let count = 0;
+
+for (;;) {
+    const msg = tjs.receiveMessageOnPort(self, { timeout: 10 });
+
+    count++;
+
+    if (msg?.message === 'stop') {
+        break;
+    }
+}
+
+postMessage(count);
@@ -0,0 +1,14 @@
+function recurse(n) {
+    return n === 0 ? 0 : 1 + recurse(n - 1);
+}
+
+let depth = 1000;
+
+try {
+    for (;;) {
+        recurse(depth);
+        depth *= 2;
+    }
+} catch (e) {
+    postMessage({ depth, isRangeError: e instanceof RangeError });
+}
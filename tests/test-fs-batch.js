@@ -0,0 +1,68 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+const tmpDir = await tjs.makeTempDir('test_fsbatchXXXXXX');
+const N = 50;
+const files = [];
+
+for (let i = 0; i < N; i++) {
+    files.push(path.join(tmpDir, `file${i}`));
+}
+
+await tjs.fsBatch(files.map(p => ({ op: 'copyFile', path: import.meta.path, newPath: p })), { concurrency: 4 });
+
+// Stat everything, including a missing file.
+const missing = path.join(tmpDir, 'missing');
+const results = await tjs.fsBatch([ ...files, missing ].map(p => ({ op: 'stat', path: p })), { concurrency: 4 });
+
+assert.eq(results.length, N + 1, 'one result per operation');
+
+for (let i = 0; i < N; i++) {
+    assert.ok(results[i].isFile, 'stat result is returned');
+}
+
+assert.ok(results[N] instanceof Error, 'errors are returned, not thrown');
+assert.eq(results[N].code, 'ENOENT', 'error code is set');
+
+// Mixed operations depending on each other run in order by default.
+const dir = path.join(tmpDir, 'dir');
+const ordered = await tjs.fsBatch([
+    { op: 'mkdir', path: dir },
+    { op: 'rename', path: files[0], newPath: path.join(dir, 'moved') },
+    { op: 'realPath', path: path.join(dir, 'moved') },
+    { op: 'chmod', path: path.join(dir, 'moved'), mode: 0o600 },
+]);
+
+assert.eq(ordered[0], undefined, 'mkdir succeeded');
+assert.eq(ordered[1], undefined, 'rename succeeded');
+assert.eq(typeof ordered[2], 'string', 'realPath returns a string');
+assert.eq(ordered[3], undefined, 'chmod succeeded');
+
+// A chain longer than the concurrency cap, every step needs the previous one.
+const chain = [ { op: 'mkdir', path: path.join(tmpDir, 'c0') } ];
+
+for (let i = 1; i < 8; i++) {
+    chain.push({ op: 'rename', path: path.join(tmpDir, `c${i - 1}`), newPath: path.join(tmpDir, `c${i}`) });
+}
+
+chain.push({ op: 'rmdir', path: path.join(tmpDir, 'c7') });
+
+const chained = await tjs.fsBatch(chain);
+
+assert.ok(chained.every(r => r === undefined), 'dependent operations run in order');
+
+// Unlink everything.
+const unlinked = await tjs.fsBatch([
+    ...files.slice(1).map(p => ({ op: 'unlink', path: p })),
+    { op: 'unlink', path: path.join(dir, 'moved') },
+]);
+
+assert.ok(unlinked.every(r => r === undefined), 'all files are unlinked');
+assert.eq(await tjs.fsBatch([]), [], 'empty batch');
+
+assert.throws(() => tjs.fsBatch([ { op: 'nope', path: 'x' } ]), TypeError, 'invalid operation throws');
+assert.throws(() => tjs.fsBatch([ { op: 'rename', path: 'x' } ]), TypeError, 'missing newPath throws');
+assert.throws(() => tjs.fsBatch('foo'), TypeError, 'operations must be an array');
+
+await tjs.remove(tmpDir);
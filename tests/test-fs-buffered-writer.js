@@ -0,0 +1,101 @@
+import assert from 'tjs:assert';
+
+const encoder = new TextEncoder();
+const decoder = new TextDecoder();
+
+const file = await tjs.makeTempFile('testFile_XXXXXX');
+const path = file.path;
+
+const w = file.bufferedWriter({ highWaterMark: 1024 });
+
+assert.eq(w.highWaterMark, 1024, 'highWaterMark is set');
+assert.eq(w.bufferedAmount, 0, 'nothing is buffered');
+
+const expected = [];
+
+for (let i = 0; i < 10; i++) {
+    expected.push(`line${i}\n`);
+    assert.ok(w.write(`line${i}\n`), 'small writes stay below the high water mark');
+}
+
+const stat = await file.stat();
+
+assert.eq(stat.size, 0, 'small writes are buffered');
+assert.ok(w.bufferedAmount > 0, 'data is buffered');
+
+await w.flush();
+
+assert.eq(w.bufferedAmount, 0, 'flush writes all data');
+assert.eq(decoder.decode(await tjs.readFile(path)), expected.join(''), 'flushed data is written in order');
+
+// Back-pressure.
+const big = new Uint8Array(20 * 1024).fill(120);
+let writes = 0;
+
+for (let i = 0; i < 8; i++) {
+    writes++;
+
+    if (!w.write(big)) {
+        await w.ready;
+    }
+}
+
+assert.ok(w.bufferedAmount < w.highWaterMark, 'ready resolves below the high water mark');
+
+w.write(encoder.encode('end'));
+await w.sync();
+
+const data = await tjs.readFile(path);
+
+assert.eq(data.length, expected.join('').length + writes * big.length + 3, 'all data is written');
+assert.eq(decoder.decode(data.subarray(data.length - 3)), 'end', 'data is written in order');
+
+await w.close();
+
+assert.throws(() => w.write('foo'), TypeError, 'writing to a closed writer throws');
+
+// Timed flushes.
+const w2 = file.bufferedWriter({ flushInterval: 20 });
+
+w2.write('tick');
+await new Promise(resolve => setTimeout(resolve, 200));
+
+assert.eq(w2.bufferedAmount, 0, 'the timer flushes buffered data');
+assert.eq(decoder.decode((await tjs.readFile(path)).subarray(data.length)), 'tick', 'timed flush is written');
+
+assert.throws(() => w2.write(42), TypeError, 'data must be a string or buffer');
+
+await w2.close();
+
+// Data written while a flush is in flight still gets the timer.
+const w3 = file.bufferedWriter({ highWaterMark: 1024, flushInterval: 20 });
+
+w3.write(new Uint8Array(2048).fill(120));
+w3.write('tail');
+await new Promise(resolve => setTimeout(resolve, 200));
+
+assert.eq(w3.bufferedAmount, 0, 'the tail is flushed by the timer');
+
+await w3.close();
+
+assert.throws(() => file.bufferedWriter({ highWaterMark: 0 }), RangeError, 'highWaterMark must be positive');
+
+await file.close();
+await tjs.remove(path);
+
+// Flushing after the file is closed fails instead of using a stale fd.
+const file2 = await tjs.makeTempFile('testFile_XXXXXX');
+const path2 = file2.path;
+const w4 = file2.bufferedWriter();
+
+w4.write('lost');
+await file2.close();
+
+try {
+    await w4.flush();
+    assert.fail('flushing a closed file fails');
+} catch (err) {
+    assert.eq(err.code, 'EBADF', 'the file is closed');
+}
+
+await tjs.remove(path2);
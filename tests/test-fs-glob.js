@@ -0,0 +1,55 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+const tmpDir = await tjs.makeTempDir('test_globXXXXXX');
+const files = [
+    'README.md',
+    'src/main.c',
+    'src/main.h',
+    'src/util/str.c',
+    'src/util/str.js',
+    'src/.hidden.c',
+    'src/deps/dep.c',
+    'node_modules/pkg/index.js',
+    'docs/a1.txt',
+    'docs/z1.txt',
+];
+
+for (const file of files) {
+    const p = path.join(tmpDir, file);
+
+    await tjs.makeDir(path.dirname(p), { recursive: true });
+    await tjs.writeFile(p, file);
+}
+
+async function glob(patterns, options = {}) {
+    const result = [];
+
+    for await (const p of tjs.glob(patterns, { cwd: tmpDir, ...options })) {
+        result.push(p.replaceAll('\\', '/'));
+    }
+
+    return result.sort();
+}
+
+assert.eq(await glob('*.md'), [ 'README.md' ], 'top level match');
+assert.eq(await glob('src/*.{c,h}'), [ 'src/main.c', 'src/main.h' ], 'braces');
+assert.eq(await glob('src/**/*.c'), [ 'src/deps/dep.c', 'src/main.c', 'src/util/str.c' ], 'globstar');
+assert.eq(await glob('src/**/*.c', { dot: true }),
+    [ 'src/.hidden.c', 'src/deps/dep.c', 'src/main.c', 'src/util/str.c' ], 'dot');
+assert.eq(await glob('src/**/*.c', { ignore: [ 'src/deps' ] }), [ 'src/main.c', 'src/util/str.c' ], 'ignore');
+assert.eq(await glob('**/*.js', { ignore: '**/node_modules' }), [ 'src/util/str.js' ], 'ignore with globstar');
+assert.eq(await glob('docs/[a-m]?.txt'), [ 'docs/a1.txt' ], 'character classes');
+assert.eq(await glob([ '*.md', 'docs/*' ]), [ 'README.md', 'docs/a1.txt', 'docs/z1.txt' ], 'multiple patterns');
+assert.eq(await glob('src/*'), [ 'src/deps', 'src/main.c', 'src/main.h', 'src/util' ], 'directories match too');
+assert.eq(await glob('nope/**'), [], 'no matches');
+
+try {
+    await glob('*', { cwd: path.join(tmpDir, 'missing') });
+    assert.fail('a missing cwd must fail');
+} catch (e) {
+    assert.eq(e.code, 'ENOENT', 'missing cwd rejects');
+}
+
+await tjs.remove(tmpDir);
@@ -0,0 +1,90 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+const tmpDir = await tjs.makeTempDir('test_mapfileXXXXXX');
+const file = path.join(tmpDir, 'data');
+const encoder = new TextEncoder();
+const decoder = new TextDecoder();
+
+const f = await tjs.open(file, 'w');
+
+await f.write(encoder.encode('hello mapped world'));
+await f.close();
+
+// Whole file.
+const buf = await tjs.mapFile(file);
+
+assert.ok(buf instanceof ArrayBuffer, 'returns an ArrayBuffer');
+assert.eq(decoder.decode(new Uint8Array(buf)), 'hello mapped world', 'contents match');
+
+// Private mappings are copy-on-write.
+new Uint8Array(buf)[0] = 'j'.charCodeAt(0);
+assert.eq(decoder.decode(await tjs.readFile(file)), 'hello mapped world', 'private writes do not reach the file');
+
+tjs.unmapFile(buf);
+assert.eq(buf.byteLength, 0, 'unmapped buffer is detached');
+
+// Unaligned range.
+const range = await tjs.mapFile(file, { offset: 6, length: 6, advice: 'sequential' });
+
+assert.eq(decoder.decode(new Uint8Array(range)), 'mapped', 'range contents match');
+
+// Length is clamped to the file size.
+const tail = await tjs.mapFile(file, { offset: 13, length: 1000 });
+
+assert.eq(decoder.decode(new Uint8Array(tail)), 'world', 'length is clamped');
+
+// Read-write mappings write through.
+const rw = await tjs.mapFile(file, { mode: 'rw' });
+
+new Uint8Array(rw).set(encoder.encode('HELLO'));
+tjs.unmapFile(rw);
+assert.eq(decoder.decode(await tjs.readFile(file)), 'HELLO mapped world', 'writes reach the file');
+
+if (tjs.system.platform !== 'windows') {
+    const sab = await tjs.mapFile(file, { shared: true });
+
+    assert.ok(sab instanceof SharedArrayBuffer, 'returns a SharedArrayBuffer');
+    assert.eq(decoder.decode(new Uint8Array(sab).slice()), 'HELLO mapped world', 'shared contents match');
+
+    // Shared mappings are released by the garbage collector only.
+    assert.throws(() => tjs.unmapFile(sab), TypeError, 'shared mappings cannot be unmapped');
+    assert.eq(sab.byteLength, 18, 'the shared mapping is left alone');
+}
+
+// Empty files.
+const empty = path.join(tmpDir, 'empty');
+
+await (await tjs.open(empty, 'w')).close();
+const emptyBuf = await tjs.mapFile(empty);
+
+assert.eq(emptyBuf.byteLength, 0, 'empty file maps to an empty buffer');
+tjs.unmapFile(emptyBuf);
+
+// Errors.
+try {
+    await tjs.mapFile(path.join(tmpDir, 'missing'));
+    assert.fail('mapping a missing file must fail');
+} catch (e) {
+    assert.eq(e.code, 'ENOENT', 'missing file rejects');
+}
+
+try {
+    await tjs.mapFile(file, { offset: 1000 });
+    assert.fail('offset past the end must fail');
+} catch (e) {
+    assert.eq(e.code, 'EINVAL', 'offset past the end rejects');
+}
+
+assert.throws(() => tjs.mapFile(file, { mode: 'x' }), TypeError, 'invalid mode throws');
+assert.throws(() => tjs.unmapFile('foo'), TypeError, 'unmapFile expects a buffer');
+
+// Ordinary buffers are not touched.
+const plain = new ArrayBuffer(8);
+
+assert.throws(() => tjs.unmapFile(plain), TypeError, 'unmapFile expects a mapped buffer');
+assert.eq(plain.byteLength, 8, 'ordinary buffers are not detached');
+assert.throws(() => tjs.unmapFile(buf), TypeError, 'a mapping cannot be unmapped twice');
+
+await tjs.remove(tmpDir);
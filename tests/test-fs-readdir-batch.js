@@ -0,0 +1,55 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+const tmpDir = await tjs.makeTempDir('test_readdirXXXXXX');
+const N = 20;
+
+for (let i = 0; i < N; i++) {
+    const f = await tjs.open(path.join(tmpDir, `file${i}`), 'w');
+
+    await f.close();
+}
+
+await tjs.makeDir(path.join(tmpDir, 'dir'));
+
+// Iterate with a batch size smaller than the number of entries.
+const dirIter = await tjs.readDir(tmpDir, { batchSize: 3 });
+const iterNames = [];
+
+for await (const item of dirIter) {
+    iterNames.push(item.name);
+    assert.eq(item.isDirectory, item.name === 'dir', 'entry type is correct');
+}
+
+await dirIter.close();
+
+assert.eq(iterNames.length, N + 1, 'all entries are iterated');
+
+// withFileTypes alone doesn't change the return type.
+const dirIter2 = await tjs.readDir(tmpDir, { withFileTypes: false });
+
+assert.ok(!Array.isArray(dirIter2), 'returns a directory handle');
+assert.eq((await dirIter2.next()).done, false, 'the handle yields entries');
+await dirIter2.close();
+
+const names = await tjs.readDir(tmpDir, { all: true });
+
+assert.ok(Array.isArray(names), 'returns an array');
+assert.eq(names.length, N + 1, 'all names are returned');
+assert.eq([ ...names ].sort(), [ ...iterNames ].sort(), 'same entries are returned');
+assert.ok(names.every(n => typeof n === 'string'), 'names are strings');
+
+const names2 = await tjs.readDir(tmpDir, { all: true, withFileTypes: false });
+
+assert.eq([ ...names2 ].sort(), [ ...names ].sort(), 'withFileTypes: false returns names');
+
+const entries = await tjs.readDir(tmpDir, { all: true, withFileTypes: true });
+
+assert.eq(entries.length, N + 1, 'all entries are returned');
+assert.eq(entries.filter(e => e.isDirectory).length, 1, 'one directory');
+assert.eq(entries.filter(e => e.isFile).length, N, 'N files');
+
+assert.throws(() => tjs.readDir(tmpDir, { batchSize: 0 }), RangeError, 'batchSize must be positive');
+
+await tjs.remove(tmpDir);
@@ -0,0 +1,48 @@
+import assert from 'tjs:assert';
+
+const encoder = new TextEncoder();
+const decoder = new TextDecoder();
+
+const file = await tjs.makeTempFile('testFile_XXXXXX');
+const path = file.path;
+
+const parts = [ 'header|', 'payload|', 'trailer' ].map(s => encoder.encode(s));
+const nwritten = await file.writev(parts);
+
+assert.eq(nwritten, 22, 'all buffers are written');
+assert.eq(await file.writev([]), 0, 'writing no buffers is a no-op');
+
+// Positional writes.
+await file.writev([ encoder.encode('H'), encoder.encode('E') ], 0);
+
+const a = new Uint8Array(7);
+const b = new Uint8Array(8);
+const c = new Uint8Array(16);
+const nread = await file.readv([ a, b, c ], 0);
+
+assert.eq(nread, 22, 'all data is read');
+assert.eq(decoder.decode(a), 'HEader|', 'first buffer is filled');
+assert.eq(decoder.decode(b), 'payload|', 'second buffer is filled');
+assert.eq(decoder.decode(c.subarray(0, 7)), 'trailer', 'last buffer is partially filled');
+assert.eq(await file.readv([ new Uint8Array(4) ], 100), null, 'EOF is null');
+
+assert.throws(() => file.writev('foo'), TypeError, 'buffers must be an array');
+assert.throws(() => file.writev([ 'foo' ]), TypeError, 'buffers must be Uint8Arrays');
+
+await file.close();
+
+// The writable stream batches chunks queued while a write is in flight.
+const f2 = await tjs.open(path, 'w');
+const writer = f2.writable.getWriter();
+const expected = [];
+
+for (let i = 0; i < 100; i++) {
+    expected.push(`chunk${i};`);
+    writer.write(encoder.encode(`chunk${i};`));
+}
+
+await writer.close();
+
+assert.eq(decoder.decode(await tjs.readFile(path)), expected.join(''), 'stream chunks are written in order');
+
+await tjs.remove(path);
@@ -0,0 +1,102 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+const tmpDir = await tjs.makeTempDir('test_dirXXXXXX');
+const keepDir = await tjs.makeTempDir('test_dirXXXXXX');
+const root = path.join(tmpDir, 'tree');
+
+await tjs.writeFile(path.join(keepDir, 'keep'), 'keep');
+
+for (let i = 0; i < 20; i++) {
+    const dir = path.join(root, `d${i}`, 'e', 'f');
+
+    await tjs.makeDir(dir, { recursive: true });
+
+    for (let j = 0; j < 10; j++) {
+        await tjs.writeFile(path.join(dir, `file${j}`), 'data');
+        await tjs.writeFile(path.join(root, `d${i}`, `file${j}`), 'data');
+    }
+
+    if (tjs.system.platform !== 'windows') {
+        await tjs.symlink(keepDir, path.join(root, `d${i}`, 'link'), { type: 'directory' });
+    }
+}
+
+// Making an existing tree is a no-op.
+await tjs.makeDir(path.join(root, 'd0', 'e', 'f'), { recursive: true });
+
+await tjs.remove(root);
+
+let err;
+
+try {
+    await tjs.stat(root);
+} catch (e) {
+    err = e;
+}
+
+assert.eq(err?.code, 'ENOENT', 'the tree is gone');
+assert.eq(await tjs.readTextFile(path.join(keepDir, 'keep')), 'keep', 'symlinks are not followed');
+
+// Removing something that doesn't exist is fine.
+await tjs.remove(root);
+
+// Single files are removed too.
+const file = path.join(tmpDir, 'file');
+
+await tjs.writeFile(file, 'data');
+await tjs.remove(file);
+
+err = undefined;
+
+try {
+    await tjs.stat(file);
+} catch (e) {
+    err = e;
+}
+
+assert.eq(err?.code, 'ENOENT', 'the file is gone');
+
+// Parents can't be created under a file.
+await tjs.writeFile(file, 'data');
+
+err = undefined;
+
+try {
+    await tjs.makeDir(path.join(file, 'a', 'b'), { recursive: true });
+} catch (e) {
+    err = e;
+}
+
+assert.ok(err, 'making a directory under a file fails');
+
+// Several trees at once, more than the threadpool has threads.
+const trees = [];
+
+for (let i = 0; i < 8; i++) {
+    const tree = path.join(tmpDir, `tree${i}`);
+
+    for (let j = 0; j < 5; j++) {
+        await tjs.makeDir(path.join(tree, `d${j}`, 'e'), { recursive: true });
+        await tjs.writeFile(path.join(tree, `d${j}`, 'e', 'file'), 'data');
+    }
+
+    trees.push(tree);
+}
+
+await Promise.all(trees.map(tree => tjs.remove(tree)));
+
+for (const tree of trees) {
+    err = undefined;
+
+    try {
+        await tjs.stat(tree);
+    } catch (e) {
+        err = e;
+    }
+
+    assert.eq(err?.code, 'ENOENT', 'concurrent removals complete');
+}
+
+await tjs.remove(tmpDir);
+await tjs.remove(keepDir);
@@ -0,0 +1,49 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+const tmpDir = await tjs.makeTempDir('test_statmanyXXXXXX');
+const paths = [];
+
+for (let i = 0; i < 20; i++) {
+    const p = path.join(tmpDir, `file${i}`);
+
+    await tjs.writeFile(p, 'x'.repeat(i));
+    paths.push(p);
+}
+
+paths.push(path.join(tmpDir, 'missing'));
+
+const result = await tjs.statMany(paths);
+
+assert.ok(result.errors instanceof Int32Array, 'errors is an Int32Array');
+assert.ok(result.size instanceof BigUint64Array, 'size is a BigUint64Array');
+assert.ok(result.mtim instanceof Float64Array, 'mtim is a Float64Array');
+assert.ok(result.mode instanceof Uint32Array, 'mode is a Uint32Array');
+assert.eq(result.ino, undefined, 'fields not requested are missing');
+assert.eq(result.errors.length, paths.length, 'one item per path');
+
+for (let i = 0; i < 20; i++) {
+    const st = await tjs.stat(paths[i]);
+
+    assert.eq(result.errors[i], 0, 'stat succeeded');
+    assert.eq(result.size[i], BigInt(i), 'size matches');
+    assert.eq(Math.trunc(result.mtim[i]), st.mtim.getTime(), 'mtime matches');
+    assert.eq(result.mode[i], st.mode, 'mode matches');
+}
+
+assert.ok(result.errors[20] < 0, 'missing path has an error');
+assert.eq(new tjs.Error(result.errors[20]).code, 'ENOENT', 'error number maps to ENOENT');
+
+const inodes = await tjs.statMany(paths.slice(0, 2), { fields: [ 'ino', 'nlink' ] });
+
+assert.eq(Object.keys(inodes).sort(), [ 'errors', 'ino', 'nlink' ], 'only requested fields are returned');
+
+const empty = await tjs.statMany([]);
+
+assert.eq(empty.errors.length, 0, 'empty input');
+
+assert.throws(() => tjs.statMany(paths, { fields: [ 'nope' ] }), TypeError, 'invalid field throws');
+assert.throws(() => tjs.statMany('foo'), TypeError, 'paths must be an array');
+
+await tjs.remove(tmpDir);
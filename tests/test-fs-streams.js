@@ -21,3 +21,45 @@ const data = await tjs.readFile(path);
 assert.eq(decoder.decode(data), "hello world!");
 
 await tjs.remove(path);
+
+// Enough data to hit the writable's high water mark, files have no write queue to wait on.
+const file2 = await tjs.makeTempFile('testFile_XXXXXX');
+const path2 = file2.path;
+const CHUNK = new Uint8Array(64 * 1024).fill(42);
+const COUNT = 48;
+const writer = file2.writable.getWriter();
+
+for (let i = 0; i < COUNT; i++) {
+    await writer.ready;
+    writer.write(CHUNK);
+}
+
+await writer.close();
+
+const data2 = await tjs.readFile(path2);
+
+assert.eq(data2.length, CHUNK.length * COUNT, 'all data is written');
+assert.ok(data2.every(v => v === 42), 'contents match');
+
+await tjs.remove(path2);
+
+// A buffer reused and mutated right after each awaited write.
+const file3 = await tjs.makeTempFile('testFile_XXXXXX');
+const path3 = file3.path;
+const buf = new Uint8Array(1024);
+const writer3 = file3.writable.getWriter();
+
+for (let i = 0; i < 16; i++) {
+    buf.fill(i);
+    await writer3.write(buf);
+    buf.fill(255);
+}
+
+await writer3.close();
+
+const data3 = await tjs.readFile(path3);
+
+assert.eq(data3.length, buf.length * 16, 'all data is written');
+assert.ok(data3.every((v, i) => v === Math.floor(i / buf.length)), 'writes are not affected by reusing the buffer');
+
+await tjs.remove(path3);
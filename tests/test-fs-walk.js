@@ -0,0 +1,79 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+const tmpDir = await tjs.makeTempDir('test_walkXXXXXX');
+
+async function touch(p) {
+    const f = await tjs.open(p, 'w');
+
+    await f.close();
+}
+
+await tjs.makeDir(path.join(tmpDir, 'a', 'b', 'c'), { recursive: true });
+await touch(path.join(tmpDir, 'one.txt'));
+await touch(path.join(tmpDir, 'a', 'two.txt'));
+await touch(path.join(tmpDir, 'a', 'b', 'three.txt'));
+await touch(path.join(tmpDir, 'a', 'b', 'c', 'four.txt'));
+await tjs.symlink(tmpDir, path.join(tmpDir, 'a', 'loop'), { type: 'directory' });
+
+const all = [];
+
+for await (const entry of tjs.walk(tmpDir)) {
+    all.push(path.relative(tmpDir, entry.path));
+}
+
+all.sort();
+assert.eq(all, [
+    'a',
+    path.join('a', 'b'),
+    path.join('a', 'b', 'c'),
+    path.join('a', 'b', 'c', 'four.txt'),
+    path.join('a', 'b', 'three.txt'),
+    path.join('a', 'loop'),
+    path.join('a', 'two.txt'),
+    'one.txt'
+], 'all entries are walked');
+
+const shallow = [];
+
+for await (const entry of tjs.walk(tmpDir, { maxDepth: 1 })) {
+    assert.eq(entry.depth, 1, 'depth is respected');
+    shallow.push(entry.name);
+}
+
+assert.eq(shallow.sort(), [ 'a', 'one.txt' ], 'maxDepth limits descending');
+
+const files = [];
+
+for await (const entry of tjs.walk(tmpDir, { filter: e => e.isFile, stat: true, batchSize: 1 })) {
+    assert.ok(entry.stat.isFile, 'stat is included');
+    files.push(entry.name);
+}
+
+assert.eq(files.sort(), [ 'four.txt', 'one.txt', 'three.txt', 'two.txt' ], 'filter is applied');
+
+// Following symlinks must not loop forever.
+let followed = 0;
+
+for await (const entry of tjs.walk(tmpDir, { followSymlinks: true })) {
+    if (entry.isFile) {
+        followed++;
+    }
+}
+
+assert.eq(followed, 4, 'symlink cycles are detected');
+
+let err;
+
+try {
+    for await (const entry of tjs.walk(path.join(tmpDir, 'nope'))) {
+        assert.fail(`unexpected entry ${entry.path}`);
+    }
+} catch (e) {
+    err = e;
+}
+
+assert.eq(err?.code, 'ENOENT', 'walking a missing directory fails');
+
+await tjs.remove(tmpDir);
@@ -0,0 +1,72 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+const tmpDir = await tjs.makeTempDir('test_writefileXXXXXX');
+const file = path.join(tmpDir, 'data.txt');
+const decoder = new TextDecoder();
+
+// Strings are written as UTF-8.
+await tjs.writeFile(file, 'hello 🌍');
+assert.eq(decoder.decode(await tjs.readFile(file)), 'hello 🌍', 'string is written');
+assert.eq(await tjs.readTextFile(file), 'hello 🌍', 'readTextFile decodes');
+
+// Typed arrays honor their offset and length.
+const bytes = new TextEncoder().encode('xxabcxx');
+
+await tjs.writeFile(file, bytes.subarray(2, 5));
+assert.eq(await tjs.readTextFile(file), 'abc', 'typed array view is written');
+
+await tjs.writeFile(file, new TextEncoder().encode('buf').buffer);
+assert.eq(await tjs.readTextFile(file), 'buf', 'ArrayBuffer is written');
+
+// Appending.
+await tjs.appendFile(file, 'fer');
+assert.eq(await tjs.readTextFile(file), 'buffer', 'data is appended');
+
+// Atomic writes replace the file and leave no temporaries behind.
+if (tjs.system.platform !== 'windows') {
+    await tjs.chmod(file, 0o600);
+}
+
+await tjs.writeFile(file, 'atomic', { atomic: true });
+assert.eq(await tjs.readTextFile(file), 'atomic', 'atomic write replaces contents');
+
+if (tjs.system.platform !== 'windows') {
+    assert.eq((await tjs.stat(file)).mode & 0o777, 0o600, 'atomic write keeps permissions');
+}
+
+const names = await tjs.readDir(tmpDir, { all: true });
+
+assert.eq(names, [ 'data.txt' ], 'no temporary files are left');
+
+// The byte order mark is skipped.
+await tjs.writeFile(file, new Uint8Array([ 0xef, 0xbb, 0xbf, 0x61 ]));
+assert.eq(await tjs.readTextFile(file), 'a', 'BOM is skipped');
+
+// Larger files are read completely.
+const big = new Uint8Array(3 * 1024 * 1024 + 17).map((_, i) => i & 0xff);
+
+await tjs.writeFile(file, big);
+
+const readBack = await tjs.readFile(file);
+
+assert.eq(readBack.length, big.length, 'size matches');
+assert.ok(readBack.every((v, i) => v === big[i]), 'contents match');
+
+// Empty files.
+await tjs.writeFile(file, '');
+assert.eq((await tjs.readFile(file)).length, 0, 'empty file');
+assert.eq(await tjs.readTextFile(file), '', 'empty text file');
+
+// Errors.
+try {
+    await tjs.writeFile(path.join(tmpDir, 'missing', 'file'), 'x', { atomic: true });
+    assert.fail('writing into a missing directory must fail');
+} catch (e) {
+    assert.eq(e.code, 'ENOENT', 'missing directory rejects');
+}
+
+assert.throws(() => tjs.writeFile(file, 42), TypeError, 'invalid data throws');
+
+await tjs.remove(tmpDir);
@@ -0,0 +1,71 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+const encoder = new TextEncoder();
+
+async function sleep(ms) {
+    return new Promise(resolve => {
+        setTimeout(resolve, ms);
+    });
+}
+
+const tmpDir = await tjs.makeTempDir('test_dirXXXXXX');
+const batches = [];
+
+await tjs.makeDir(path.join(tmpDir, 'a', 'b'), { recursive: true });
+
+const watcher = tjs.watch(tmpDir, events => {
+    batches.push(events);
+}, { recursive: true, debounce: 50 });
+
+await sleep(500);
+
+// A burst of writes to the same file is delivered as a single event.
+const f = await tjs.open(path.join(tmpDir, 'a', 'b', 'file'), 'w');
+
+for (let i = 0; i < 10; i++) {
+    await f.write(encoder.encode('hello'));
+}
+
+await f.close();
+await sleep(1000);
+
+assert.ok(batches.length >= 1, 'events are delivered in batches');
+
+const events = batches.flat();
+const filename = path.join('a', 'b', 'file');
+const matches = events.filter(e => e.filename === filename);
+
+assert.ok(batches.every(b => new Set(b.map(e => e.filename)).size === b.length), 'file names are unique per batch');
+assert.ok(matches.length >= 1, 'events in subdirectories are reported');
+
+// Directories created after the watcher started are watched too.
+batches.length = 0;
+await tjs.makeDir(path.join(tmpDir, 'c'));
+await sleep(500);
+await tjs.writeFile(path.join(tmpDir, 'c', 'new'), 'data');
+await sleep(1000);
+
+assert.ok(batches.flat().some(e => e.filename === path.join('c', 'new')), 'new directories are watched');
+
+assert.throws(() => tjs.watch(tmpDir, () => {}, { debounce: -1 }), RangeError, 'debounce must not be negative');
+
+watcher.close();
+
+// Watchers stay recursive by default where they always have been.
+if ([ 'darwin', 'windows' ].includes(tjs.system.platform)) {
+    const defaultEvents = [];
+    const defaultWatcher = tjs.watch(tmpDir, filename => {
+        defaultEvents.push(filename);
+    });
+
+    await sleep(500);
+    await tjs.writeFile(path.join(tmpDir, 'a', 'b', 'other'), 'data');
+    await sleep(1000);
+
+    assert.ok(defaultEvents.includes(path.join('a', 'b', 'other')), 'subdirectories are watched by default');
+
+    defaultWatcher.close();
+}
+
+await tjs.remove(tmpDir);
@@ -98,6 +98,57 @@ async function testPoll(){
 	sock.close();
 }
 
+async function testBatch(){
+	const sock = new PosixSocket(PosixSocket.defines.AF_INET, PosixSocket.defines.SOCK_DGRAM, 0);
+	const sockaddr = PosixSocket.createSockaddrIn('127.0.0.1', 12346);
+	sock.bind(sockaddr);
+	const encoder = new TextEncoder();
+	const decoder = new TextDecoder();
+	const messages = Array.from({ length: 5 }, (_, i) => ({ data: encoder.encode(`msg-${i}`), addr: sockaddr }));
+	const bufs = Array.from({ length: 8 }, () => new Uint8Array(16));
+
+	assert.eq(sock.sendmmsg(messages), messages.length);
+	const results = sock.recvmmsg(bufs);
+	assert.eq(results.length, messages.length);
+	assert.eq(decoder.decode(bufs[3].subarray(0, results[3].size)), 'msg-3');
+	assert.eq(results[3].truncated, false);
+
+	// everything that is ready arrives in one callback
+	const received = [];
+	let calls = 0;
+	sock.pollBatch(bufs, {
+		read: (msgs)=>{
+			calls++;
+			for(let i = 0; i < msgs.length; i++){
+				received.push(decoder.decode(bufs[i].subarray(0, msgs[i].size)));
+			}
+		}
+	});
+	assert.eq(sock.sendmmsg(messages), messages.length);
+	await new Promise(res=>setTimeout(res, 300));
+	assert.eq(calls, 1);
+	assert.eq(received.join(), messages.map(m=>decoder.decode(m.data)).join());
+
+	// the poll stays armed
+	assert.eq(sock.sendmmsg(messages.slice(0, 2)), 2);
+	await new Promise(res=>setTimeout(res, 300));
+	assert.eq(calls, 2);
+	assert.eq(received.length, messages.length + 2);
+	assert.eq(sock.recvmmsg(bufs).length, 0, 'the socket was drained');
+
+	// reads per wakeup are capped, the rest arrives on the next ones
+	const single = [ new Uint8Array(16) ];
+	let singleCalls = 0;
+	sock.pollBatch(single, { read: ()=>{ singleCalls++; } });
+	const many = Array.from({ length: 40 }, (_, i) => ({ data: encoder.encode(`msg-${i}`), addr: sockaddr }));
+	assert.eq(sock.sendmmsg(many), many.length);
+	await new Promise(res=>setTimeout(res, 300));
+	assert.eq(singleCalls, many.length);
+	assert.eq(sock.recvmmsg(bufs).length, 0, 'the socket was drained');
+	sock.stopPoll();
+	sock.close();
+}
+
 function testHelpers(){
 	const nis = tjs.system.networkInterfaces;
 	for(const ni of nis){
@@ -120,6 +171,7 @@ async function run(){
 	testUdpSock();
 	testTcpSock();
 	testPoll();
+	testBatch();
 	testHelpers();
 }
 run();
@@ -0,0 +1,51 @@
+import assert from 'tjs:assert';
+
+
+const N = 16;
+
+async function run(options) {
+    const server = await tjs.listen('tcp', '127.0.0.1', 0, options);
+    const { ip, port } = server.localAddress;
+
+    // Connect everybody before accepting, so connections pile up.
+    const clients = await Promise.all(Array.from({ length: N }, () => tjs.connect('tcp', ip, port)));
+    const accepted = [];
+
+    await new Promise(resolve => setTimeout(resolve, 100));
+
+    for await (const conn of server) {
+        accepted.push(conn);
+
+        if (accepted.length === N) {
+            break;
+        }
+    }
+
+    assert.eq(accepted.length, N, 'all connections are accepted');
+
+    for (const conn of [ ...accepted, ...clients ]) {
+        conn.close();
+    }
+
+    server.close();
+}
+
+await run({});
+
+// A small queue stops accepting until there is room again.
+await run({ acceptQueueSize: 2 });
+
+try {
+    await tjs.listen('tcp', '127.0.0.1', 0, { acceptQueueSize: 0 });
+    assert.fail('the queue size must be positive');
+} catch (e) {
+    assert.ok(e instanceof RangeError, 'the queue size must be positive');
+}
+
+// Closing a listener resolves pending accepts.
+const server = await tjs.listen('tcp', '127.0.0.1', 0);
+const pending = server.accept();
+
+server.close();
+
+assert.eq(await pending, undefined, 'no connection after closing');
@@ -0,0 +1,69 @@
+import assert from 'tjs:assert';
+
+
+const CHUNK = new Uint8Array(64 * 1024).fill(42);
+const TOTAL = 8 * 1024 * 1024;
+
+const server = await tjs.listen('tcp', '127.0.0.1', 0);
+const { ip, port } = server.localAddress;
+const client = await tjs.connect('tcp', ip, port);
+const conn = await server.accept();
+
+// Nobody is reading, so data piles up in libuv's write queue.
+const writes = [];
+
+for (let i = 0; i < TOTAL / CHUNK.length; i++) {
+    writes.push(client.write(CHUNK));
+}
+
+assert.ok(client.bufferedAmount > 0, 'data is waiting to be written');
+
+const drained = client.drain();
+
+async function readAll(c, total) {
+    const buf = new Uint8Array(256 * 1024);
+    let received = 0;
+
+    while (received < total) {
+        const nread = await c.read(buf);
+
+        if (nread === null) {
+            break;
+        }
+
+        received += nread;
+    }
+
+    return received;
+}
+
+assert.eq(await readAll(conn, TOTAL), TOTAL, 'all data is received');
+await Promise.all(writes);
+await drained;
+assert.eq(client.bufferedAmount, 0, 'the write queue is empty');
+
+// The writable stream holds writes back while the connection is behind.
+const writer = client.writable.getWriter();
+let sawBackPressure = false;
+
+const producer = (async () => {
+    for (let i = 0; i < TOTAL / CHUNK.length; i++) {
+        await writer.ready;
+        writer.write(CHUNK);
+
+        if (writer.desiredSize <= 0) {
+            sawBackPressure = true;
+        }
+    }
+
+    await writer.ready;
+})();
+
+assert.eq(await readAll(conn, TOTAL), TOTAL, 'all streamed data is received');
+await producer;
+assert.ok(sawBackPressure, 'desiredSize reports back-pressure');
+
+writer.releaseLock();
+client.close();
+conn.close();
+server.close();
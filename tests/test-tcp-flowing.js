@@ -0,0 +1,73 @@
+import assert from 'tjs:assert';
+
+// Large enough to make the reader pause and resume.
+const SIZE = 4 * 1024 * 1024 + 17;
+const data = new Uint8Array(SIZE).map((_, i) => i % 251);
+
+async function sleep(ms) {
+    return new Promise(resolve => {
+        setTimeout(resolve, ms);
+    });
+}
+
+const server = await tjs.listen('tcp', '127.0.0.1');
+const serverAddr = server.localAddress;
+const client = await tjs.connect('tcp', serverAddr.ip, serverAddr.port);
+const conn = await server.accept();
+
+const sent = (async () => {
+    const writer = conn.writable.getWriter();
+
+    await writer.write(data);
+    await writer.close();
+})();
+
+const reader = client.readable.getReader();
+const received = new Uint8Array(SIZE);
+let offset = 0;
+let reads = 0;
+
+while (true) {
+    const { value, done } = await reader.read();
+
+    if (done) {
+        break;
+    }
+
+    received.set(value, offset);
+    offset += value.byteLength;
+
+    // A slow consumer makes the native queue fill up.
+    if (reads++ % 16 === 0) {
+        await sleep(1);
+    }
+}
+
+await sent;
+
+assert.eq(offset, SIZE, 'all data was received');
+assert.ok(received.every((v, i) => v === i % 251), 'data arrives in order');
+
+// BYOB readers work too.
+const client2 = await tjs.connect('tcp', serverAddr.ip, serverAddr.port);
+const conn2 = await server.accept();
+
+await conn2.write(new TextEncoder().encode('hello'));
+conn2.close();
+
+const byob = client2.readable.getReader({ mode: 'byob' });
+let text = '';
+
+while (true) {
+    const { value, done } = await byob.read(new Uint8Array(2));
+
+    if (done) {
+        break;
+    }
+
+    text += new TextDecoder().decode(value);
+}
+
+assert.eq(text, 'hello', 'byob reads get the data');
+
+server.close();
@@ -0,0 +1,48 @@
+import assert from 'tjs:assert';
+
+
+const server = await tjs.listen('tcp', '127.0.0.1', 0);
+const { ip, port } = server.localAddress;
+const client = await tjs.connect('tcp', ip, port);
+const conn = await server.accept();
+
+// Buffer sizes work everywhere, the kernel may round them up.
+assert.ok(client.setSendBufferSize(64 * 1024) >= 64 * 1024, 'send buffer size is set');
+assert.ok(client.setRecvBufferSize(64 * 1024) >= 64 * 1024, 'receive buffer size is set');
+assert.throws(() => client.setSendBufferSize(0), RangeError, 'buffer size must be positive');
+
+if (tjs.system.platform === 'linux') {
+    client.setNotSentLowat(16 * 1024);
+    client.setQuickAck(true);
+
+    await client.write(new Uint8Array(1024));
+    await conn.read(new Uint8Array(1024));
+
+    const info = client.getInfo();
+
+    assert.eq(typeof info.rtt, 'number', 'rtt is reported');
+    assert.ok(info.cwnd > 0, 'cwnd is reported');
+    assert.eq(info.totalRetransmits, 0, 'no retransmits on loopback');
+
+    // Listener options.
+    const listener = await tjs.listen('tcp', '127.0.0.1', 0, { fastOpen: true, deferAccept: 1 });
+    const addr = listener.localAddress;
+    const accepted = listener.accept();
+    const tfo = await tjs.connect('tcp', addr.ip, addr.port, { fastOpen: true });
+
+    await tfo.write(new TextEncoder().encode('hello'));
+
+    const peer = await accepted;
+    const buf = new Uint8Array(16);
+    const nread = await peer.read(buf);
+
+    assert.eq(new TextDecoder().decode(buf.subarray(0, nread)), 'hello', 'data arrives with fast open');
+
+    tfo.close();
+    peer.close();
+    listener.close();
+}
+
+client.close();
+conn.close();
+server.close();
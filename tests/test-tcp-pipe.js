@@ -0,0 +1,159 @@
+import assert from 'tjs:assert';
+
+// Large enough to fill the socket buffers and hit the high water mark.
+const SIZE = 4 * 1024 * 1024 + 123;
+const data = new Uint8Array(SIZE).map((_, i) => i % 251);
+
+async function readAll(conn) {
+    const chunks = [];
+    const buf = new Uint8Array(65536);
+    let total = 0;
+
+    while (true) {
+        const nread = await conn.read(buf);
+
+        if (nread === null) {
+            break;
+        }
+
+        chunks.push(buf.slice(0, nread));
+        total += nread;
+    }
+
+    const result = new Uint8Array(total);
+    let offset = 0;
+
+    for (const chunk of chunks) {
+        result.set(chunk, offset);
+        offset += chunk.length;
+    }
+
+    return result;
+}
+
+async function writeAll(conn, buf) {
+    await conn.write(buf);
+    conn.shutdown();
+}
+
+const server = await tjs.listen('tcp', '127.0.0.1');
+const serverAddr = server.localAddress;
+
+async function connectPair() {
+    const client = await tjs.connect('tcp', serverAddr.ip, serverAddr.port);
+    const conn = await server.accept();
+
+    return [ client, conn ];
+}
+
+// Socket to socket, like a proxy would.
+const [ a, aPeer ] = await connectPair();
+const [ b, bPeer ] = await connectPair();
+const received = readAll(bPeer);
+
+writeAll(a, data);
+
+const moved = await tjs.pipe(aPeer, b, { highWaterMark: 64 * 1024 });
+
+b.close();
+
+const result = await received;
+
+assert.eq(moved, SIZE, 'all data is moved');
+assert.eq(result.length, SIZE, 'all data is received');
+assert.ok(result.every((v, i) => v === data[i]), 'contents match');
+
+// Socket to file.
+const [ c, cPeer ] = await connectPair();
+const file = await tjs.makeTempFile('testPipe_XXXXXX');
+
+writeAll(c, data);
+
+const written = await tjs.pipe(cPeer, file);
+
+await file.close();
+
+const contents = await tjs.readFile(file.path);
+
+assert.eq(written, SIZE, 'all data is written to the file');
+assert.ok(contents.every((v, i) => v === data[i]), 'file contents match');
+
+// File to socket, from the current position.
+const [ d, dPeer ] = await connectPair();
+const src = await tjs.open(file.path, 'r');
+const head = new Uint8Array(1000);
+
+await src.read(head);
+
+const received2 = readAll(d);
+const sent = await tjs.pipe(src, dPeer);
+
+dPeer.close();
+
+const result2 = await received2;
+
+assert.eq(sent, SIZE - 1000, 'the rest of the file is sent');
+assert.ok(result2.every((v, i) => v === data[i + 1000]), 'contents match');
+assert.eq(await src.read(head), null, 'the file position is moved past the sent data');
+
+// The source can't be read from while piping.
+const [ e, ePeer ] = await connectPair();
+const pending = tjs.pipe(ePeer, e);
+
+try {
+    await tjs.pipe(ePeer, e);
+    assert.fail('a source can only be piped once');
+} catch (err) {
+    assert.eq(err.code, 'EBUSY', 'the source is busy');
+}
+
+ePeer.close();
+
+try {
+    await pending;
+    assert.fail('closing the source cancels the pipe');
+} catch (err) {
+    assert.eq(err.code, 'ECANCELED', 'the pipe is cancelled');
+}
+
+// Closing the destination file fails the pipe, instead of writing to whatever reuses the descriptor.
+const [ f, fPeer ] = await connectPair();
+const file2 = await tjs.makeTempFile('testPipe_XXXXXX');
+const piping = tjs.pipe(fPeer, file2);
+
+await f.write(data.subarray(0, 1000));
+await new Promise(resolve => setTimeout(resolve, 100));
+await file2.close();
+await f.write(data.subarray(1000, 2000));
+
+try {
+    await piping;
+    assert.fail('writing to a closed file fails the pipe');
+} catch (err) {
+    assert.eq(err.code, 'EBADF', 'the file is closed');
+}
+
+assert.eq((await tjs.readFile(file2.path)).length, 1000, 'nothing is written after the file is closed');
+
+try {
+    await tjs.pipe(fPeer, file2);
+    assert.fail('a closed file can\'t be piped to');
+} catch (err) {
+    assert.eq(err.code, 'EBADF', 'the file is closed');
+}
+
+try {
+    await tjs.pipe({}, e);
+    assert.fail('pipe requires a handle');
+} catch (err) {
+    assert.ok(err instanceof TypeError, 'a handle is required');
+}
+
+for (const conn of [ a, aPeer, bPeer, c, cPeer, d, e, f, fPeer ]) {
+    conn.close();
+}
+
+server.close();
+await src.close();
+await tjs.remove(file.path);
+await tjs.remove(file2.path);
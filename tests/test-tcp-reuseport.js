@@ -0,0 +1,75 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+const decoder = new TextDecoder();
+
+// Load balancing SO_REUSEPORT is only available on these.
+if ([ 'linux', 'freebsd' ].includes(tjs.system.platform)) {
+    // Several listeners can bind the same port, the kernel picks one for each connection.
+    const l1 = await tjs.listen('tcp', '127.0.0.1', 0, { reusePort: true });
+    const { port } = l1.localAddress;
+    const l2 = await tjs.listen('tcp', '127.0.0.1', port, { reusePort: true });
+
+    assert.eq(l2.localAddress.port, port, 'both listeners share the port');
+
+    const accepted = Promise.race([ l1.accept(), l2.accept() ]);
+    const client = await tjs.connect('tcp', '127.0.0.1', port);
+    const conn = await accepted;
+
+    assert.ok(conn, 'one of the listeners accepts the connection');
+
+    conn.close();
+    client.close();
+    l1.close();
+    l2.close();
+} else {
+    try {
+        const l = await tjs.listen('tcp', '127.0.0.1', 0, { reusePort: true });
+
+        l.close();
+    } catch (e) {
+        assert.eq(e.code, 'ENOTSUP', 'reusePort is not supported');
+    }
+}
+
+if (tjs.system.platform !== 'windows') {
+    // Without the flag the port is taken.
+    const l3 = await tjs.listen('tcp', '127.0.0.1', 0);
+
+    try {
+        await tjs.listen('tcp', '127.0.0.1', l3.localAddress.port);
+        assert.fail('the port is in use');
+    } catch (e) {
+        assert.eq(e.code, 'EADDRINUSE', 'the port is in use');
+    }
+
+    l3.close();
+
+    // A listening socket can be handed over to a worker.
+    const listener = await tjs.listen('tcp', '127.0.0.1', 0);
+    const addr = listener.localAddress;
+    const w = new Worker(path.join(import.meta.dirname, 'helpers', 'worker-listener.js'));
+    const timer = setTimeout(() => {
+        w.terminate();
+        assert.fail('Timeout out waiting for worker');
+    }, 5000);
+
+    await new Promise(resolve => {
+        w.onmessage = resolve;
+        w.postMessage(listener.fileno());
+    });
+
+    // The worker has its own copy of the socket.
+    listener.close();
+
+    const client2 = await tjs.connect('tcp', addr.ip, addr.port);
+    const buf = new Uint8Array(64);
+    const nread = await client2.read(buf);
+
+    assert.eq(decoder.decode(buf.subarray(0, nread)), 'hello from worker', 'the worker accepted the connection');
+
+    clearTimeout(timer);
+    client2.close();
+    w.terminate();
+}
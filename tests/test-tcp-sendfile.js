@@ -0,0 +1,116 @@
+import assert from 'tjs:assert';
+
+const encoder = new TextEncoder();
+const decoder = new TextDecoder();
+
+// Large enough to fill the socket buffers.
+const SIZE = 8 * 1024 * 1024 + 123;
+const data = new Uint8Array(SIZE).map((_, i) => i % 251);
+const file = await tjs.makeTempFile('testSendFile_XXXXXX');
+
+await file.write(data);
+
+async function readAll(conn) {
+    const chunks = [];
+    const buf = new Uint8Array(65536);
+    let total = 0;
+
+    while (true) {
+        const nread = await conn.read(buf);
+
+        if (nread === null) {
+            break;
+        }
+
+        chunks.push(buf.slice(0, nread));
+        total += nread;
+    }
+
+    const result = new Uint8Array(total);
+    let offset = 0;
+
+    for (const chunk of chunks) {
+        result.set(chunk, offset);
+        offset += chunk.length;
+    }
+
+    return result;
+}
+
+const server = await tjs.listen('tcp', '127.0.0.1');
+const serverAddr = server.localAddress;
+
+// Whole file.
+const client = await tjs.connect('tcp', serverAddr.ip, serverAddr.port);
+const conn = await server.accept();
+const received = readAll(client);
+const sent = await tjs.sendFile(conn, file);
+
+conn.close();
+
+const result = await received;
+
+assert.eq(sent, SIZE, 'the whole file is sent');
+assert.eq(result.length, SIZE, 'the whole file is received');
+assert.ok(result.every((v, i) => v === data[i]), 'contents match');
+
+// A range, after a regular write.
+const client2 = await tjs.connect('tcp', serverAddr.ip, serverAddr.port);
+const conn2 = await server.accept();
+const received2 = readAll(client2);
+
+await conn2.write(encoder.encode('HEADER\n'));
+
+const sent2 = await tjs.sendFile(conn2, file, { offset: 1000, length: 10 });
+
+conn2.close();
+
+const result2 = await received2;
+
+assert.eq(sent2, 10, 'the range is sent');
+assert.eq(decoder.decode(result2.subarray(0, 7)), 'HEADER\n', 'previous writes come first');
+assert.eq(Array.from(result2.subarray(7)), Array.from(data.subarray(1000, 1010)), 'range contents match');
+
+// Stalled readers don't hold threadpool threads, so other fs operations still run.
+const stalled = [];
+
+for (let i = 0; i < 6; i++) {
+    const c = await tjs.connect('tcp', serverAddr.ip, serverAddr.port);
+    const s = await server.accept();
+
+    stalled.push({ c, s, sent: tjs.sendFile(s, file) });
+}
+
+await new Promise(resolve => setTimeout(resolve, 100));
+
+let timer;
+const timeout = new Promise((_, reject) => {
+    timer = setTimeout(() => reject(new Error('timed out')), 2000);
+});
+const st = await Promise.race([ tjs.stat(file.path), timeout ]);
+
+clearTimeout(timer);
+
+assert.eq(st.size, SIZE, 'fs operations are not starved by slow readers');
+
+for (const { c, s, sent } of stalled) {
+    const received = readAll(c);
+
+    assert.eq(await sent, SIZE, 'the whole file is sent to a slow reader');
+    s.close();
+    assert.eq((await received).length, SIZE, 'the whole file is received by a slow reader');
+    c.close();
+}
+
+try {
+    await tjs.sendFile({}, file);
+    assert.fail('sendFile requires a connection');
+} catch (e) {
+    assert.ok(e instanceof TypeError, 'a connection is required');
+}
+
+client.close();
+client2.close();
+server.close();
+await file.close();
+await tjs.remove(file.path);
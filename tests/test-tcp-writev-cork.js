@@ -0,0 +1,83 @@
+import assert from 'tjs:assert';
+
+const encoder = new TextEncoder();
+const decoder = new TextDecoder();
+
+async function readAll(conn) {
+    const buf = new Uint8Array(65536);
+    let text = '';
+
+    while (true) {
+        const nread = await conn.read(buf);
+
+        if (nread === null) {
+            return text;
+        }
+
+        text += decoder.decode(buf.subarray(0, nread));
+    }
+}
+
+const server = await tjs.listen('tcp', '127.0.0.1');
+const serverAddr = server.localAddress;
+const client = await tjs.connect('tcp', serverAddr.ip, serverAddr.port);
+const conn = await server.accept();
+const received = readAll(client);
+
+const nwritten = await conn.writev([ 'HEAD ', '/ ', 'HTTP/1.1\r\n' ].map(s => encoder.encode(s)));
+
+assert.eq(nwritten, 18, 'writev returns the total size');
+assert.eq(await conn.writev([]), 0, 'writing no buffers is a no-op');
+assert.throws(() => conn.writev('foo'), TypeError, 'buffers must be an array');
+
+// Corked writes share a promise and are sent together.
+conn.cork({ tcpCork: true });
+
+const p1 = conn.write(encoder.encode('a'));
+const p2 = conn.write(encoder.encode('b'));
+const p3 = conn.writev([ encoder.encode('c'), encoder.encode('d') ]);
+
+assert.ok(p1 === p2 && p2 === p3, 'corked writes share a promise');
+assert.eq(await p1, 4, 'the batch is flushed at the end of the tick');
+
+// Nested corks only flush on the last uncork.
+conn.cork();
+conn.cork();
+
+const p4 = conn.write(encoder.encode('e'));
+
+conn.uncork();
+conn.write(encoder.encode('f'));
+conn.uncork();
+
+assert.eq(await p4, 2, 'nested corks flush once');
+
+// Uncorking by hand cancels the end of tick uncork, a later cork gets its own.
+conn.cork();
+conn.uncork();
+
+let p6;
+
+queueMicrotask(() => {
+    p6 = conn.write(encoder.encode('i'));
+});
+conn.cork();
+
+const p5 = conn.write(encoder.encode('h'));
+
+assert.eq(await p5, 2, 'the second cork lasts until the end of the tick');
+assert.ok(p5 === p6, 'writes made later in the tick are batched');
+
+// Reusing a buffer after a write through the writable doesn't change what is sent.
+const writer = conn.writable.getWriter();
+const buf = encoder.encode('jk');
+
+await writer.write(buf);
+buf.set(encoder.encode('XX'));
+
+// Closing the writable closes the connection once everything is written.
+await writer.close();
+
+assert.eq(await received, 'HEAD / HTTP/1.1\r\nabcdefhijk', 'data arrives in order');
+
+server.close();
@@ -0,0 +1,89 @@
+import assert from 'tjs:assert';
+
+const encoder = new TextEncoder();
+const decoder = new TextDecoder();
+
+
+const N = 50;
+const server = await tjs.listen('udp', '127.0.0.1');
+const serverAddr = server.localAddress;
+const client = await tjs.listen('udp', '127.0.0.1');
+
+const messages = Array.from({ length: N }, (_, i) => ({ data: encoder.encode(`msg-${i}`), addr: serverAddr }));
+const sizes = await client.sendBatch(messages);
+
+assert.eq(sizes.length, N, 'a size for every message');
+assert.eq(sizes[10], messages[10].data.byteLength, 'sizes match');
+
+const bufs = Array.from({ length: 16 }, () => new Uint8Array(64));
+const received = [];
+
+while (received.length < N) {
+    const batch = await server.recvBatch(bufs);
+
+    assert.ok(batch.length > 0 && batch.length <= bufs.length, 'at most one datagram per buffer');
+
+    for (let i = 0; i < batch.length; i++) {
+        assert.eq(batch[i].partial, false, 'datagram fits');
+        assert.eq(batch[i].addr.port, client.localAddress.port, 'the sender is reported');
+        received.push(decoder.decode(bufs[i].subarray(0, batch[i].nread)));
+    }
+}
+
+assert.eq(received, messages.map((_, i) => `msg-${i}`), 'all datagrams arrive in order');
+
+// Datagrams larger than their buffer are truncated.
+await client.sendBatch([ { data: new Uint8Array(100), addr: serverAddr } ]);
+
+const [ small ] = await server.recvBatch([ new Uint8Array(10) ]);
+
+assert.eq(small.nread, 10, 'the buffer is filled');
+assert.eq(small.partial, true, 'the datagram is truncated');
+
+// Single receives keep working.
+await client.sendBatch([ { data: encoder.encode('single'), addr: serverAddr } ]);
+
+const buf = new Uint8Array(16);
+const rinfo = await server.recv(buf);
+
+assert.eq(decoder.decode(buf.subarray(0, rinfo.nread)), 'single', 'single receive');
+
+// Addresses are checked before anything is sent.
+try {
+    await client.sendBatch([ { data: encoder.encode('a'), addr: serverAddr }, { data: encoder.encode('b') } ]);
+    assert.fail('an address is needed');
+} catch (e) {
+    assert.eq(e.code, 'EDESTADDRREQ', 'an address is needed');
+}
+
+// A failure partway reports how much was sent.
+try {
+    await client.sendBatch([
+        { data: encoder.encode('ok-1'), addr: serverAddr },
+        { data: encoder.encode('ok-2'), addr: serverAddr },
+        { data: encoder.encode('bad'), addr: { ip: '::1', port: serverAddr.port } },
+    ]);
+    assert.fail('sending to an IPv6 address fails');
+} catch (e) {
+    assert.eq(e.sent, 2, 'the messages before the failing one were sent');
+}
+
+for (const expected of [ 'ok-1', 'ok-2' ]) {
+    const { nread } = await server.recv(buf);
+
+    assert.eq(decoder.decode(buf.subarray(0, nread)), expected, 'sent messages arrive');
+}
+
+try {
+    await server.recvBatch([]);
+    assert.fail('buffers are needed');
+} catch (e) {
+    assert.ok(e instanceof RangeError, 'buffers are needed');
+}
+
+const pending = server.recvBatch(bufs);
+
+server.close();
+assert.eq(await pending, null, 'closing resolves pending receives');
+
+client.close();
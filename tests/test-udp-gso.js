@@ -0,0 +1,78 @@
+import assert from 'tjs:assert';
+
+
+const SEGMENT = 100;
+
+if (tjs.system.platform === 'linux') {
+    const server = await tjs.listen('udp', '127.0.0.1', 0, { gro: true });
+    const serverAddr = server.localAddress;
+    const client = await tjs.listen('udp', '127.0.0.1', 0, { segmentSize: SEGMENT });
+
+    // Equally sized messages go out as one datagram, the last one may be shorter.
+    const messages = Array.from({ length: 11 }, (_, i) => ({
+        data: new Uint8Array(i === 10 ? SEGMENT / 2 : SEGMENT).fill(i),
+        addr: serverAddr
+    }));
+    const sizes = await client.sendBatch(messages);
+
+    assert.eq(sizes.length, messages.length, 'a size for every message');
+    assert.eq(sizes[10], SEGMENT / 2, 'sizes match');
+
+    // Fewer buffers than segments, the rest is kept for the next read.
+    const bufs = Array.from({ length: 4 }, () => new Uint8Array(SEGMENT * 2));
+    const received = [];
+
+    while (received.length < messages.length) {
+        const batch = await server.recvBatch(bufs);
+
+        for (let i = 0; i < batch.length; i++) {
+            assert.eq(batch[i].partial, false, 'segment fits');
+            assert.eq(batch[i].addr.port, client.localAddress.port, 'the sender is reported');
+            received.push(bufs[i].slice(0, batch[i].nread));
+        }
+    }
+
+    for (let i = 0; i < received.length; i++) {
+        assert.eq(received[i].length, messages[i].data.length, 'segments are split');
+        assert.ok(received[i].every(v => v === i), 'segments arrive in order');
+    }
+
+    // A large send is split by the kernel.
+    await client.send(new Uint8Array(SEGMENT * 3).fill(42), serverAddr);
+
+    const buf = new Uint8Array(SEGMENT * 3);
+
+    for (let i = 0; i < 3; i++) {
+        const { nread } = await server.recv(buf);
+
+        assert.eq(nread, SEGMENT, 'one segment per read');
+        assert.eq(buf[0], 42, 'segment contents match');
+    }
+
+    const pending = server.recv(buf);
+
+    try {
+        server.setGro(false);
+        assert.fail('GRO cannot be toggled while reading');
+    } catch (err) {
+        assert.eq(err.code, 'EBUSY', 'the endpoint is busy');
+    }
+
+    assert.throws(() => client.setSegmentSize(1 << 20), RangeError, 'segment size is bounded');
+
+    server.close();
+    assert.eq((await pending).nread, null, 'closing resolves the pending read');
+
+    client.close();
+} else {
+    const endpoint = await tjs.listen('udp', '127.0.0.1', 0);
+
+    try {
+        endpoint.setSegmentSize(SEGMENT);
+        assert.fail('GSO is Linux only');
+    } catch (err) {
+        assert.eq(err.code, 'ENOTSUP', 'GSO is not supported');
+    }
+
+    endpoint.close();
+}
@@ -0,0 +1,48 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+const encoder = new TextEncoder();
+const tmpDir = await tjs.makeTempDir('test_moduleXXXXXX');
+const modPath = path.join(tmpDir, 'mod.js');
+
+async function writeModule(value) {
+    const f = await tjs.open(modPath, 'w');
+
+    await f.write(encoder.encode(`export default ${JSON.stringify(value)};`));
+    await f.close();
+}
+
+function runWorker() {
+    const source = `import value from '${modPath}'; self.postMessage(value);`;
+    const blob = new Blob([ source ], { type: 'text/javascript' });
+    const url = URL.createObjectURL(blob);
+    const w = new Worker(url);
+
+    URL.revokeObjectURL(url);
+
+    return new Promise((resolve, reject) => {
+        const timer = setTimeout(() => {
+            w.terminate();
+            reject(new Error('Timeout out waiting for worker'));
+        }, 1000);
+
+        w.onmessage = event => {
+            clearTimeout(timer);
+            w.terminate();
+            resolve(event.data);
+        };
+    });
+}
+
+await writeModule(1);
+
+// The second worker is served from the shared bytecode cache.
+assert.eq(await runWorker(), 1, 'first worker loads the module');
+assert.eq(await runWorker(), 1, 'second worker loads the cached module');
+
+// Changing the file must invalidate the cache.
+await writeModule('changed');
+assert.eq(await runWorker(), 'changed', 'modified module is reloaded');
+
+await tjs.remove(tmpDir);
@@ -0,0 +1,25 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+assert.throws(() => tjs.receiveMessageOnPort({}), TypeError, 'port must be valid');
+
+const w = new Worker(path.join(import.meta.dirname, 'helpers', 'worker-receive.js'));
+
+assert.eq(tjs.receiveMessageOnPort(w), undefined, 'no message pending');
+assert.throws(() => tjs.receiveMessageOnPort(w, { timeout: 10 }), TypeError, 'cannot block outside workers');
+
+const timer = setTimeout(() => {
+    w.terminate();
+    assert.fail('Timeout out waiting for worker');
+}, 2000);
+
+setTimeout(() => {
+    w.postMessage('stop');
+}, 50);
+
+w.onmessage = event => {
+    clearTimeout(timer);
+    w.terminate();
+    assert.ok(event.data > 0, 'worker received the message while spinning');
+};
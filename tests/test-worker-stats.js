@@ -0,0 +1,68 @@
+import assert from 'tjs:assert';
+import path from 'tjs:path';
+
+
+const MB = 1024 * 1024;
+const w = new Worker(path.join(import.meta.dirname, 'helpers', 'worker-echo.js'), {
+    name: 'echo',
+    memoryLimit: 64 * MB,
+    stackSize: MB
+});
+const timer = setTimeout(() => {
+    w.terminate();
+    assert.fail('Timeout out waiting for worker');
+}, 1000);
+let received = 0;
+w.onmessage = () => {
+    received++;
+
+    if (received < 3) {
+        return;
+    }
+
+    clearTimeout(timer);
+
+    let stats = w.stats();
+
+    assert.ok(stats.running, 'worker is running');
+    assert.eq(stats.messagesIn, 3, 'worker received 3 messages');
+    assert.eq(stats.messagesOut, 3, 'worker sent 3 messages');
+    assert.ok(stats.bytesIn > 0 && stats.bytesOut > 0, 'bytes are accounted');
+    assert.ok(stats.cpuTime >= 0, 'cpu time is reported');
+
+    w.terminate();
+
+    stats = w.stats();
+
+    assert.ok(!stats.running, 'worker is not running');
+    assert.ok(stats.heapSize > 0, 'heap size is sampled');
+    assert.eq(stats.heapLimit, 64 * MB, 'memory limit is applied');
+};
+
+for (let i = 0; i < 3; i++) {
+    w.postMessage({ i });
+}
+
+const w2 = new Worker(path.join(import.meta.dirname, 'helpers', 'worker-name.js'), { name: 'foo' });
+const timer2 = setTimeout(() => {
+    w2.terminate();
+    assert.fail('Timeout out waiting for worker');
+}, 1000);
+w2.onmessage = event => {
+    clearTimeout(timer2);
+    w2.terminate();
+    assert.eq(event.data, 'foo', 'worker name is set');
+};
+
+// A stack limit above the platform's default thread stack overflows in JS, not natively.
+const w3 = new Worker(path.join(import.meta.dirname, 'helpers', 'worker-recursion.js'), { stackSize: 32 * MB });
+const timer3 = setTimeout(() => {
+    w3.terminate();
+    assert.fail('Timeout out waiting for worker');
+}, 5000);
+w3.onmessage = event => {
+    clearTimeout(timer3);
+    w3.terminate();
+    assert.ok(event.data.isRangeError, 'stack overflow throws a RangeError');
+    assert.ok(event.data.depth > 1000, 'the stack is usable');
+};
@@ -24,6 +24,18 @@ declare module 'tjs:posix-socket' {
         recv(size: number): Uint8Array;
         recvmsg(size: number): {data: Uint8Array, addr: Uint8Array};
         recvmsg(size: number, controllen: number): {data: Uint8Array, addr: Uint8Array, control: Uint8Array};
+        /**
+        * Receives up to one message per buffer with a single recvmmsg call (a recvmsg
+        * loop where it's not available). The data is written to the given buffers, the
+        * results say how much went into each one. Returns an empty array if the socket
+        * is non-blocking and nothing is ready.
+        */
+        recvmmsg(bufs: Uint8Array[], flags?: number): {size: number, addr: Uint8Array, truncated: boolean}[];
+        /**
+        * Sends the messages with a single sendmmsg call (a sendmsg loop where it's not
+        * available). Returns how many were sent, 0 if the socket is non-blocking and full.
+        */
+        sendmmsg(messages: {data: Uint8Array|Uint8Array[], addr?: Uint8Array, control?: Uint8Array}[], flags?: number): number;
         close(): void;
         setopt(level: number, name: number, value: Uint8Array): void;
         /**
@@ -41,6 +53,15 @@ declare module 'tjs:posix-socket' {
             prioritized?: (events: number) => void,
             error?: (errcode: number) => void,
         }): void;
+        /**
+        * Like poll, but stays armed for reading and drains the socket into the given
+        * buffers before calling back. read gets one call per wakeup, or one per set of
+        * filled buffers if more messages are waiting. Stop it with stopPoll.
+        */
+        pollBatch(bufs: Uint8Array[], cbs: {
+            read?: (messages: {size: number, addr: Uint8Array, truncated: boolean}[]) => void,
+            error?: (errcode: number) => void,
+        }, flags?: number): void;
         stopPoll(): void;
 
         static readonly defines: {
@@ -318,6 +318,50 @@ declare global {
             * @param offset Offset in the file to write to.
             */
             write(buffer: Uint8Array, offset?: number): Promise<number>;
+
+            /**
+            * Reads data into the given buffers, in order, with a single request.
+            * Returns the total amount of read data or null for EOF.
+            *
+            * @param buffers Buffers to read data into.
+            * @param offset Offset in the file to read from.
+            */
+            readv(buffers: Uint8Array[], offset?: number): Promise<number|null>;
+
+            /**
+            * Writes data from the given buffers, in order, with a single request.
+            * Returns the total amount of data written.
+            *
+            * @param buffers Buffers to write.
+            * @param offset Offset in the file to write to.
+            */
+            writev(buffers: Uint8Array[], offset?: number): Promise<number>;
+
+            /**
+            * Creates a write-behind writer for this file. Writes are accumulated in native
+            * memory and written out with a single `writev` once `highWaterMark` bytes are
+            * buffered, when `flushInterval` elapses, or when flushed explicitly. Data is
+            * appended at the current file position.
+            *
+            * The writer must be closed (or flushed) before the file is: writes fail with
+            * `EBADF` once the file is closed, and data still buffered when the writer is
+            * garbage collected is discarded.
+            *
+            * ```js
+            * const f = await tjs.open('out.log', 'a');
+            * const w = f.bufferedWriter({ flushInterval: 100 });
+            * for (const line of lines) {
+            *     if (!w.write(line)) {
+            *         await w.ready;
+            *     }
+            * }
+            * await w.close();
+            * await f.close();
+            * ```
+            *
+            * @param options Writer options.
+            */
+            bufferedWriter(options?: BufferedWriterOptions): BufferedWriter;
             
             /**
             * Closes the file.
@@ -370,9 +414,66 @@ declare global {
             path: string;
             
             readable: ReadableStream<Uint8Array>;
+
+            /**
+            * Writable side of the connection. Its `desiredSize` accounts for the data still
+            * waiting to be written, and `writer.ready` resolves once the connection drains.
+            */
             writable: WritableStream<Uint8Array>;
         }
         
+        interface BufferedWriterOptions {
+            /**
+            * Amount of buffered bytes that triggers a write. Defaults to 64 KiB.
+            */
+            highWaterMark?: number;
+
+            /**
+            * Time in milliseconds after which buffered data is written out, even if the
+            * high water mark hasn't been reached. Defaults to 0, meaning no timer.
+            */
+            flushInterval?: number;
+        }
+
+        interface BufferedWriter {
+            /**
+            * Queues the given data. Chunks of 16 KiB or more are not copied and must not be
+            * modified until they are written. Returns false if the buffered amount is at or
+            * above the high water mark, in which case the caller should wait for `ready`.
+            *
+            * @param data Data to write.
+            */
+            write(data: string | ArrayBuffer | ArrayBufferView): boolean;
+
+            /**
+            * Writes out all data queued so far.
+            */
+            flush(): Promise<void>;
+
+            /**
+            * Writes out all data queued so far and then calls fsync on the file.
+            */
+            sync(): Promise<void>;
+
+            /**
+            * Flushes the writer and rejects further writes. The file is left open.
+            */
+            close(): Promise<void>;
+
+            /**
+            * Resolves once the buffered amount is below the high water mark. Rejects if
+            * a write failed.
+            */
+            readonly ready: Promise<void>;
+
+            /**
+            * Amount of bytes queued but not yet written.
+            */
+            readonly bufferedAmount: number;
+
+            readonly highWaterMark: number;
+        }
+
         interface StatResult {
             dev: number;
             mode: number;
@@ -414,6 +515,51 @@ declare global {
         */
         function lstat(path: string): Promise<StatResult>;
 
+        type StatManyField = 'dev' | 'ino' | 'mode' | 'nlink' | 'uid' | 'gid' | 'rdev' | 'size' | 'blocks' |
+            'atim' | 'mtim' | 'ctim' | 'birthtim';
+
+        interface StatManyOptions {
+            /** Fields to gather. Defaults to `['mode', 'size', 'mtim']`. */
+            fields?: StatManyField[];
+            /** Don't follow symbolic links, like {@link lstat}. Defaults to `false`. */
+            lstat?: boolean;
+        }
+
+        /**
+        * Columnar result of {@link statMany}: one array per requested field, indexed like the paths.
+        * Times are in milliseconds since the epoch.
+        */
+        interface StatManyResult {
+            /** 0 for paths which were stat'ed, a (negative) error number otherwise. Use `new tjs.Error(errno)` to get the error. */
+            errors: Int32Array;
+            dev?: BigUint64Array;
+            ino?: BigUint64Array;
+            mode?: Uint32Array;
+            nlink?: Uint32Array;
+            uid?: Uint32Array;
+            gid?: Uint32Array;
+            rdev?: BigUint64Array;
+            size?: BigUint64Array;
+            blocks?: BigUint64Array;
+            atim?: Float64Array;
+            mtim?: Float64Array;
+            ctim?: Float64Array;
+            birthtim?: Float64Array;
+        }
+
+        /**
+        * Gets the status of many paths at once. Paths are stat'ed in parallel on the threadpool
+        * and the results are returned in typed arrays instead of one object per path.
+        *
+        * ```js
+        * const { errors, mtim } = await tjs.statMany(paths, { fields: ['mtim'] });
+        * ```
+        *
+        * @param paths Paths to stat.
+        * @param options Fields to gather.
+        */
+        function statMany(paths: string[], options?: StatManyOptions): Promise<StatManyResult>;
+
         interface StatFsResult {
             type: number;
             bsize: number;
@@ -432,6 +578,40 @@ declare global {
         */
         function statFs(path: string): Promise<StatFsResult>;
 
+        type FsBatchOperation =
+            | { op: 'stat' | 'lstat' | 'realPath' | 'readLink' | 'unlink' | 'rmdir', path: string }
+            | { op: 'mkdir', path: string, mode?: number }
+            | { op: 'chmod', path: string, mode: number }
+            | { op: 'rename' | 'copyFile' | 'link', path: string, newPath: string }
+            | { op: 'symlink', path: string, newPath: string, mode?: number };
+
+        interface FsBatchOptions {
+            /**
+             * Amount of threadpool jobs the operations are split across. Defaults to 1, which runs them
+             * strictly in order. Values above 4 are clamped to 4, so one batch can't take over the threadpool.
+             */
+            concurrency?: number;
+        }
+
+        /**
+        * Runs many file-system operations with a single call, grouped into a few threadpool jobs.
+        * By default operations run strictly in order, so later ones can depend on earlier ones.
+        * With a `concurrency` above 1 the operations are split into that many contiguous groups
+        * which run in parallel, in order only within each group: only use it for independent
+        * operations, such as stats of unrelated paths.
+        *
+        * The returned array holds, for each operation, its result (a {@link StatResult} for stats,
+        * a string for `realPath` and `readLink`, undefined otherwise) or the Error it failed with.
+        *
+        * ```js
+        * const results = await tjs.fsBatch(paths.map(path => ({ op: 'stat', path })), { concurrency: 4 });
+        * ```
+        *
+        * @param operations Operations to run.
+        * @param options Batch options.
+        */
+        function fsBatch(operations: FsBatchOperation[], options?: FsBatchOptions): Promise<Array<StatResult | string | undefined | Error>>;
+
         /**
         * Change permissions of a file.
         * See [chmod(2)](https://man7.org/linux/man-pages/man2/chmod.2.html)
@@ -516,13 +696,22 @@ declare global {
         */
         function makeDir(path: string, options?: MakeDirOptions): Promise<void>;
         
+        interface CopyFileOptions {
+            /* Fail if the target already exists. Defaults to false. */
+            exclusive?: boolean;
+            /* Try to create a copy-on-write reflink. When 'force', fail if that is not possible. Defaults to true. */
+            clone?: boolean | 'force';
+        }
+
         /**
-        * Copies the source file into the target.
+        * Copies the source file into the target. The data is copied in the kernel
+        * (reflink, copy_file_range or sendfile) where the platform supports it.
         *
         * @param path Source path.
         * @param newPath Target path.
+        * @param options Copy options.
         */
-        function copyFile(path: string, newPath: string): Promise<void>;
+        function copyFile(path: string, newPath: string, options?: CopyFileOptions): Promise<void>;
         
         interface DirEnt {
             name: string;
@@ -558,14 +747,109 @@ declare global {
             path: string;
         }
         
+        interface ReadDirOptions {
+            /** Number of entries fetched per native call when iterating. Defaults to 256. */
+            batchSize?: number;
+            /** Only used with `all`. */
+            withFileTypes?: boolean;
+        }
+
         /**
         * Open the directory at the given path in order to navigate its content.
         * See [readdir(3)](https://man7.org/linux/man-pages/man3/readdir.3.html)
         *
         * @param path Path to the directory.
+        * @param options Options for reading the directory.
+        */
+        function readDir(path: string, options?: ReadDirOptions): Promise<DirHandle>;
+
+        /**
+        * Reads all the entries of the directory at the given path in one go.
+        * See [scandir(3)](https://man7.org/linux/man-pages/man3/scandir.3.html)
+        *
+        * ```js
+        * const names = await tjs.readDir('.', { all: true });
+        * const entries = await tjs.readDir('.', { all: true, withFileTypes: true });
+        * ```
+        *
+        * @param path Path to the directory.
+        * @param options.all Must be `true` to read everything at once, otherwise a {@link DirHandle} is returned.
+        * @param options.withFileTypes Whether to return `DirEnt` objects rather than names. Defaults to `false`.
         */
-        function readDir(path: string): Promise<DirHandle>;
+        function readDir(path: string, options: { all: true, withFileTypes?: false }): Promise<string[]>;
+        function readDir(path: string, options: { all: true, withFileTypes: true }): Promise<DirEnt[]>;
         
+        interface WalkEntry {
+            /** Name of the entry. */
+            name: string;
+            /** Path of the entry, the walked path joined with the relative path to it. */
+            path: string;
+            /** Depth of the entry, 1 for direct children of the walked directory. */
+            depth: number;
+            isFile: boolean;
+            isDirectory: boolean;
+            isSymbolicLink: boolean;
+            /** Only present when the `stat` option is set. */
+            stat?: StatResult;
+        }
+
+        interface WalkOptions {
+            /** Descend into symbolic links to directories. Cycles are detected. Defaults to `false`. */
+            followSymlinks?: boolean;
+            /** Maximum depth to descend to. Defaults to `Infinity`. */
+            maxDepth?: number;
+            /** Include a `stat` result with each entry. Defaults to `false`. */
+            stat?: boolean;
+            /** Only entries for which this returns `true` are yielded. It doesn't prevent descending. */
+            filter?: (entry: WalkEntry) => boolean;
+            /** Approximate number of entries gathered per native call. Defaults to 1024. */
+            batchSize?: number;
+            /** Number of directories scanned in parallel. Defaults to 4. */
+            concurrency?: number;
+        }
+
+        /**
+        * Recursively walks the directory at the given path. Directories are scanned in parallel
+        * on the threadpool, so entries are not yielded in any particular order.
+        *
+        * ```js
+        * for await (const entry of tjs.walk('.', { maxDepth: 2 })) {
+        *     console.log(entry.path);
+        * }
+        * ```
+        *
+        * @param path Path to the directory.
+        * @param options Options for walking the directory.
+        */
+        function walk(path: string, options?: WalkOptions): AsyncGenerator<WalkEntry>;
+
+        interface GlobOptions {
+            /** Directory the patterns are relative to. Defaults to the current working directory. */
+            cwd?: string;
+            /** Patterns for paths to leave out. Matching directories are not descended into. */
+            ignore?: string | string[];
+            /** Let wildcards match names starting with a dot. Defaults to `false`. */
+            dot?: boolean;
+            /** Descend into symbolic links to directories. Defaults to `false`. */
+            followSymlinks?: boolean;
+        }
+
+        /**
+        * Finds the paths matching the given glob patterns. Supports `*`, `?`, `[...]`, `{a,b}`
+        * and `**`. Matching happens natively while walking, and directories which can't
+        * contain any match are never scanned. Paths are yielded relative to `cwd`, in no particular order.
+        *
+        * ```js
+        * for await (const path of tjs.glob('src/**\/*.{c,h}', { ignore: '**\/deps' })) {
+        *     console.log(path);
+        * }
+        * ```
+        *
+        * @param patterns Pattern or patterns to match.
+        * @param options Options for matching.
+        */
+        function glob(patterns: string | string[], options?: GlobOptions): AsyncGenerator<string>;
+
         /**
         * Reads the value of a symbolic link.
         * See [readlink(2)](https://man7.org/linux/man-pages/man2/readlink.2.html)
@@ -581,6 +865,77 @@ declare global {
         */
         function readFile(path: string): Promise<Uint8Array>;
 
+        /**
+        * Reads the entire contents of a file and decodes it as UTF-8.
+        * A leading byte order mark is skipped.
+        *
+        * @param path File path.
+        */
+        function readTextFile(path: string): Promise<string>;
+
+        interface WriteFileOptions {
+            /* Permissions used when the file is created. Defaults to 0o666. */
+            mode?: number;
+            /* Write to a temporary file and rename it over the target, so the file is never partially written. */
+            atomic?: boolean;
+        }
+
+        /**
+        * Writes data to a file, replacing its contents. The file is created if it doesn't exist.
+        * Strings are written as UTF-8.
+        *
+        * @param path File path.
+        * @param data Data to be written.
+        * @param options Write options.
+        */
+        function writeFile(path: string, data: string | ArrayBuffer | ArrayBufferView, options?: WriteFileOptions): Promise<void>;
+
+        /**
+        * Appends data to a file. The file is created if it doesn't exist.
+        * Strings are written as UTF-8.
+        *
+        * @param path File path.
+        * @param data Data to be written.
+        * @param options Write options.
+        */
+        function appendFile(path: string, data: string | ArrayBuffer | ArrayBufferView, options?: Omit<WriteFileOptions, 'atomic'>): Promise<void>;
+
+        interface MapFileOptions {
+            /* Position in the file where the mapping starts. Defaults to 0. */
+            offset?: number;
+            /* Amount of bytes to map. Defaults to the rest of the file. */
+            length?: number;
+            /* 'r' gives a private copy-on-write view, 'rw' writes through to the file. Defaults to 'r'. */
+            mode?: 'r' | 'rw';
+            /* Return a SharedArrayBuffer which can be posted to workers. The offset must be page aligned. */
+            shared?: boolean;
+            /* Access pattern hint passed to the kernel. */
+            advice?: 'normal' | 'sequential' | 'random' | 'willneed' | 'dontneed';
+        }
+
+        /**
+        * Maps (a region of) a file into memory without copying it.
+        * The mapping is released when the buffer is garbage collected or passed to {@link unmapFile}.
+        * Mapping is not supported on every filesystem, fall back to {@link readFile} on error.
+        *
+        * @param path File path.
+        * @param options Mapping options.
+        */
+        function mapFile(path: string, options?: MapFileOptions & { shared: true }): Promise<SharedArrayBuffer>;
+        function mapFile(path: string, options?: MapFileOptions): Promise<ArrayBuffer>;
+
+        /**
+        * Eagerly releases a mapping created with {@link mapFile}. The buffer is detached.
+        * Throws a `TypeError` for any other buffer.
+        *
+        * Shared mappings can't be released this way: a `SharedArrayBuffer` can't be detached
+        * and other workers may still be using it, so it's unmapped once the last reference to
+        * it is garbage collected.
+        *
+        * @param buffer Buffer returned by {@link mapFile}, without the `shared` option.
+        */
+        function unmapFile(buffer: ArrayBuffer): void;
+
         interface RemoveOptions {
             /* Amount of times to retry the operation in case it fails. Defaults to 0. */
             maxRetries?: number;
@@ -590,7 +945,8 @@ declare global {
 
         /**
          * Recursively delete files and directories at the given path.
-         * Equivalent to POSIX "rm -rf".
+         * Equivalent to POSIX "rm -rf". Symbolic links are removed, not followed.
+         * Except on Windows, the tree is deleted in parallel on the threadpool.
          *
          * @param path Path to be removed.
          */
@@ -624,6 +980,40 @@ declare global {
         * File watch event handler function.
         */
         type WatchEventHandler = (filename: string, event: 'change' | 'rename') => void;
+
+        interface WatchEvent {
+            /**
+            * Path of the affected file, relative to the watched path. An empty name refers to
+            * the watched path itself, or signals that events were dropped and the tree should
+            * be rescanned.
+            */
+            filename: string;
+            event: 'change' | 'rename';
+        }
+
+        /**
+        * Batched file watch event handler function. Each file appears at most once per batch,
+        * `rename` taking precedence over `change`.
+        */
+        type WatchBatchHandler = (events: WatchEvent[]) => void;
+
+        interface WatchOptions {
+            /**
+            * Watch all subdirectories too. On Linux the tree is kept in sync as directories are
+            * created, moved and removed.
+            *
+            * Defaults to `false` on Linux and to `true` elsewhere, where watchers have always been
+            * recursive (when the platform supports it). Pass `false` to only watch the directory itself.
+            */
+            recursive?: boolean;
+
+            /**
+            * Coalesce events and deliver them in batches once no new events have arrived for
+            * this many milliseconds (a steady stream is flushed every 4 windows). When set,
+            * the handler receives an array of events.
+            */
+            debounce?: number;
+        }
         
         interface FileWatcher {
             /**
@@ -642,8 +1032,10 @@ declare global {
         *
         * @param path The path to watch.
         * @param handler Function to be called when an event occurs.
+        * @param options Watch options.
         */
-        function watch(path: string, handler: WatchEventHandler): FileWatcher;
+        function watch(path: string, handler: WatchEventHandler, options?: WatchOptions & { debounce?: undefined }): FileWatcher;
+        function watch(path: string, handler: WatchBatchHandler, options: WatchOptions & { debounce: number }): FileWatcher;
         
         /**
         * The current user's home directory.
@@ -737,11 +1129,85 @@ declare global {
             flowInfo?: number;
         }
         
+        interface CorkOptions {
+            /**
+            * Also set `TCP_CORK` (`TCP_NOPUSH` on BSDs) on the socket while corked, so the kernel
+            * holds back partial frames too. TCP only, ignored elsewhere.
+            */
+            tcpCork?: boolean;
+        }
+
         interface Connection {
             read(buf: Uint8Array): Promise<number|null>;
             write(buf: Uint8Array): Promise<number>;
+
+            /**
+            * Writes the given buffers, in order, with a single request.
+            * Returns the total amount of data written.
+            */
+            writev(bufs: Uint8Array[]): Promise<number>;
+
+            /**
+            * Holds back writes until {@link uncork} is called or the current tick ends, then
+            * sends them with a single vectored write. Writes made while corked share one
+            * promise, which settles when the whole batch is written. Calls can be nested, the
+            * end of the tick undoes any that are left.
+            */
+            cork(options?: CorkOptions): void;
+
+            /**
+            * Undoes one {@link cork} call, sending the held back writes once none are left.
+            */
+            uncork(): void;
+
+            /**
+            * Amount of data queued for writing that hasn't been handed to the kernel yet.
+            */
+            readonly bufferedAmount: number;
+
+            /**
+            * Resolves once at most `threshold` bytes (0 by default) are waiting to be written,
+            * or the connection is closed.
+            */
+            drain(threshold?: number): Promise<void>;
             setKeepAlive(enable: boolean, delay: number): void;
             setNoDelay(enable?: boolean): void;
+
+            /**
+            * Sets the socket's send buffer size (SO_SNDBUF) and returns the size the
+            * kernel settled on, which Linux doubles to account for bookkeeping.
+            */
+            setSendBufferSize(size: number): number;
+
+            /**
+            * Sets the socket's receive buffer size (SO_RCVBUF) and returns the size the
+            * kernel settled on.
+            */
+            setRecvBufferSize(size: number): number;
+
+            /**
+            * Limits how much unsent data the kernel keeps queued (TCP_NOTSENT_LOWAT), so
+            * writes wait in userland where they can still be coalesced or prioritized.
+            */
+            setNotSentLowat(bytes: number): void;
+
+            /**
+            * Sends ACKs right away instead of delaying them (TCP_QUICKACK, Linux only).
+            * The kernel may go back to delayed ACKs on its own, so this is usually
+            * called after each read.
+            */
+            setQuickAck(enable?: boolean): void;
+
+            /**
+            * Busy polls the device queue for the given amount of microseconds on
+            * blocking receives (SO_BUSY_POLL, Linux only).
+            */
+            setBusyPoll(usecs: number): void;
+
+            /**
+            * Returns the kernel's view of the connection (TCP_INFO, Linux only).
+            */
+            getInfo(): TcpInfo;
             shutdown(): void;
             close(): void;
             localAddress: Address;
@@ -750,15 +1216,77 @@ declare global {
             writable: WritableStream<Uint8Array>;
         }
         
+        interface TcpInfo {
+            /* Connection state, as in the kernel's TCP_* states. */
+            state: number;
+            /* Smoothed round trip time, in microseconds. */
+            rtt: number;
+            /* Round trip time variance, in microseconds. */
+            rttVar: number;
+            /* Congestion window, in segments. */
+            cwnd: number;
+            /* Slow start threshold, in segments. */
+            ssthresh: number;
+            /* Maximum segment size used for sending. */
+            mss: number;
+            /* Retransmissions of the current unacknowledged segment. */
+            retransmits: number;
+            /* Retransmissions during the connection's lifetime. */
+            totalRetransmits: number;
+            /* Segments sent but not acknowledged yet. */
+            unacked: number;
+            /* Segments the kernel considers lost. */
+            lost: number;
+        }
+
         interface DatagramData {
             nread: number;
             partial: boolean;
             addr: Address;
         }
         
+        interface DatagramMessage {
+            data: Uint8Array;
+            /* Destination, can be omitted on connected endpoints. */
+            addr?: Address;
+        }
+
         interface DatagramEndpoint {
             recv(buf: Uint8Array): Promise<number>;
             send(buf: Uint8Array, addr?: Address): Promise<DatagramData>;
+
+            /**
+            * Receives as many datagrams as are ready, up to one per buffer, resolving with
+            * an entry for each filled buffer (in order). Uses recvmmsg where available.
+            * Resolves with `null` if the endpoint is closed while waiting.
+            */
+            recvBatch(bufs: Uint8Array[]): Promise<DatagramData[] | null>;
+
+            /**
+            * Sends all the given datagrams with as few syscalls as possible (sendmmsg where
+            * available). Resolves with the size of each message.
+            *
+            * Every message needs an `addr` unless the endpoint is connected, in which case none
+            * may have one; this is checked before anything is sent. If sending fails partway,
+            * the promise rejects with an error whose `sent` property holds the number of
+            * messages that did get sent.
+            */
+            sendBatch(messages: DatagramMessage[]): Promise<number[]>;
+
+            /**
+            * Sets the UDP GSO segment size (UDP_SEGMENT, Linux only), 0 disables it. Larger
+            * sends are split into datagrams of this size by the kernel, and `sendBatch`
+            * sends consecutive messages of exactly this size to the same address as one.
+            */
+            setSegmentSize(size: number): void;
+
+            /**
+            * Enables receiving coalesced datagrams (UDP_GRO, Linux only). They are split
+            * into their segments again, which are handed out one per buffer, so a single
+            * read can fill a whole `recvBatch`. Segments that don't fit are kept for the
+            * next read.
+            */
+            setGro(enable?: boolean): void;
             close(): void;
             localAddress: Address;
             remoteAddress: Address;
@@ -776,6 +1304,25 @@ declare global {
             * Disables dual stack mode.
             */
             ipv6Only?: boolean;
+
+            /**
+            * Used on TCP only.
+            * Send the data of the first write along with the SYN (TCP_FASTOPEN_CONNECT,
+            * Linux only). The server must have fast open enabled too.
+            */
+            fastOpen?: boolean;
+
+            /**
+            * Used on UDP only.
+            * See {@link DatagramEndpoint.setSegmentSize}.
+            */
+            segmentSize?: number;
+
+            /**
+            * Used on UDP only.
+            * See {@link DatagramEndpoint.setGro}.
+            */
+            gro?: boolean;
         }
         
         /**
@@ -791,11 +1338,23 @@ declare global {
         interface Listener extends AsyncIterable<Connection> {
             accept(): Promise<Connection>;
             close(): void;
+            /**
+            * Returns the listening socket's file descriptor, which can be posted to a
+            * worker and used as the `fd` listen option there.
+            */
+            fileno(): number;
             localAddress: Address;
         }
         
         interface ListenOptions {
             backlog?: number;
+
+            /**
+            * Used on TCP and pipes only.
+            * Maximum amount of connections accepted ahead of `accept()` calls. Once full,
+            * further connections wait in the kernel backlog. Defaults to 128.
+            */
+            acceptQueueSize?: number;
             
             /**
             * Disables dual stack mode.
@@ -810,6 +1369,49 @@ declare global {
             * any traffic, in effect "stealing" the port from the previous listener.
             */
             reuseAddr?: boolean;
+
+            /**
+            * Enable SO_REUSEPORT when binding. Every thread or process that binds the same
+            * address with this flag gets its own listener, and the kernel load balances
+            * incoming connections (or datagrams) between them. Not available on every
+            * platform (e.g. macOS), binding fails with `ENOTSUP` there.
+            */
+            reusePort?: boolean;
+
+            /**
+            * Used on TCP only.
+            * Enable TCP fast open, accepting data carried in the SYN. A number sets the
+            * maximum amount of pending fast open requests, `true` uses 256.
+            */
+            fastOpen?: boolean | number;
+
+            /**
+            * Used on TCP only.
+            * Wake up the listener only once data arrives on a new connection, waiting up to
+            * the given amount of seconds (TCP_DEFER_ACCEPT, Linux only).
+            */
+            deferAccept?: number;
+
+            /**
+            * Used on TCP only.
+            * Listen on an existing listening socket, e.g. one handed over from another
+            * thread with `Listener.fileno()`, instead of binding a new one. The descriptor
+            * is duplicated, so each listener can be closed independently. Not supported
+            * on Windows.
+            */
+            fd?: number;
+
+            /**
+            * Used on UDP only.
+            * See {@link DatagramEndpoint.setSegmentSize}.
+            */
+            segmentSize?: number;
+
+            /**
+            * Used on UDP only.
+            * See {@link DatagramEndpoint.setGro}.
+            */
+            gro?: boolean;
         }
         
         /**
@@ -821,6 +1423,49 @@ declare global {
         * @param options Extra listen options.
         */
         function listen(transport: Transport, host: string, port?: string | number, options?: ListenOptions): Promise<Listener | DatagramEndpoint>;
+
+        interface SendFileOptions {
+            /* Position in the file to start sending from. Defaults to 0. */
+            offset?: number;
+            /* Amount of bytes to send. Defaults to the rest of the file. */
+            length?: number;
+        }
+
+        /**
+        * Sends (a region of) a file over a connection without copying it through JS memory,
+        * using sendfile(2) where available. Returns the amount of bytes sent.
+        *
+        * Previous writes must have completed, and no other writes may be issued until
+        * the returned promise settles.
+        *
+        * @param connection Connection to send the file on.
+        * @param file File to send.
+        * @param options Range to send.
+        */
+        function sendFile(connection: Connection, file: FileHandle, options?: SendFileOptions): Promise<number>;
+
+        type PipeEndpoint = Connection | FileHandle | StdioInputStream | StdioOutputStream;
+
+        interface PipeOptions {
+            /* Amount of bytes that can be waiting to be written before reading pauses. Defaults to 256 KiB. */
+            highWaterMark?: number;
+        }
+
+        /**
+        * Moves data from one handle to another without going through JS, until the source
+        * reaches EOF. Returns the amount of bytes moved. The destination is not closed or
+        * shut down when done.
+        *
+        * Stream sources are read in the event loop and stop reading while the destination
+        * can't keep up. File sources are read from their current position and sent from the
+        * threadpool with sendfile(2). The source can't be read from while piping. Closing a
+        * file destination while piping rejects with `EBADF`.
+        *
+        * @param src Handle to read from.
+        * @param dst Handle to write to.
+        * @param options Pipe options.
+        */
+        function pipe(src: PipeEndpoint, dst: PipeEndpoint, options?: PipeOptions): Promise<number>;
         
         /**
         * Current process ID.
@@ -953,6 +1598,67 @@ declare global {
          * @returns resulting string
          */
         function format(...values: unknown[]): string;
+
+        /**
+        * Synchronously dequeues a message sent to the given port, without yielding to the event loop.
+        * Returns `undefined` if no message is pending.
+        *
+        * ```js
+        * // Inside a worker.
+        * const msg = tjs.receiveMessageOnPort(self);
+        * ```
+        *
+        * @param port A `Worker` (from the parent) or `self` (from inside a worker).
+        * @param options.timeout Time to wait for a message, in milliseconds. Defaults to 0. Only
+        * allowed inside workers, use `Infinity` to wait forever.
+        */
+        function receiveMessageOnPort(port: Worker | typeof globalThis, options?: { timeout?: number }): { message: any } | undefined;
+
+        /**
+        * Resource usage of a worker, as returned by `Worker.prototype.stats()`.
+        * Heap figures are sampled by the worker roughly once per second, starting with the
+        * first call; until the first sample lands they read 0. They are always up to date
+        * once the worker has exited.
+        */
+        interface WorkerStats {
+            /** CPU time consumed by the worker thread, in microseconds. */
+            readonly cpuTime: number;
+            /** Bytes allocated by the worker's JS heap. */
+            readonly heapSize: number;
+            /** Bytes in use by JS objects in the worker's heap. */
+            readonly heapUsed: number;
+            /** Memory limit of the worker's heap, -1 if unlimited. */
+            readonly heapLimit: number;
+            /** Messages received by the worker. */
+            readonly messagesIn: number;
+            /** Messages sent by the worker. */
+            readonly messagesOut: number;
+            /** Serialized bytes received by the worker. */
+            readonly bytesIn: number;
+            /** Serialized bytes sent by the worker. */
+            readonly bytesOut: number;
+            /** Whether the worker thread is still running. */
+            readonly running: boolean;
+        }
+    }
+
+    interface WorkerOptions {
+        /** Name of the worker, exposed as `self.name` inside it. */
+        name?: string;
+        /** Memory limit for the worker's JS heap, in bytes. */
+        memoryLimit?: number;
+        /**
+         * Maximum stack size for the worker's JS engine, in bytes. The worker thread is created with a native
+         * stack slightly larger than this, so deep recursion throws a `RangeError` instead of crashing.
+         */
+        stackSize?: number;
+    }
+
+    interface Worker {
+        /**
+        * Returns resource usage information about the worker.
+        */
+        stats(): tjs.WorkerStats;
     }
 }
 